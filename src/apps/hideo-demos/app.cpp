@@ -13,6 +13,7 @@
 #include "demo-gradient.h"
 #include "demo-hello.h"
 #include "demo-mixbox.h"
+#include "demo-stress.h"
 #include "demo-stroke.h"
 #include "demo-svg.h"
 #include "demo-text.h"
@@ -26,6 +27,7 @@ static Array DEMOS = {
     &GRADIENT_DEMO,
     &HELLO_DEMO,
     &MIXBOX_DEMO,
+    &STRESS_DEMO,
     &STROKE_DEMO,
     &SVG_DEMO,
     &TEXT_DEMO,
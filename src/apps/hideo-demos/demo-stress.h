@@ -0,0 +1,146 @@
+#pragma once
+
+#include <karm-logger/logger.h>
+#include <karm-math/rand.h>
+#include <karm-sys/time.h>
+#include <karm-ui/funcs.h>
+#include <karm-ui/view.h>
+#include <mdi/speedometer.h>
+
+#include "base.h"
+
+namespace Hideo::Demos {
+
+// Bounces a lot of small shapes around, every frame damages the old and
+// new place of each of them. The frame time percentiles are logged.
+struct Stress : public Ui::View<Stress> {
+    static constexpr usize SHAPES = 1000;
+
+    // Frames measured between each report.
+    static constexpr usize WINDOW = 300;
+
+    struct Shape {
+        Math::Vec2f pos;
+        Math::Vec2f vel;
+        f64 radius;
+        Gfx::Color color;
+
+        Math::Recti bound() const {
+            return Math::Rectf::fromCenter(pos, Math::Vec2f{radius * 2})
+                .grow(1)
+                .ceil()
+                .cast<isize>();
+        }
+    };
+
+    Vec<Shape> _shapes;
+    Vec<Duration> _frames;
+    Opt<Instant> _lastFrame;
+    bool _started = false;
+
+    void _spawn() {
+        Math::Rand rand{0x5eed};
+        for (usize i = 0; i < SHAPES; i++) {
+            _shapes.pushBack({
+                .pos = {
+                    bound().start() + rand.nextDouble(bound().width),
+                    bound().top() + rand.nextDouble(bound().height),
+                },
+                .vel = {
+                    rand.nextDouble(-200, 200),
+                    rand.nextDouble(-200, 200),
+                },
+                .radius = rand.nextDouble(2, 12),
+                .color = Gfx::randomColor(rand),
+            });
+        }
+    }
+
+    void _report() {
+        sort(_frames, [](Duration a, Duration b) {
+            return a <=> b;
+        });
+
+        auto percentile = [&](usize p) {
+            return _frames[min(_frames.len() * p / 100, _frames.len() - 1)].toUSecs() / 1000.0;
+        };
+
+        logInfo(
+            "stress: {} shapes, frame time p50: {.2}ms p95: {.2}ms p99: {.2}ms",
+            _shapes.len(), percentile(50), percentile(95), percentile(99)
+        );
+
+        _frames.clear();
+    }
+
+    void _step(f64 dt) {
+        auto area = bound().cast<f64>();
+        for (auto& s : _shapes) {
+            auto before = s.bound();
+
+            s.pos = s.pos + s.vel * dt;
+            if (s.pos.x < area.start() or s.pos.x > area.end())
+                s.vel.x = -s.vel.x;
+            if (s.pos.y < area.top() or s.pos.y > area.bottom())
+                s.vel.y = -s.vel.y;
+            s.pos = {
+                clamp(s.pos.x, area.start(), area.end()),
+                clamp(s.pos.y, area.top(), area.bottom()),
+            };
+
+            Ui::shouldRepaint(*this, before);
+            Ui::shouldRepaint(*this, s.bound());
+        }
+    }
+
+    void paint(Gfx::Canvas& g, Math::Recti r) override {
+        for (auto& s : _shapes) {
+            if (not s.bound().colide(r))
+                continue;
+            g.fillStyle(s.color);
+            g.fill(Math::Ellipsef{s.pos, s.radius});
+        }
+    }
+
+    void event(App::Event& e) override {
+        auto ae = e.is<Node::AnimateEvent>();
+        if (not ae)
+            return;
+
+        auto now = Sys::instant();
+        if (_lastFrame) {
+            _frames.pushBack(now - *_lastFrame);
+            if (_frames.len() >= WINDOW)
+                _report();
+        }
+        _lastFrame = now;
+
+        _step(ae->dt);
+        Ui::shouldAnimate(*this);
+    }
+
+    void layout(Math::Recti r) override {
+        Ui::View<Stress>::layout(r);
+
+        if (not _started) {
+            _started = true;
+            _spawn();
+            Ui::shouldAnimate(*this);
+        }
+    }
+
+    Math::Vec2i size(Math::Vec2i s, Ui::Hint) override {
+        return s;
+    }
+};
+
+static inline Demo STRESS_DEMO{
+    Mdi::SPEEDOMETER,
+    "Stress",
+    "Frame time under many small damages",
+    [] {
+        return makeRc<Stress>();
+    },
+};
+
+} // namespace Hideo::Demos
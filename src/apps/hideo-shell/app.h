@@ -1,6 +1,7 @@
 #pragma once
 
 #include <karm-ui/box.h>
+#include <karm-ui/layer.h>
 #include <karm-ui/layout.h>
 #include <karm-ui/node.h>
 
@@ -16,7 +17,8 @@ inline auto panel(Math::Vec2i size = {500, 400}) {
                .borderWidth = 1,
                .borderFill = Ui::GRAY800,
                .backgroundFill = Ui::GRAY950,
-           });
+           }) |
+           Ui::layer();
 }
 
 Ui::Child background(State const& state);
@@ -147,6 +147,7 @@ Ui::Child appsFlyout(State const& state) {
                 .backgroundFill = Ui::GRAY950,
             }) |
             Ui::bound() |
+            Ui::layer() |
             Ui::dismisable(
                 Model::bind<Activate>(Panel::NIL),
                 Ui::DismisDir::DOWN,
@@ -354,6 +354,7 @@ Ui::Child sysFlyout(State const& state) {
     return Ui::vflow(8, body) |
            box |
            Ui::bound() |
+           Ui::layer() |
            Ui::dismisable(
                Model::bind<Activate>(Panel::NIL),
                Ui::DismisDir::TOP,
@@ -328,6 +328,10 @@ Res<Vec<DirEntry>> readDir(Mime::Url const&) {
     return Error::notImplemented();
 }
 
+Res<> createDir(Mime::Url const&) {
+    return Error::notImplemented();
+}
+
 Res<Rc<Fd>> createFile(Mime::Url const&) {
     return Error::notImplemented();
 }
@@ -372,6 +376,26 @@ Res<Stat> stat(Mime::Url const&) {
     notImplemented();
 }
 
+Res<> removeFile(Mime::Url const&) {
+    return Error::notImplemented();
+}
+
+Res<> renameFile(Mime::Url const&, Mime::Url const&) {
+    return Error::notImplemented();
+}
+
+Res<> syncFile(Rc<Fd>) {
+    return Error::notImplemented();
+}
+
+Res<> truncateFile(Rc<Fd>, usize) {
+    return Error::notImplemented();
+}
+
+Res<> syncDir(Mime::Url const&) {
+    return Error::notImplemented();
+}
+
 // MARK: Time ------------------------------------------------------------------
 
 SystemTime now() {
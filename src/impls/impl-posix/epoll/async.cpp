@@ -2,7 +2,7 @@
 #include <impl-posix/utils.h>
 #include <karm-async/one.h>
 #include <karm-async/promise.h>
-#include <karm-base/map.h>
+#include <karm-base/hashmap.h>
 #include <karm-sys/_embed.h>
 #include <karm-sys/async.h>
 #include <karm-sys/time.h>
@@ -17,7 +17,7 @@ namespace Karm::Sys::_Embed {
 struct EpollSched : public Sys::Sched {
     int _epollFd;
     usize _id = 0;
-    Map<usize, Async::Promise<>> _promises;
+    HashMap<usize, Async::Promise<>> _promises;
 
     EpollSched(int epollFd)
         : _epollFd(epollFd) {}
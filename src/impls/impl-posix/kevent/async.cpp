@@ -7,7 +7,7 @@
 #include <impl-posix/fd.h>
 #include <impl-posix/utils.h>
 #include <karm-async/promise.h>
-#include <karm-base/map.h>
+#include <karm-base/hashmap.h>
 #include <karm-sys/_embed.h>
 #include <karm-sys/async.h>
 #include <karm-sys/time.h>
@@ -19,7 +19,7 @@ struct DarwinSched :
 
     int _kqueue;
     usize _id = 0;
-    Map<usize, Async::Promise<>> _promises;
+    HashMap<usize, Async::Promise<>> _promises;
 
     DarwinSched(int kqueue)
         : _kqueue(kqueue) {
@@ -82,6 +82,10 @@ Res<Mime::Path> resolve(Mime::Url const& url) {
 
         if (url.host == "home")
             resolved = Mime::Path::parse(maybeHome).join(path);
+        else if (url.host == "cache" and getenv("XDG_CACHE_HOME"))
+            resolved = Mime::Path::parse(getenv("XDG_CACHE_HOME")).join(path);
+        else if (url.host == "cache")
+            resolved = Mime::Path::parse(maybeHome).join(".cache").join(path);
         else
             resolved = Mime::Path::parse(maybeHome).join(Io::toPascalCase(url.host).unwrap()).join(path);
     } else {
@@ -195,6 +199,13 @@ Res<Vec<DirEntry>> readDir(Mime::Url const& url) {
     return Ok(entries);
 }
 
+Res<> createDir(Mime::Url const& url) {
+    String str = try$(resolve(url)).str();
+    if (::mkdir(str.buf(), 0755) < 0)
+        return Posix::fromLastErrno();
+    return Ok();
+}
+
 Res<Stat> stat(Mime::Url const& url) {
     String str = try$(resolve(url)).str();
     struct stat buf;
@@ -203,6 +214,52 @@ Res<Stat> stat(Mime::Url const& url) {
     return Ok(Posix::fromStat(buf));
 }
 
+Res<> removeFile(Mime::Url const& url) {
+    String str = try$(resolve(url)).str();
+    if (::unlink(str.buf()) < 0)
+        return Posix::fromLastErrno();
+    return Ok();
+}
+
+Res<> renameFile(Mime::Url const& from, Mime::Url const& to) {
+    String fromStr = try$(resolve(from)).str();
+    String toStr = try$(resolve(to)).str();
+    if (::rename(fromStr.buf(), toStr.buf()) < 0)
+        return Posix::fromLastErrno();
+    return Ok();
+}
+
+Res<> syncFile(Rc<Fd> maybeFd) {
+    Rc<Posix::Fd> fd = try$(maybeFd.cast<Posix::Fd>());
+#ifdef __ck_sys_darwin__
+    if (::fsync(fd->_raw) < 0)
+#else
+    if (::fdatasync(fd->_raw) < 0)
+#endif
+        return Posix::fromLastErrno();
+    return Ok();
+}
+
+Res<> truncateFile(Rc<Fd> maybeFd, usize len) {
+    Rc<Posix::Fd> fd = try$(maybeFd.cast<Posix::Fd>());
+    if (::ftruncate(fd->_raw, len) < 0)
+        return Posix::fromLastErrno();
+    return Ok();
+}
+
+Res<> syncDir(Mime::Url const& url) {
+    String str = try$(resolve(url)).str();
+
+    isize raw = ::open(str.buf(), O_RDONLY | O_DIRECTORY);
+    if (raw < 0)
+        return Posix::fromLastErrno();
+    Posix::Fd fd{raw};
+
+    if (::fsync(fd._raw) < 0)
+        return Posix::fromLastErrno();
+    return Ok();
+}
+
 // MARK: User interactions -----------------------------------------------------
 
 Res<> launch(Intent intent) {
@@ -4,7 +4,7 @@
 #include <impl-posix/fd.h>
 #include <impl-posix/utils.h>
 #include <karm-async/promise.h>
-#include <karm-base/map.h>
+#include <karm-base/hashmap.h>
 #include <karm-logger/logger.h>
 #include <karm-sys/_embed.h>
 #include <karm-sys/async.h>
@@ -49,7 +49,7 @@ struct UringSched : public Sys::Sched {
 
     io_uring _ring;
     usize _id = 1;
-    Map<usize, Rc<_Job>> _jobs;
+    HashMap<usize, Rc<_Job>> _jobs;
 
     UringSched(io_uring ring)
         : _ring(ring) {}
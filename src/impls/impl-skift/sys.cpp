@@ -53,10 +53,34 @@ Res<Vec<Sys::DirEntry>> readDir(Mime::Url const&) {
     notImplemented();
 }
 
+Res<> createDir(Mime::Url const&) {
+    notImplemented();
+}
+
 Res<Stat> stat(Mime::Url const&) {
     notImplemented();
 }
 
+Res<> removeFile(Mime::Url const&) {
+    notImplemented();
+}
+
+Res<> renameFile(Mime::Url const&, Mime::Url const&) {
+    notImplemented();
+}
+
+Res<> syncFile(Rc<Sys::Fd>) {
+    notImplemented();
+}
+
+Res<> truncateFile(Rc<Sys::Fd>, usize) {
+    notImplemented();
+}
+
+Res<> syncDir(Mime::Url const&) {
+    notImplemented();
+}
+
 // MARK: User interactions -----------------------------------------------------
 
 Res<> launch(Intent) {
@@ -97,6 +97,30 @@ Res<Vec<DirEntry>> readDir(Mime::Url const&) {
     return Error::notImplemented("directory listing not supported");
 }
 
+Res<> createDir(Mime::Url const&) {
+    return Error::notImplemented();
+}
+
+Res<> removeFile(Mime::Url const&) {
+    return Error::notImplemented();
+}
+
+Res<> renameFile(Mime::Url const&, Mime::Url const&) {
+    return Error::notImplemented();
+}
+
+Res<> syncFile(Rc<Fd>) {
+    return Error::notImplemented();
+}
+
+Res<> truncateFile(Rc<Fd>, usize) {
+    return Error::notImplemented();
+}
+
+Res<> syncDir(Mime::Url const&) {
+    return Error::notImplemented();
+}
+
 Res<Stat> stat(Mime::Url const&) {
     return Error::notImplemented("directory listing not supported");
 }
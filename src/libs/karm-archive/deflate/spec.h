@@ -0,0 +1,181 @@
+#pragma once
+
+// https://www.rfc-editor.org/rfc/rfc1951
+
+#include "../inflate/spec.h"
+
+namespace Deflate {
+
+static constexpr usize MIN_MATCH = 3;
+static constexpr usize HASH_BITS = 15;
+static constexpr usize HASH_SIZE = 1 << HASH_BITS;
+
+// How many previous occurrences of a prefix are tried before settling
+// for the best match so far, trades compression ratio for speed.
+static constexpr usize MAX_CHAIN = 32;
+
+// MARK: Bit Writer ------------------------------------------------------------
+
+// LSB-first bit writer appending to a vector.
+struct BitWriter {
+    Vec<u8>& _out;
+    u64 _bits = 0;
+    usize _count = 0;
+
+    BitWriter(Vec<u8>& out)
+        : _out(out) {}
+
+    always_inline void put(u32 bits, usize n) {
+        _bits |= (u64)bits << _count;
+        _count += n;
+        while (_count >= 8) {
+            _out.pushBack(_bits & 0xff);
+            _bits >>= 8;
+            _count -= 8;
+        }
+    }
+
+    // Huffman codes are packed starting with their most significant bit.
+    always_inline void putCode(u32 code, usize n) {
+        u32 rev = 0;
+        for (usize i = 0; i < n; i++)
+            rev |= ((code >> i) & 1) << (n - 1 - i);
+        put(rev, n);
+    }
+
+    void flush() {
+        if (_count)
+            _out.pushBack(_bits & 0xff);
+        _bits = 0;
+        _count = 0;
+    }
+};
+
+// MARK: Fixed Huffman Codes ---------------------------------------------------
+
+// 3.2.6. Compression with fixed Huffman codes (BTYPE=01)
+always_inline static void _literal(BitWriter& out, u32 sym) {
+    if (sym < 144)
+        out.putCode(0x30 + sym, 8);
+    else if (sym < 256)
+        out.putCode(0x190 + (sym - 144), 9);
+    else if (sym < 280)
+        out.putCode(sym - 256, 7);
+    else
+        out.putCode(0xc0 + (sym - 280), 8);
+}
+
+always_inline static void _match(BitWriter& out, usize len, usize dist) {
+    usize l = Inflate::LENGTH_BASE.len() - 1;
+    while (Inflate::LENGTH_BASE[l] > len)
+        l--;
+    _literal(out, 257 + l);
+    out.put(len - Inflate::LENGTH_BASE[l], Inflate::LENGTH_EXTRA[l]);
+
+    usize d = Inflate::DIST_BASE.len() - 1;
+    while (Inflate::DIST_BASE[d] > dist)
+        d--;
+    out.putCode(d, 5);
+    out.put(dist - Inflate::DIST_BASE[d], Inflate::DIST_EXTRA[d]);
+}
+
+// MARK: Deflater --------------------------------------------------------------
+
+// Greedy LZ77 over hash chains, the output is a single block
+// using the fixed Huffman codes.
+struct Deflater {
+    Vec<i32> _head;
+    Vec<i32> _prev;
+
+    Deflater() {
+        _head.resize(HASH_SIZE);
+        _prev.resize(Inflate::WINDOW);
+        fill(mutSub(_head), -1);
+    }
+
+    always_inline static u32 _hash(u8 const* p) {
+        u32 v = p[0] | (p[1] << 8) | (p[2] << 16);
+        return (v * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    always_inline void _insert(Bytes bytes, usize pos) {
+        if (pos + MIN_MATCH > bytes.len())
+            return;
+        auto h = _hash(bytes.buf() + pos);
+        _prev[pos % Inflate::WINDOW] = _head[h];
+        _head[h] = pos;
+    }
+
+    always_inline Tuple<usize, usize> _longestMatch(Bytes bytes, usize pos) {
+        usize bestLen = 0;
+        usize bestDist = 0;
+
+        if (pos + MIN_MATCH > bytes.len())
+            return {0, 0};
+
+        usize maxLen = min(Inflate::MAX_MATCH, bytes.len() - pos);
+        i32 candidate = _head[_hash(bytes.buf() + pos)];
+
+        for (usize chain = 0; chain < MAX_CHAIN and candidate >= 0; chain++) {
+            usize dist = pos - candidate;
+            if (dist == 0 or dist > Inflate::WINDOW)
+                break;
+
+            u8 const* a = bytes.buf() + candidate;
+            u8 const* b = bytes.buf() + pos;
+            usize len = 0;
+            while (len < maxLen and a[len] == b[len])
+                len++;
+
+            if (len > bestLen) {
+                bestLen = len;
+                bestDist = dist;
+                if (len == maxLen)
+                    break;
+            }
+
+            i32 next = _prev[candidate % Inflate::WINDOW];
+            // NOTE: The chain is stale once it points forward or out of the window.
+            if (next >= candidate)
+                break;
+            candidate = next;
+        }
+
+        if (bestLen < MIN_MATCH)
+            return {0, 0};
+        return {bestLen, bestDist};
+    }
+
+    void run(Bytes bytes, BitWriter& out) {
+        out.put(1, 1); // BFINAL
+        out.put(1, 2); // BTYPE=01
+
+        usize pos = 0;
+        while (pos < bytes.len()) {
+            auto [len, dist] = _longestMatch(bytes, pos);
+
+            if (len) {
+                _match(out, len, dist);
+                for (usize i = 0; i < len; i++)
+                    _insert(bytes, pos + i);
+                pos += len;
+            } else {
+                _literal(out, bytes[pos]);
+                _insert(bytes, pos);
+                pos++;
+            }
+        }
+
+        _literal(out, 256); // End of block
+        out.flush();
+    }
+};
+
+static inline Vec<u8> deflate(Bytes bytes) {
+    Vec<u8> out;
+    BitWriter bits{out};
+    Deflater{}.run(bytes, bits);
+    return out;
+}
+
+} // namespace Deflate
@@ -1,5 +1,88 @@
 #pragma once
 
+// https://www.rfc-editor.org/rfc/rfc1952
+
+#include <karm-crypto/crc32.h>
+
+#include "../inflate/spec.h"
+
 namespace Gzip {
 
+static constexpr u8 FTEXT = 1 << 0;
+static constexpr u8 FHCRC = 1 << 1;
+static constexpr u8 FEXTRA = 1 << 2;
+static constexpr u8 FNAME = 1 << 3;
+static constexpr u8 FCOMMENT = 1 << 4;
+
+static inline Res<u32> _nextU32le(auto& in) {
+    u32 v = 0;
+    for (usize i = 0; i < 4; i++)
+        v |= (u32)try$(in.nextByte()) << (i * 8);
+    return Ok(v);
+}
+
+static inline Res<> _skipStr(auto& in) {
+    while (try$(in.nextByte()) != 0)
+        ;
+    return Ok();
+}
+
+// Decompress the first member of a gzip file, chunks of input are pulled
+// from `source` and the output is pushed to `sink` as it gets decoded.
+static inline Res<> decompress(auto source, auto&& sink) {
+    Inflate::BitReader in{std::move(source)};
+
+    if (try$(in.nextByte()) != 0x1F or try$(in.nextByte()) != 0x8B)
+        return Error::invalidData("invalid signature");
+
+    if (try$(in.nextByte()) != 8)
+        return Error::invalidData("unsupported compression method");
+
+    u8 flags = try$(in.nextByte());
+
+    // Modification time, extra flags and operating system
+    for (usize i = 0; i < 6; i++)
+        try$(in.nextByte());
+
+    if (flags & FEXTRA) {
+        usize len = try$(in.nextByte());
+        len |= try$(in.nextByte()) << 8;
+        for (usize i = 0; i < len; i++)
+            try$(in.nextByte());
+    }
+
+    if (flags & FNAME)
+        try$(_skipStr(in));
+
+    if (flags & FCOMMENT)
+        try$(_skipStr(in));
+
+    if (flags & FHCRC) {
+        try$(in.nextByte());
+        try$(in.nextByte());
+    }
+
+    Crypto::Crc32 crc;
+    usize size = 0;
+    try$(Inflate::Inflater{}.run(in, [&](Bytes bytes) -> Res<> {
+        crc.update(bytes);
+        size += bytes.len();
+        return sink(bytes);
+    }));
+
+    if (crc.digest() != try$(_nextU32le(in)))
+        return Error::invalidData("checksum mismatch");
+
+    if ((u32)size != try$(_nextU32le(in)))
+        return Error::invalidData("size mismatch");
+
+    return Ok();
+}
+
+static inline Res<Vec<u8>> decompress(Bytes bytes) {
+    Vec<u8> out;
+    try$(decompress(Inflate::SliceSource{bytes}, Inflate::appendTo(out)));
+    return Ok(out);
+}
+
 } // namespace Gzip
@@ -1,7 +1,490 @@
 #pragma once
 
+// https://www.rfc-editor.org/rfc/rfc1951
 // https://github.com/jibsen/tinf
 
+#include <karm-base/array.h>
+#include <karm-base/opt.h>
+#include <karm-base/res.h>
+#include <karm-base/vec.h>
+
 namespace Inflate {
 
+static constexpr usize WINDOW = 32 * 1024;
+static constexpr usize MAX_MATCH = 258;
+
+static constexpr Array<u16, 29> LENGTH_BASE = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static constexpr Array<u8, 29> LENGTH_EXTRA = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static constexpr Array<u16, 30> DIST_BASE = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+    193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+    6145, 8193, 12289, 16385, 24577
+};
+
+static constexpr Array<u8, 30> DIST_EXTRA = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+    6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// Order in which the code length code lengths are stored.
+static constexpr Array<u8, 19> CLEN_ORDER = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+// MARK: Bit Reader ------------------------------------------------------------
+
+// LSB-first bit reader over a stream of chunks.
+// `Source` is called for the next chunk of input and returns NONE at the end.
+template <typename Source>
+struct BitReader {
+    Source _source;
+    Bytes _chunk{};
+    usize _pos = 0;
+    u64 _bits = 0;
+    usize _count = 0;
+
+    BitReader(Source source)
+        : _source(std::move(source)) {}
+
+    // Fill the bit buffer with at least 56 bits, or everything that's left.
+    always_inline void refill() {
+        if (_pos + 8 <= _chunk.len()) [[likely]] {
+            u64 v;
+            memcpy(&v, _chunk.buf() + _pos, sizeof(v));
+            _bits |= toLe(v) << _count;
+            _pos += (63 - _count) >> 3;
+            _count |= 56;
+            return;
+        }
+
+        while (_count <= 56) {
+            if (_pos == _chunk.len()) {
+                auto next = _source();
+                if (not next)
+                    return;
+                _chunk = *next;
+                _pos = 0;
+                continue;
+            }
+            _bits |= (u64)_chunk[_pos++] << _count;
+            _count += 8;
+        }
+    }
+
+    always_inline u64 peek() const {
+        return _bits;
+    }
+
+    always_inline Res<> consume(usize n) {
+        if (n > _count) [[unlikely]]
+            return Error::unexpectedEof("unexpected end of deflate stream");
+        _bits >>= n;
+        _count -= n;
+        return Ok();
+    }
+
+    always_inline Res<u32> next(usize n) {
+        if (n == 0)
+            return Ok(0);
+        if (_count < n)
+            refill();
+        u32 v = _bits & ((1ull << n) - 1);
+        try$(consume(n));
+        return Ok(v);
+    }
+
+    // Drop the bits up to the next byte boundary.
+    void align() {
+        _bits >>= _count % 8;
+        _count -= _count % 8;
+    }
+
+    Res<u8> nextByte() {
+        align();
+        return Ok(try$(next(8)));
+    }
+};
+
+// MARK: Huffman ---------------------------------------------------------------
+
+// Table driven huffman decoder.
+//
+// Codes of up to FAST_BITS bits are resolved with a single lookup, for the
+// literal/length alphabet an entry can even hold two literals when both
+// codes fit. Longer codes fall back to a canonical, bit by bit, decoding.
+struct Huffman {
+    static constexpr usize MAX_BITS = 15;
+    static constexpr usize FAST_BITS = 10;
+    static constexpr usize FAST_MASK = (1 << FAST_BITS) - 1;
+
+    // Fast entry layout:
+    //   [0..5)   number of bits consumed, 0 for the slow path
+    //   [5..7)   number of symbols
+    //   [7..16)  first symbol
+    //   [16..24) second symbol, always a literal
+    Array<u32, 1 << FAST_BITS> _fast{};
+    Array<u16, MAX_BITS + 1> _counts{};
+    Array<u16, 288> _symbols{};
+
+    static always_inline u32 entryBits(u32 e) { return e & 0x1F; }
+    static always_inline u32 entryLen(u32 e) { return (e >> 5) & 0x3; }
+    static always_inline u32 entrySym(u32 e) { return (e >> 7) & 0x1FF; }
+    static always_inline u32 entrySym2(u32 e) { return (e >> 16) & 0xFF; }
+
+    Res<> build(Slice<u8> lengths, bool pairs = false) {
+        _counts = {};
+        for (auto l : lengths)
+            _counts[l]++;
+        _counts[0] = 0;
+
+        // Check for an over-subscribed code, incomplete ones are allowed.
+        isize left = 1;
+        for (usize len = 1; len <= MAX_BITS; len++) {
+            left = (left << 1) - _counts[len];
+            if (left < 0)
+                return Error::invalidData("over-subscribed huffman code");
+        }
+
+        Array<u16, MAX_BITS + 2> offsets{};
+        for (usize len = 1; len <= MAX_BITS; len++)
+            offsets[len + 1] = offsets[len] + _counts[len];
+
+        for (usize sym = 0; sym < lengths.len(); sym++)
+            if (lengths[sym])
+                _symbols[offsets[lengths[sym]]++] = sym;
+
+        _fast = {};
+        u32 code = 0;
+        usize i = 0;
+        for (usize len = 1; len <= FAST_BITS; len++) {
+            for (usize n = 0; n < _counts[len]; n++, i++, code++) {
+                // Codes are stored MSB first in an LSB first stream.
+                u32 rev = 0;
+                for (usize b = 0; b < len; b++)
+                    rev |= ((code >> b) & 1) << (len - 1 - b);
+
+                u32 entry = len | (1 << 5) | (_symbols[i] << 7);
+                for (u32 j = rev; j <= FAST_MASK; j += 1 << len)
+                    _fast[j] = entry;
+            }
+            code <<= 1;
+        }
+
+        if (pairs)
+            _buildPairs();
+
+        return Ok();
+    }
+
+    void _buildPairs() {
+        // NOTE: Go from the top so the entries we look into for the
+        //       second literal are still single ones.
+        for (usize i = FAST_MASK + 1; i-- > 0;) {
+            u32 e = _fast[i];
+            u32 bits = entryBits(e);
+            if (not bits or entrySym(e) >= 256)
+                continue;
+
+            u32 e2 = _fast[i >> bits];
+            u32 bits2 = entryBits(e2);
+            if (not bits2 or entryLen(e2) != 1 or
+                entrySym(e2) >= 256 or bits + bits2 > FAST_BITS)
+                continue;
+
+            _fast[i] = (bits + bits2) | (2 << 5) | (entrySym(e) << 7) | (entrySym(e2) << 16);
+        }
+    }
+
+    Res<u32> _decodeSlow(auto& in) {
+        u32 code = 0;
+        u32 first = 0;
+        u32 index = 0;
+        u64 bits = in.peek();
+
+        for (usize len = 1; len <= MAX_BITS; len++) {
+            code |= (bits >> (len - 1)) & 1;
+            u32 count = _counts[len];
+            if (code < first + count) {
+                try$(in.consume(len));
+                return Ok(_symbols[index + (code - first)]);
+            }
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+        }
+
+        return Error::invalidData("invalid huffman code");
+    }
+
+    // Decode a single symbol, the caller must have refilled the reader.
+    always_inline Res<u32> decode(auto& in) {
+        u32 e = _fast[in.peek() & FAST_MASK];
+        if (entryBits(e)) [[likely]] {
+            try$(in.consume(entryBits(e)));
+            return Ok(entrySym(e));
+        }
+        return _decodeSlow(in);
+    }
+};
+
+// MARK: Inflater --------------------------------------------------------------
+
+// Streaming deflate decoder.
+//
+// The output goes through a buffer holding the last WINDOW bytes, so matches
+// are plain forward copies. Bytes are handed to the sink as the buffer fills
+// up, the whole output is never held in memory.
+struct Inflater {
+    static constexpr usize CAP = WINDOW * 3;
+
+    Vec<u8> _buf;
+    usize _pos = 0;
+    usize _flushed = 0;
+
+    Huffman _litlen;
+    Huffman _dist;
+
+    Inflater() {
+        // NOTE: 8 bytes of slack so match copies can overshoot.
+        _buf.resize(CAP + 8);
+    }
+
+    // MARK: Output ------------------------------------------------------------
+
+    Res<> _flush(auto& sink) {
+        if (_pos > _flushed)
+            try$(sink(Bytes{_buf.buf() + _flushed, _pos - _flushed}));
+        _flushed = _pos;
+        return Ok();
+    }
+
+    // Make room for at least one more match.
+    always_inline Res<> _reserve(auto& sink) {
+        if (_pos + MAX_MATCH <= CAP) [[likely]]
+            return Ok();
+
+        try$(_flush(sink));
+        memmove(_buf.buf(), _buf.buf() + _pos - WINDOW, WINDOW);
+        _pos = WINDOW;
+        _flushed = WINDOW;
+        return Ok();
+    }
+
+    always_inline void _copy(usize dist, usize len) {
+        u8* dst = _buf.buf() + _pos;
+        u8 const* src = dst - dist;
+        _pos += len;
+
+        if (dist >= 8) {
+            // Chunks never read bytes they wrote themselves.
+            for (usize i = 0; i < len; i += 8)
+                memcpy(dst + i, src + i, 8);
+        } else if (dist == 1) {
+            memset(dst, *src, len);
+        } else {
+            for (usize i = 0; i < len; i++)
+                dst[i] = src[i];
+        }
+    }
+
+    // MARK: Blocks ------------------------------------------------------------
+
+    Res<> _stored(auto& in, auto& sink) {
+        in.align();
+        u16 len = try$(in.next(16));
+        u16 nlen = try$(in.next(16));
+        if (len != (u16)~nlen)
+            return Error::invalidData("stored block length mismatch");
+
+        for (usize i = 0; i < len; i++) {
+            try$(_reserve(sink));
+            _buf[_pos++] = try$(in.next(8));
+        }
+
+        return Ok();
+    }
+
+    Res<> _fixedTables() {
+        Array<u8, 288> lengths;
+        for (usize i = 0; i < 144; i++)
+            lengths[i] = 8;
+        for (usize i = 144; i < 256; i++)
+            lengths[i] = 9;
+        for (usize i = 256; i < 280; i++)
+            lengths[i] = 7;
+        for (usize i = 280; i < 288; i++)
+            lengths[i] = 8;
+        try$(_litlen.build(lengths, true));
+
+        Array<u8, 30> dists;
+        for (auto& d : dists)
+            d = 5;
+        return _dist.build(dists);
+    }
+
+    Res<> _dynamicTables(auto& in) {
+        usize hlit = try$(in.next(5)) + 257;
+        usize hdist = try$(in.next(5)) + 1;
+        usize hclen = try$(in.next(4)) + 4;
+
+        if (hlit > 286 or hdist > 30)
+            return Error::invalidData("invalid dynamic block header");
+
+        Array<u8, 19> clens{};
+        for (usize i = 0; i < hclen; i++)
+            clens[CLEN_ORDER[i]] = try$(in.next(3));
+
+        Huffman clen;
+        try$(clen.build(clens));
+
+        Array<u8, 286 + 30> lengths{};
+        for (usize i = 0; i < hlit + hdist;) {
+            in.refill();
+            u32 sym = try$(clen.decode(in));
+
+            if (sym < 16) {
+                lengths[i++] = sym;
+                continue;
+            }
+
+            u8 fill = 0;
+            usize repeat;
+            if (sym == 16) {
+                if (i == 0)
+                    return Error::invalidData("nothing to repeat");
+                fill = lengths[i - 1];
+                repeat = 3 + try$(in.next(2));
+            } else if (sym == 17) {
+                repeat = 3 + try$(in.next(3));
+            } else {
+                repeat = 11 + try$(in.next(7));
+            }
+
+            if (i + repeat > hlit + hdist)
+                return Error::invalidData("code lengths overflow");
+
+            while (repeat--)
+                lengths[i++] = fill;
+        }
+
+        if (lengths[256] == 0)
+            return Error::invalidData("missing end of block code");
+
+        try$(_litlen.build(sub(lengths, 0, hlit), true));
+        return _dist.build(sub(lengths, hlit, hlit + hdist));
+    }
+
+    [[gnu::flatten]] Res<> _compressed(auto& in, auto& sink) {
+        while (true) {
+            try$(_reserve(sink));
+            in.refill();
+
+            u32 e = _litlen._fast[in.peek() & Huffman::FAST_MASK];
+            u32 sym;
+            if (Huffman::entryBits(e)) [[likely]] {
+                try$(in.consume(Huffman::entryBits(e)));
+                sym = Huffman::entrySym(e);
+                if (Huffman::entryLen(e) == 2) {
+                    _buf[_pos++] = sym;
+                    _buf[_pos++] = Huffman::entrySym2(e);
+                    continue;
+                }
+            } else {
+                sym = try$(_litlen._decodeSlow(in));
+            }
+
+            if (sym < 256) {
+                _buf[_pos++] = sym;
+                continue;
+            }
+
+            if (sym == 256)
+                return Ok();
+
+            sym -= 257;
+            if (sym >= 29)
+                return Error::invalidData("invalid length symbol");
+
+            // NOTE: After a refill there are at least 56 bits, enough for
+            //       the length extra bits (5), the distance code (15) and
+            //       its extra bits (13).
+            usize len = LENGTH_BASE[sym] + try$(in.next(LENGTH_EXTRA[sym]));
+
+            u32 dsym = try$(_dist.decode(in));
+            if (dsym >= 30)
+                return Error::invalidData("invalid distance symbol");
+            usize dist = DIST_BASE[dsym] + try$(in.next(DIST_EXTRA[dsym]));
+
+            if (dist > _pos)
+                return Error::invalidData("distance too far back");
+
+            _copy(dist, len);
+        }
+    }
+
+    // Decode a whole deflate stream, the reader is left right after
+    // the last block so containers can read their trailer.
+    Res<> run(auto& in, auto&& sink) {
+        _pos = 0;
+        _flushed = 0;
+
+        bool last = false;
+        while (not last) {
+            last = try$(in.next(1));
+            u32 type = try$(in.next(2));
+
+            if (type == 0) {
+                try$(_stored(in, sink));
+            } else if (type == 1) {
+                try$(_fixedTables());
+                try$(_compressed(in, sink));
+            } else if (type == 2) {
+                try$(_dynamicTables(in));
+                try$(_compressed(in, sink));
+            } else {
+                return Error::invalidData("invalid block type");
+            }
+        }
+
+        return _flush(sink);
+    }
+};
+
+// MARK: Helpers ---------------------------------------------------------------
+
+// Source for input held in a single slice.
+struct SliceSource {
+    Opt<Bytes> _bytes;
+
+    Opt<Bytes> operator()() {
+        return std::exchange(_bytes, NONE);
+    }
+};
+
+// Sink appending the output to a vector.
+static inline auto appendTo(Vec<u8>& out) {
+    return [&out](Bytes chunk) -> Res<> {
+        usize len = out.len();
+        out.resize(len + chunk.len());
+        memcpy(out.buf() + len, chunk.buf(), chunk.len());
+        return Ok();
+    };
+}
+
+static inline Res<Vec<u8>> inflate(Bytes bytes) {
+    BitReader in{SliceSource{bytes}};
+    Vec<u8> out;
+    try$(Inflater{}.run(in, appendTo(out)));
+    return Ok(out);
+}
+
 } // namespace Inflate
@@ -0,0 +1,54 @@
+#include <karm-archive/deflate/spec.h>
+#include <karm-archive/zlib/spec.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Archive::Tests {
+
+static bool same(Vec<u8> const& out, Bytes expected) {
+    return out.len() == expected.len() and
+           memcmp(out.buf(), expected.buf(), out.len()) == 0;
+}
+
+test$("deflate-roundtrip") {
+    Str inputs[] = {
+        "",
+        "a",
+        "hello, world",
+        "abcabcabcabcabcabcabcabcabcabcabcabcabcabcabc",
+    };
+
+    for (auto input : inputs) {
+        auto data = bytes(input);
+        auto out = try$(Inflate::inflate(Deflate::deflate(data)));
+        expect$(same(out, data));
+    }
+
+    return Ok();
+}
+
+test$("deflate-repetitive") {
+    Vec<u8> input;
+    for (usize i = 0; i < 64 * 1024; i++)
+        input.pushBack("Lorem ipsum dolor sit amet, "[i % 28]);
+
+    auto deflated = Deflate::deflate(input);
+    expect$(deflated.len() < input.len() / 10);
+
+    auto out = try$(Inflate::inflate(deflated));
+    expect$(same(out, bytes(input)));
+
+    return Ok();
+}
+
+test$("zlib-compress") {
+    Vec<u8> input;
+    for (usize i = 0; i < 4096; i++)
+        input.pushBack((i * 7) ^ (i >> 3));
+
+    auto out = try$(Zlib::decompress(Zlib::compress(input)));
+    expect$(same(out, bytes(input)));
+
+    return Ok();
+}
+
+} // namespace Karm::Archive::Tests
@@ -0,0 +1,119 @@
+#include <karm-archive/gzip/spec.h>
+#include <karm-archive/zlib/spec.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Archive::Tests {
+
+static constexpr Str HELLO = "hello, world";
+
+static constexpr Str LOREM =
+    "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod "
+    "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, "
+    "quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat.";
+
+static bool same(Vec<u8> const& out, Str expected) {
+    return out.len() == expected.len() and
+           memcmp(out.buf(), expected.buf(), out.len()) == 0;
+}
+
+test$("inflate-stored") {
+    Array<u8, 17> data = {
+        0x01, 0x0C, 0x00, 0xF3, 0xFF, 0x68, 0x65, 0x6C, 0x6C, 0x6F, 0x2C, 0x20,
+        0x77, 0x6F, 0x72, 0x6C, 0x64
+    };
+
+    auto out = try$(Inflate::inflate(data));
+    expect$(same(out, HELLO));
+
+    return Ok();
+}
+
+test$("inflate-fixed") {
+    Array<u8, 14> data = {
+        0xCB, 0x48, 0xCD, 0xC9, 0xC9, 0xD7, 0x51, 0x28, 0xCF, 0x2F, 0xCA, 0x49,
+        0x01, 0x00
+    };
+
+    auto out = try$(Inflate::inflate(data));
+    expect$(same(out, HELLO));
+
+    return Ok();
+}
+
+static constexpr Array<u8, 150> LOREM_DEFLATED = {
+    0x25, 0x8F, 0x51, 0x8E, 0x03, 0x31, 0x08, 0x43, 0xAF, 0xE2, 0x03, 0x54,
+    0x3D, 0x49, 0x7F, 0xF7, 0x00, 0x34, 0x41, 0x95, 0xA5, 0x10, 0x66, 0x02,
+    0x59, 0xED, 0xF1, 0x97, 0xE9, 0xFC, 0x81, 0xB0, 0x9F, 0xCD, 0xCB, 0x97,
+    0x1A, 0x78, 0xC4, 0x36, 0x74, 0x1F, 0xBE, 0x10, 0x4C, 0x88, 0x69, 0x3E,
+    0xD0, 0x7C, 0x86, 0xB6, 0xD4, 0xDC, 0x0B, 0xD2, 0x79, 0x30, 0x1A, 0xE7,
+    0x07, 0x3A, 0x58, 0xC7, 0xD0, 0x5E, 0x06, 0x28, 0x77, 0x98, 0x77, 0xA4,
+    0xDA, 0x51, 0x66, 0xCE, 0xC6, 0xCE, 0xBE, 0x67, 0x62, 0x27, 0x86, 0xBC,
+    0x0B, 0x0F, 0xCD, 0x1B, 0xAD, 0x30, 0xF9, 0x4C, 0x81, 0x0C, 0x9E, 0x5B,
+    0x9E, 0xF8, 0x49, 0xE8, 0xA4, 0x15, 0x1B, 0xC6, 0x6B, 0xF8, 0xAD, 0x55,
+    0xEC, 0x81, 0x73, 0x33, 0x30, 0x3D, 0x72, 0xED, 0x0E, 0xFD, 0xD3, 0xD5,
+    0x98, 0x92, 0xF4, 0x89, 0x3D, 0x86, 0x58, 0xF3, 0x9B, 0x7C, 0x89, 0x18,
+    0xBC, 0x92, 0xBE, 0x48, 0x1E, 0x25, 0x86, 0x4A, 0x15, 0xB7, 0xEA, 0xE4,
+    0xF7, 0x03, 0x15, 0x95, 0xCF, 0x7F
+};
+
+test$("inflate-dynamic") {
+    auto out = try$(Inflate::inflate(LOREM_DEFLATED));
+    expect$(same(out, LOREM));
+
+    return Ok();
+}
+
+test$("inflate-chunked") {
+    // Feed the input one byte at a time to exercise the refills
+    usize pos = 0;
+    auto source = [&] -> Opt<Bytes> {
+        if (pos == LOREM_DEFLATED.len())
+            return NONE;
+        pos++;
+        return sub(LOREM_DEFLATED, pos - 1, pos);
+    };
+
+    Inflate::BitReader in{source};
+    Vec<u8> out;
+    try$(Inflate::Inflater{}.run(in, Inflate::appendTo(out)));
+    expect$(same(out, LOREM));
+
+    return Ok();
+}
+
+test$("inflate-truncated") {
+    expect$(not Inflate::inflate(sub(LOREM_DEFLATED, 0, 75)));
+
+    return Ok();
+}
+
+test$("zlib-decompress") {
+    Array<u8, 20> data = {
+        0x78, 0x9C, 0xCB, 0x48, 0xCD, 0xC9, 0xC9, 0xD7, 0x51, 0x28, 0xCF, 0x2F,
+        0xCA, 0x49, 0x01, 0x00, 0x1D, 0x54, 0x04, 0x89
+    };
+
+    auto out = try$(Zlib::decompress(data));
+    expect$(same(out, HELLO));
+
+    // Corrupt the checksum
+    data[19] ^= 0xFF;
+    expect$(not Zlib::decompress(data));
+
+    return Ok();
+}
+
+test$("gzip-decompress") {
+    Array<u8, 32> data = {
+        0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xCB, 0x48,
+        0xCD, 0xC9, 0xC9, 0xD7, 0x51, 0x28, 0xCF, 0x2F, 0xCA, 0x49, 0x01, 0x00,
+        0x3A, 0x72, 0xAB, 0xFF, 0x0C, 0x00, 0x00, 0x00
+    };
+
+    auto out = try$(Gzip::decompress(data));
+    expect$(same(out, HELLO));
+
+    return Ok();
+}
+
+} // namespace Karm::Archive::Tests
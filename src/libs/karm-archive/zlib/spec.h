@@ -1,5 +1,67 @@
 #pragma once
 
+// https://www.rfc-editor.org/rfc/rfc1950
+
+#include <karm-crypto/adler32.h>
+
+#include "../deflate/spec.h"
+#include "../inflate/spec.h"
+
 namespace Zlib {
 
+// Decompress a zlib stream, chunks of input are pulled from `source`
+// and the output is pushed to `sink` as it gets decoded.
+static inline Res<> decompress(auto source, auto&& sink) {
+    Inflate::BitReader in{std::move(source)};
+
+    u8 cmf = try$(in.nextByte());
+    u8 flg = try$(in.nextByte());
+
+    if ((cmf & 0x0F) != 8)
+        return Error::invalidData("unsupported compression method");
+
+    if (((cmf << 8) | flg) % 31 != 0)
+        return Error::invalidData("invalid header check");
+
+    if (flg & 0x20)
+        return Error::invalidData("preset dictionaries are not supported");
+
+    u32 adler = 1;
+    try$(Inflate::Inflater{}.run(in, [&](Bytes bytes) -> Res<> {
+        adler = Crypto::adler32(bytes, adler);
+        return sink(bytes);
+    }));
+
+    u32 expected = 0;
+    for (usize i = 0; i < 4; i++)
+        expected = (expected << 8) | try$(in.nextByte());
+
+    if (adler != expected)
+        return Error::invalidData("checksum mismatch");
+
+    return Ok();
+}
+
+static inline Res<Vec<u8>> decompress(Bytes bytes) {
+    Vec<u8> out;
+    try$(decompress(Inflate::SliceSource{bytes}, Inflate::appendTo(out)));
+    return Ok(out);
+}
+
+static inline Vec<u8> compress(Bytes bytes) {
+    Vec<u8> out;
+    // CM=8 (deflate), CINFO=7 (32K window), FLEVEL=2 (default)
+    out.pushBack(0x78);
+    out.pushBack(0x9C);
+
+    Deflate::BitWriter bits{out};
+    Deflate::Deflater{}.run(bytes, bits);
+
+    u32 adler = Crypto::adler32(bytes);
+    for (isize i = 3; i >= 0; i--)
+        out.pushBack((adler >> (i * 8)) & 0xff);
+
+    return out;
+}
+
 } // namespace Zlib
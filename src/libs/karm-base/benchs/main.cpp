@@ -0,0 +1,40 @@
+#include <karm-base/hashmap.h>
+#include <karm-base/map.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+
+static constexpr usize LOOKUPS = 1000000;
+
+// Returns the average cost of a lookup in nanoseconds
+template <typename M>
+f64 benchLookup(usize size) {
+    M map;
+    for (usize i = 0; i < size; i++)
+        map.put(i * 7919, i);
+
+    usize sum = 0;
+    auto start = Sys::now();
+    for (usize i = 0; i < LOOKUPS; i++) {
+        auto v = map.access((i % size) * 7919);
+        sum += v ? *v : 0;
+    }
+    auto elapsed = Sys::now() - start;
+
+    // Keep the optimizer from throwing away the loop
+    if (sum == 42)
+        Sys::println("");
+
+    return (elapsed.toUSecs() * 1000.0) / LOOKUPS;
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    Sys::println("average lookup cost over {} lookups", LOOKUPS);
+
+    for (usize size = 4; size <= 4096; size *= 2) {
+        auto linear = benchLookup<Map<usize, usize>>(size);
+        auto hashed = benchLookup<HashMap<usize, usize>>(size);
+        Sys::println("size {}: Map {.1}ns, HashMap {.1}ns", size, linear, hashed);
+    }
+
+    co_return Ok();
+}
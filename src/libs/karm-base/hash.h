@@ -2,6 +2,7 @@
 
 #include "checked.h"
 #include "slice.h"
+#include "tuple.h"
 
 namespace Karm {
 
@@ -20,6 +21,10 @@ Hash hash(T const& v) {
     return Hasher<T>::hash(v);
 }
 
+constexpr Hash hashCombine(Hash seed, Hash h) {
+    return seed ^ (h + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2));
+}
+
 template <>
 struct Hasher<Hash> {
     static constexpr Hash hash(Hash h) {
@@ -62,4 +67,18 @@ struct Hasher<T> {
     }
 };
 
+template <typename T>
+struct Hasher<T*> {
+    static constexpr Hash hash(T* const& v) {
+        return Hasher<usize>::hash(reinterpret_cast<usize>(v));
+    }
+};
+
+template <typename T0, typename T1>
+struct Hasher<Tuple<T0, T1>> {
+    static constexpr Hash hash(Tuple<T0, T1> const& v) {
+        return hashCombine(::hash(v.v0), ::hash(v.v1));
+    }
+};
+
 } // namespace Karm
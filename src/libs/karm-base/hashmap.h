@@ -0,0 +1,298 @@
+#pragma once
+
+#include "clamp.h"
+#include "cursor.h"
+#include "hash.h"
+#include "iter.h"
+#include "manual.h"
+#include "panic.h"
+#include "tuple.h"
+
+namespace Karm {
+
+// Open-addressing hash map with linear probing.
+//
+// Exposes the same API as Map<K, V> but lookups are O(1) instead of O(n).
+// Iteration order is unspecified, use Map<K, V> if insertion order matters.
+template <typename K, typename V>
+struct HashMap {
+    struct Slot : public Manual<Pair<K, V>> {
+        enum State : u8 {
+            FREE,
+            USED,
+            DEAD,
+        };
+
+        State state = State::FREE;
+    };
+
+    Slot* _slots = nullptr;
+    usize _cap = 0;
+    usize _len = 0;
+    usize _dead = 0;
+
+    HashMap(usize cap = 0) {
+        if (cap)
+            _rehash(_capFor(cap));
+    }
+
+    HashMap(std::initializer_list<Pair<K, V>>&& list)
+        : HashMap(list.size()) {
+        for (auto& [k, v] : list)
+            put(k, v);
+    }
+
+    HashMap(HashMap const& other)
+        : HashMap(other._len) {
+        for (auto const& [k, v] : other.iter())
+            put(k, v);
+    }
+
+    HashMap(HashMap&& other)
+        : _slots(std::exchange(other._slots, nullptr)),
+          _cap(std::exchange(other._cap, 0)),
+          _len(std::exchange(other._len, 0)),
+          _dead(std::exchange(other._dead, 0)) {}
+
+    ~HashMap() {
+        clear();
+    }
+
+    HashMap& operator=(HashMap const& other) {
+        *this = HashMap(other);
+        return *this;
+    }
+
+    HashMap& operator=(HashMap&& other) {
+        std::swap(_slots, other._slots);
+        std::swap(_cap, other._cap);
+        std::swap(_len, other._len);
+        std::swap(_dead, other._dead);
+        return *this;
+    }
+
+    // MARK: Internals ---------------------------------------------------------
+
+    static constexpr usize _capFor(usize len) {
+        // Keep the load factor under 75%
+        usize cap = 16;
+        while (cap * 3 < len * 4)
+            cap *= 2;
+        return cap;
+    }
+
+    always_inline usize _index(K const& key) const {
+        // Fibonacci hashing, takes the high bits of the product so weak
+        // hashes still spread over the whole table.
+        u64 h = hash(key) * 11400714819323198485ull;
+        return h >> (64 - __builtin_ctzll(_cap));
+    }
+
+    void _rehash(usize desired) {
+        auto* oldSlots = _slots;
+        usize oldCap = _cap;
+
+        _slots = new Slot[desired];
+        _cap = desired;
+        _len = 0;
+        _dead = 0;
+
+        for (usize i = 0; i < oldCap; i++) {
+            if (oldSlots[i].state != Slot::USED)
+                continue;
+            auto& pair = oldSlots[i].unwrap();
+            _insert(std::move(pair.v0), std::move(pair.v1));
+            oldSlots[i].dtor();
+        }
+
+        delete[] oldSlots;
+    }
+
+    void ensure(usize desired) {
+        if (_capFor(desired) <= _cap)
+            return;
+        _rehash(_capFor(desired));
+    }
+
+    Slot* _lookup(K const& key) const {
+        if (_len == 0)
+            return nullptr;
+
+        usize i = _index(key);
+        while (_slots[i].state != Slot::FREE) {
+            auto& s = _slots[i];
+            if (s.state == Slot::USED and s.unwrap().v0 == key)
+                return &s;
+            i = (i + 1) & (_cap - 1);
+        }
+        return nullptr;
+    }
+
+    // NOTE: The caller must make sure the key is not already present.
+    Slot& _insert(K key, V value) {
+        usize i = _index(key);
+        while (_slots[i].state == Slot::USED)
+            i = (i + 1) & (_cap - 1);
+
+        auto& s = _slots[i];
+        if (s.state == Slot::DEAD)
+            _dead--;
+        s.ctor(Pair<K, V>{std::move(key), std::move(value)});
+        s.state = Slot::USED;
+        _len++;
+        return s;
+    }
+
+    void _remove(Slot& s) {
+        s.dtor();
+        s.state = Slot::DEAD;
+        _len--;
+        _dead++;
+    }
+
+    // MARK: Map API -----------------------------------------------------------
+
+    void put(K const& key, V value) {
+        if (auto* s = _lookup(key)) {
+            s->unwrap().v1 = std::move(value);
+            return;
+        }
+
+        // Dead slots still lengthen probe chains, so they count toward the load.
+        if ((_len + _dead + 1) * 4 > _cap * 3)
+            _rehash(_capFor(_len + 1));
+
+        _insert(key, std::move(value));
+    }
+
+    bool has(K const& key) const {
+        return _lookup(key);
+    }
+
+    V& get(K const& key) {
+        if (auto* s = _lookup(key))
+            return s->unwrap().v1;
+        panic("key not found");
+    }
+
+    V const& get(K const& key) const {
+        if (auto* s = _lookup(key))
+            return s->unwrap().v1;
+        panic("key not found");
+    }
+
+    MutCursor<V> access(K const& key) {
+        if (auto* s = _lookup(key))
+            return &s->unwrap().v1;
+        return {};
+    }
+
+    Cursor<V> access(K const& key) const {
+        if (auto* s = _lookup(key))
+            return &s->unwrap().v1;
+        return {};
+    }
+
+    V take(K const& key) {
+        auto* s = _lookup(key);
+        if (not s)
+            panic("key not found");
+        V value = std::move(s->unwrap().v1);
+        _remove(*s);
+        return value;
+    }
+
+    Opt<V> tryGet(K const& key) const {
+        if (auto* s = _lookup(key))
+            return s->unwrap().v1;
+        return NONE;
+    }
+
+    bool del(K const& key) {
+        auto* s = _lookup(key);
+        if (not s)
+            return false;
+        _remove(*s);
+        return true;
+    }
+
+    bool removeAll(V const& value) {
+        bool changed = false;
+        for (usize i = 0; i < _cap; i++) {
+            if (_slots[i].state == Slot::USED and
+                _slots[i].unwrap().v1 == value) {
+                _remove(_slots[i]);
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    bool removeIf(auto pred) {
+        bool changed = false;
+        for (usize i = 0; i < _cap; i++) {
+            if (_slots[i].state == Slot::USED and
+                pred(_slots[i].unwrap().v0, _slots[i].unwrap().v1)) {
+                _remove(_slots[i]);
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    bool removeFirst(V const& value) {
+        for (usize i = 0; i < _cap; i++) {
+            if (_slots[i].state == Slot::USED and
+                _slots[i].unwrap().v1 == value) {
+                _remove(_slots[i]);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    auto iter() {
+        return Iter{[&, i = 0uz] mutable -> Pair<K, V>* {
+            while (i < _cap and _slots[i].state != Slot::USED)
+                i++;
+
+            if (i == _cap)
+                return nullptr;
+
+            return &_slots[i++].unwrap();
+        }};
+    }
+
+    auto iter() const {
+        return Iter{[&, i = 0uz] mutable -> Pair<K, V> const* {
+            while (i < _cap and _slots[i].state != Slot::USED)
+                i++;
+
+            if (i == _cap)
+                return nullptr;
+
+            return &_slots[i++].unwrap();
+        }};
+    }
+
+    usize len() const {
+        return _len;
+    }
+
+    void clear() {
+        if (not _slots)
+            return;
+
+        for (usize i = 0; i < _cap; i++)
+            if (_slots[i].state == Slot::USED)
+                _slots[i].dtor();
+        delete[] _slots;
+
+        _slots = nullptr;
+        _cap = 0;
+        _len = 0;
+        _dead = 0;
+    }
+};
+
+} // namespace Karm
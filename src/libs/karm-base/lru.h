@@ -1,19 +1,20 @@
 #pragma once
 
+#include "hashmap.h"
 #include "list.h"
-#include "map.h"
 
 namespace Karm {
 
 template <typename K, typename V>
 struct Lru {
     struct Item {
+        K key;
         V value;
         LlItem<Item> item{};
     };
 
     usize _cap;
-    Map<K, Item*> _map;
+    HashMap<K, Item*> _map;
     Ll<Item> _ll;
 
     Lru(usize cap) : _cap(cap) {}
@@ -43,7 +44,7 @@ struct Lru {
         while (_ll.len() > _cap) {
             auto* item = _ll.tail();
             _ll.detach(item);
-            _map.removeFirst(item);
+            _map.del(item->key);
             delete item;
         }
     }
@@ -54,13 +55,20 @@ struct Lru {
             return item->value;
         }
 
-        item = new Item{make()};
+        item = new Item{key, make()};
         _ll.prepend(item, _ll.head());
         _map.put(key, item);
         _evict();
         return item->value;
     }
 
+    MutCursor<V> access(K const& key) {
+        auto item = _lookup(key);
+        if (item)
+            return &item->value;
+        return nullptr;
+    }
+
     Opt<V> tryGet(K const& key) {
         auto item = _lookup(key);
         if (item) {
@@ -69,6 +77,16 @@ struct Lru {
         return NONE;
     }
 
+    bool del(K const& key) {
+        Opt<Item*> item = _map.tryGet(key);
+        if (not item.has())
+            return false;
+        _ll.detach(*item);
+        _map.del(key);
+        delete *item;
+        return true;
+    }
+
     bool contains(K const& key) {
         return _lookup(key) != nullptr;
     }
@@ -5,6 +5,8 @@
 
 namespace Karm {
 
+// Insertion-ordered map backed by a vector, lookups are O(n).
+// Prefer HashMap<K, V> for large or hot maps where order doesn't matter.
 template <typename K, typename V>
 struct Map {
     Vec<Pair<K, V>> _els{};
@@ -0,0 +1,161 @@
+#include <karm-base/hashmap.h>
+#include <karm-base/map.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Base::Tests {
+
+test$("hashmap-put-get") {
+    HashMap<int, int> map{};
+    map.put(420, 69);
+    expect$(map.has(420));
+    expectEq$(map.get(420), 69);
+    map.put(420, 42);
+    expectEq$(map.get(420), 42);
+    expectEq$(map.len(), 1uz);
+
+    return Ok();
+}
+
+test$("hashmap-try-get") {
+    HashMap<int, int> map{};
+    expect$(not map.tryGet(1).has());
+    map.put(1, 2);
+    expectEq$(map.tryGet(1), 2);
+
+    return Ok();
+}
+
+test$("hashmap-del") {
+    HashMap<int, int> map{};
+    map.put(1, 10);
+    map.put(2, 20);
+    expect$(map.del(1));
+    expect$(not map.del(1));
+    expect$(not map.has(1));
+    expect$(map.has(2));
+    expectEq$(map.len(), 1uz);
+
+    return Ok();
+}
+
+test$("hashmap-take") {
+    HashMap<int, int> map{};
+    map.put(1, 10);
+    expectEq$(map.take(1), 10);
+    expect$(not map.has(1));
+    expectEq$(map.len(), 0uz);
+
+    return Ok();
+}
+
+test$("hashmap-remove-value") {
+    HashMap<int, int> map{};
+    map.put(1, 10);
+    map.put(2, 10);
+    map.put(3, 30);
+    expect$(map.removeFirst(10));
+    expectEq$(map.len(), 2uz);
+    expect$(map.removeAll(10));
+    expectEq$(map.len(), 1uz);
+    expect$(map.has(3));
+
+    return Ok();
+}
+
+test$("hashmap-grow") {
+    HashMap<usize, usize> map{};
+    for (usize i = 0; i < 1000; i++)
+        map.put(i, i * 2);
+    expectEq$(map.len(), 1000uz);
+    for (usize i = 0; i < 1000; i++)
+        expectEq$(map.get(i), i * 2);
+
+    return Ok();
+}
+
+test$("hashmap-churn") {
+    // Repeated put/del must not fill the table with tombstones.
+    HashMap<usize, usize> map{};
+    for (usize i = 0; i < 10000; i++) {
+        map.put(i, i);
+        map.del(i);
+    }
+    expectEq$(map.len(), 0uz);
+    expectLteq$(map._cap, 16uz);
+
+    return Ok();
+}
+
+test$("hashmap-iter") {
+    HashMap<int, int> map{};
+    for (int i = 0; i < 100; i++)
+        map.put(i, i);
+
+    int sum = 0;
+    for (auto const& [k, v] : map.iter())
+        sum += v;
+    expectEq$(sum, 4950);
+
+    return Ok();
+}
+
+test$("hashmap-remove-if") {
+    HashMap<int, int> map{};
+    for (int i = 0; i < 100; i++)
+        map.put(i, i * 2);
+
+    expect$(map.removeIf([](int k, int) {
+        return k >= 10;
+    }));
+    expectEq$(map.len(), 10uz);
+    expect$(map.has(9));
+    expect$(not map.has(10));
+
+    return Ok();
+}
+
+test$("hashmap-string-keys") {
+    HashMap<String, int> map{};
+    map.put("hello"s, 1);
+    map.put("world"s, 2);
+    expectEq$(map.get("hello"s), 1);
+    expectEq$(map.get("world"s), 2);
+    expect$(not map.has("olleh"s));
+
+    return Ok();
+}
+
+test$("hashmap-pair-keys") {
+    HashMap<Pair<int>, int> map{};
+    map.put({1, 2}, 3);
+    map.put({2, 1}, 4);
+    expectEq$(map.get({1, 2}), 3);
+    expectEq$(map.get({2, 1}), 4);
+
+    return Ok();
+}
+
+test$("hashmap-copy") {
+    HashMap<int, int> a{};
+    a.put(1, 1);
+    HashMap<int, int> b = a;
+    b.put(2, 2);
+    expectEq$(a.len(), 1uz);
+    expectEq$(b.len(), 2uz);
+
+    return Ok();
+}
+
+test$("map-preserves-order") {
+    Map<int, int> map{};
+    map.put(3, 0);
+    map.put(1, 0);
+    map.put(2, 0);
+    expectEq$(map._els[0].v0, 3);
+    expectEq$(map._els[1].v0, 1);
+    expectEq$(map._els[2].v0, 2);
+
+    return Ok();
+}
+
+} // namespace Karm::Base::Tests
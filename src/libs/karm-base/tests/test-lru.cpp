@@ -72,4 +72,39 @@ test$("lru-evict") {
     return Ok();
 }
 
+test$("lru-del") {
+    Lru<int, int> cache{10};
+
+    for (int i = 0; i < 10; i++) {
+        (void)cache.access(i, [&] {
+            return i * 10;
+        });
+    }
+
+    expect$(cache.del(4));
+    expect$(not cache.del(4));
+    expect$(not cache.contains(4));
+    expectEq$(cache.len(), 9uz);
+    expectEq$(cache.tryGet(5), 50);
+
+    return Ok();
+}
+
+test$("lru-access-in-place") {
+    Lru<int, int> cache{10};
+
+    (void)cache.access(1, [] {
+        return 10;
+    });
+
+    expect$(not cache.access(2));
+
+    auto cached = cache.access(1);
+    expect$(cached);
+    *cached = 20;
+    expectEq$(cache.tryGet(1), 20);
+
+    return Ok();
+}
+
 } // namespace Karm::Base::Tests
@@ -28,4 +28,22 @@ test$("vec-push-front-slice") {
     return Ok();
 }
 
+test$("vec-remove-if") {
+    Vec<int> vec = {1, 2, 3, 4, 5, 6};
+
+    expect$(vec.removeIf([](int v) {
+        return v % 2 == 0;
+    }));
+    expectEq$(vec.len(), 3uz);
+    expectEq$(vec[0], 1);
+    expectEq$(vec[1], 3);
+    expectEq$(vec[2], 5);
+
+    expect$(not vec.removeIf([](int v) {
+        return v > 10;
+    }));
+
+    return Ok();
+}
+
 } // namespace Karm::Base::Tests
@@ -37,6 +37,20 @@ struct _Vec {
         return changed;
     }
 
+    bool removeIf(auto pred) {
+        bool changed = false;
+
+        for (usize i = 1; i < _buf.len() + 1; i++) {
+            if (pred(_buf[i - 1])) {
+                _buf.removeAt(i - 1);
+                changed = true;
+                i--;
+            }
+        }
+
+        return changed;
+    }
+
     // MARK: Capacity
 
     void ensure(usize cap) { _buf.ensure(cap); }
@@ -1,3 +1,5 @@
+#include <karm-base/simd.h>
+
 #include "adler32.h"
 
 namespace Karm::Crypto {
@@ -5,59 +7,116 @@ namespace Karm::Crypto {
 static constexpr usize ADLER32_BASE = 65521;
 static constexpr usize ADLER32_NMAX = 5552;
 
-u32 adler32(Bytes bytes) {
+// MARK: Scalar ----------------------------------------------------------------
+
+static void _adler32Scalar(u8 const* buf, usize len, u32& s1, u32& s2) {
+    for (usize i = len / 16; i; --i, buf += 16) {
+        s1 += buf[0];
+        s2 += s1;
+        s1 += buf[1];
+        s2 += s1;
+        s1 += buf[2];
+        s2 += s1;
+        s1 += buf[3];
+        s2 += s1;
+        s1 += buf[4];
+        s2 += s1;
+        s1 += buf[5];
+        s2 += s1;
+        s1 += buf[6];
+        s2 += s1;
+        s1 += buf[7];
+        s2 += s1;
+
+        s1 += buf[8];
+        s2 += s1;
+        s1 += buf[9];
+        s2 += s1;
+        s1 += buf[10];
+        s2 += s1;
+        s1 += buf[11];
+        s2 += s1;
+        s1 += buf[12];
+        s2 += s1;
+        s1 += buf[13];
+        s2 += s1;
+        s1 += buf[14];
+        s2 += s1;
+        s1 += buf[15];
+        s2 += s1;
+    }
+
+    for (usize i = len % 16; i; --i) {
+        s1 += *buf++;
+        s2 += s1;
+    }
+}
+
+// MARK: SSE2 ------------------------------------------------------------------
+
+#ifdef __x86_64__
+
+// SSE2 is part of the x86_64 baseline, so this needs no detection.
+// Each 16 bytes block adds its byte sum to s1 with psadbw and its
+// weighted sum to s2 with pmaddwd, the weight of byte j being 16 - j.
+// The s1 of the previous blocks still has to be added 16 times to s2
+// for every block, so it is accumulated in `prev` and scaled at the end.
+
+static void _adler32Sse2(u8 const* buf, usize len, u32& s1, u32& s2) {
+    usize n = len & ~usize(15);
+
+    i16x8 const weightsLo = {16, 15, 14, 13, 12, 11, 10, 9};
+    i16x8 const weightsHi = {8, 7, 6, 5, 4, 3, 2, 1};
+    u8x16 const zero = {};
+
+    u32x4 sum = {};
+    u32x4 prev = {};
+    u32x4 weighted = {};
+
+    for (usize i = 0; i < n; i += 16, buf += 16) {
+        u8x16 block;
+        memcpy(&block, buf, sizeof(block));
+
+        prev += sum;
+        sum += (u32x4)__builtin_ia32_psadbw128((c8x16)block, (c8x16)zero);
+
+        auto lo = (i16x8)__builtin_shufflevector(block, zero, 0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+        auto hi = (i16x8)__builtin_shufflevector(block, zero, 8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+        weighted += (u32x4)__builtin_ia32_pmaddwd128(lo, weightsLo);
+        weighted += (u32x4)__builtin_ia32_pmaddwd128(hi, weightsHi);
+    }
+
+    u64 sumAll = u64(sum[0]) + sum[2];
+    u64 prevAll = u64(prev[0]) + prev[2];
+    u64 weightedAll = u64(weighted[0]) + weighted[1] + weighted[2] + weighted[3];
+
+    s2 = (s2 + u64(s1) * n + 16 * prevAll + weightedAll) % ADLER32_BASE;
+    s1 = (s1 + sumAll) % ADLER32_BASE;
+
+    _adler32Scalar(buf, len - n, s1, s2);
+}
+
+#endif
+
+u32 adler32(Bytes bytes, u32 adler) {
     auto [buf, len] = bytes;
 
-    u32 s1 = 1;
-    u32 s2 = 0;
+    u32 s1 = adler & 0xFFFF;
+    u32 s2 = adler >> 16;
 
     while (len > 0) {
         usize k = len < ADLER32_NMAX ? len : ADLER32_NMAX;
 
-        for (usize i = k / 16; i; --i, buf += 16) {
-            s1 += buf[0];
-            s2 += s1;
-            s1 += buf[1];
-            s2 += s1;
-            s1 += buf[2];
-            s2 += s1;
-            s1 += buf[3];
-            s2 += s1;
-            s1 += buf[4];
-            s2 += s1;
-            s1 += buf[5];
-            s2 += s1;
-            s1 += buf[6];
-            s2 += s1;
-            s1 += buf[7];
-            s2 += s1;
-
-            s1 += buf[8];
-            s2 += s1;
-            s1 += buf[9];
-            s2 += s1;
-            s1 += buf[10];
-            s2 += s1;
-            s1 += buf[11];
-            s2 += s1;
-            s1 += buf[12];
-            s2 += s1;
-            s1 += buf[13];
-            s2 += s1;
-            s1 += buf[14];
-            s2 += s1;
-            s1 += buf[15];
-            s2 += s1;
-        }
-
-        for (usize i = k % 16; i; --i) {
-            s1 += *buf++;
-            s2 += s1;
-        }
+#ifdef __x86_64__
+        _adler32Sse2(buf, k, s1, s2);
+#else
+        _adler32Scalar(buf, k, s1, s2);
+#endif
 
         s1 %= ADLER32_BASE;
         s2 %= ADLER32_BASE;
 
+        buf += k;
         len -= k;
     }
 
@@ -4,6 +4,7 @@
 
 namespace Karm::Crypto {
 
-u32 adler32(Bytes bytes);
+// `adler` continues a previous checksum, so the input can be streamed.
+u32 adler32(Bytes bytes, u32 adler = 1);
 
 } // namespace Karm::Crypto
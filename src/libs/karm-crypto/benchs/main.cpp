@@ -0,0 +1,50 @@
+#include <karm-crypto/adler32.h>
+#include <karm-crypto/crc32.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+
+static constexpr usize SIZE = 64 * 1024 * 1024;
+static constexpr usize ROUNDS = 8;
+
+// Returns the throughput of `f` in GB/s
+f64 benchThroughput(Bytes data, auto f) {
+    u32 sum = 0;
+    auto start = Sys::now();
+    for (usize i = 0; i < ROUNDS; i++)
+        sum ^= f(data);
+    auto elapsed = Sys::now() - start;
+
+    // Keep the optimizer from throwing away the loop
+    if (sum == 42)
+        Sys::println("");
+
+    return (data.len() * ROUNDS) / (elapsed.toUSecs() * 1000.0);
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    Vec<u8> data;
+    u32 seed = 0x12345678;
+    for (usize i = 0; i < SIZE; i++) {
+        seed = seed * 1103515245 + 12345;
+        data.pushBack(seed >> 24);
+    }
+
+    Sys::println("throughput over {} rounds of {} bytes", ROUNDS, SIZE);
+
+    auto crc32 = benchThroughput(data, [](Bytes b) {
+        return Crypto::crc32(b);
+    });
+    Sys::println("crc32: {.2}GB/s", crc32);
+
+    auto slicing8 = benchThroughput(data, [](Bytes b) {
+        return Crypto::crc32UpdateSlicing8(0xFFFFFFFF, b);
+    });
+    Sys::println("crc32 (slicing-by-8): {.2}GB/s", slicing8);
+
+    auto adler32 = benchThroughput(data, [](Bytes b) {
+        return Crypto::adler32(b);
+    });
+    Sys::println("adler32: {.2}GB/s", adler32);
+
+    co_return Ok();
+}
@@ -0,0 +1,165 @@
+#include <karm-base/endian.h>
+#include <karm-base/simd.h>
+
+#include "crc32.h"
+
+namespace Karm::Crypto {
+
+// MARK: Slicing-by-8 ----------------------------------------------------------
+
+// Bit-reflected crc32 polynomial, as used by zlib, gzip and png.
+static constexpr u32 CRC32_POLY = 0xEDB88320;
+
+// Table k gives the crc of a byte followed by k zero bytes, which lets
+// the kernel look up eight bytes at once instead of chaining them.
+static constexpr Array<Array<u32, 256>, 8> CRC32_TABLES = [] {
+    Array<Array<u32, 256>, 8> tables{};
+
+    for (u32 i = 0; i < 256; i++) {
+        u32 crc = i;
+        for (usize j = 0; j < 8; j++)
+            crc = (crc >> 1) ^ (CRC32_POLY & -(crc & 1));
+        tables[0][i] = crc;
+    }
+
+    for (usize k = 1; k < 8; k++) {
+        for (usize i = 0; i < 256; i++) {
+            u32 prev = tables[k - 1][i];
+            tables[k][i] = (prev >> 8) ^ tables[0][prev & 0xFF];
+        }
+    }
+
+    return tables;
+}();
+
+always_inline static u32 _load32le(u8 const* buf) {
+    u32le v;
+    memcpy(&v, buf, sizeof(v));
+    return v;
+}
+
+u32 crc32UpdateSlicing8(u32 crc, Bytes bytes) {
+    auto [buf, len] = bytes;
+    auto const& t = CRC32_TABLES;
+
+    for (; len >= 8; len -= 8, buf += 8) {
+        u32 lo = _load32le(buf) ^ crc;
+        u32 hi = _load32le(buf + 4);
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^
+              t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^
+              t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+
+    for (; len; len--, buf++)
+        crc = t[0][(crc ^ *buf) & 0xFF] ^ (crc >> 8);
+
+    return crc;
+}
+
+// MARK: Carry-less Multiplication ---------------------------------------------
+
+#ifdef __x86_64__
+
+// Folds 64 bytes at a time with PCLMULQDQ, then reduces the remainder with
+// a Barrett reduction, see "Fast CRC Computation for Generic Polynomials
+// Using PCLMULQDQ Instruction" (Intel, 2009). The constants are the ones
+// from the paper for the bit-reflected crc32 polynomial.
+
+#    define _CLMUL_TARGET [[gnu::target("pclmul,sse4.1")]]
+
+using _V2di = long long __attribute__((vector_size(16)));
+
+template <u8 IMM>
+_CLMUL_TARGET always_inline static u64x2 _clmul(u64x2 a, u64x2 b) {
+    return (u64x2)__builtin_ia32_pclmulqdq128((_V2di)a, (_V2di)b, IMM);
+}
+
+_CLMUL_TARGET always_inline static u64x2 _load128(u8 const* buf) {
+    u64x2 v;
+    memcpy(&v, buf, sizeof(v));
+    return v;
+}
+
+// Multiply both halves of `x` by the folding constants in `k` and add the next block.
+_CLMUL_TARGET always_inline static u64x2 _fold(u64x2 x, u64x2 k, u64x2 next) {
+    return _clmul<0x00>(x, k) ^ _clmul<0x11>(x, k) ^ next;
+}
+
+_CLMUL_TARGET static u32 _crc32UpdateClmul(u32 crc, Bytes bytes) {
+    auto [buf, len] = bytes;
+    if (len < 64)
+        return crc32UpdateSlicing8(crc, bytes);
+
+    u64x2 const k1k2 = {0x0154442bd4, 0x01c6e41596};
+    u64x2 const k3k4 = {0x01751997d0, 0x00ccaa009e};
+    u64x2 const k5k0 = {0x0163cd6124, 0x0000000000};
+    u64x2 const poly = {0x01db710641, 0x01f7011641};
+    u64x2 const mask = (u64x2)(u32x4){~0u, 0, ~0u, 0};
+
+    u64x2 x1 = _load128(buf) ^ (u64x2){crc, 0};
+    u64x2 x2 = _load128(buf + 16);
+    u64x2 x3 = _load128(buf + 32);
+    u64x2 x4 = _load128(buf + 48);
+    buf += 64;
+    len -= 64;
+
+    for (; len >= 64; len -= 64, buf += 64) {
+        x1 = _fold(x1, k1k2, _load128(buf));
+        x2 = _fold(x2, k1k2, _load128(buf + 16));
+        x3 = _fold(x3, k1k2, _load128(buf + 32));
+        x4 = _fold(x4, k1k2, _load128(buf + 48));
+    }
+
+    x1 = _fold(x1, k3k4, x2);
+    x1 = _fold(x1, k3k4, x3);
+    x1 = _fold(x1, k3k4, x4);
+
+    for (; len >= 16; len -= 16, buf += 16)
+        x1 = _fold(x1, k3k4, _load128(buf));
+
+    // Fold 128 bits down to 64
+    x1 = (u64x2){x1[1], 0} ^ _clmul<0x10>(x1, k3k4);
+    auto x = (u32x4)x1;
+    x1 = _clmul<0x00>(x1 & mask, k5k0) ^ (u64x2)(u32x4){x[1], x[2], x[3], 0};
+
+    // Barrett reduction down to 32 bits
+    x2 = _clmul<0x10>(x1 & mask, poly) & mask;
+    x1 ^= _clmul<0x00>(x2, poly);
+
+    return crc32UpdateSlicing8(((u32x4)x1)[1], {buf, len});
+}
+
+static bool _hasClmul() {
+    u32 eax, ebx, ecx, edx;
+    asm volatile("cpuid"
+                 : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
+                 : "a"(1), "c"(0));
+
+    // CPUID.01H:ECX, PCLMULQDQ is bit 1 and SSE4.1 bit 19
+    return (ecx & (1 << 1)) and (ecx & (1 << 19));
+}
+
+#endif
+
+// MARK: Dispatch --------------------------------------------------------------
+
+using _Crc32Kernel = u32 (*)(u32, Bytes);
+
+static _Crc32Kernel _pickKernel() {
+#ifdef __x86_64__
+    if (_hasClmul())
+        return _crc32UpdateClmul;
+#endif
+    return crc32UpdateSlicing8;
+}
+
+u32 crc32Update(u32 crc, Bytes bytes) {
+    // NOTE: Threads racing here all pick the same kernel, no need for a lock.
+    static _Crc32Kernel kernel = nullptr;
+    if (not kernel) [[unlikely]]
+        kernel = _pickKernel();
+    return kernel(crc, bytes);
+}
+
+} // namespace Karm::Crypto
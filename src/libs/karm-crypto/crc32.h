@@ -1,18 +1,17 @@
 #pragma once
 
-// https://github.com/Michaelangel007/crc32
-
 #include <karm-base/array.h>
 #include <karm-base/slice.h>
 
 namespace Karm::Crypto {
 
-static Array<u32, 16> const CRC32_TAB = {
-    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190,
-    0x6B6B51F4, 0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344,
-    0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278,
-    0xBDBDF21C
-};
+// Advance the crc state over `bytes`, the state is kept inverted like
+// in Crc32 so it can be carried over from one chunk to the next.
+// Uses carry-less multiplications when the cpu has them.
+u32 crc32Update(u32 crc, Bytes bytes);
+
+// Table driven kernel that works everywhere, crc32Update() falls back on it.
+u32 crc32UpdateSlicing8(u32 crc, Bytes bytes);
 
 struct Crc32 {
     using Digest = u32;
@@ -24,16 +23,11 @@ struct Crc32 {
     always_inline Crc32(u32 crc) : _crc(crc) {}
 
     always_inline void update(u8 byte) {
-        _crc ^= byte;
-        _crc = CRC32_TAB[_crc & 0x0F] ^ (_crc >> 4);
-        _crc = CRC32_TAB[_crc & 0x0F] ^ (_crc >> 4);
+        update(Bytes{&byte, 1});
     }
 
     always_inline void update(Bytes bytes) {
-        auto [buf, len] = bytes;
-
-        for (usize i = 0; i < len; ++i)
-            update(buf[i]);
+        _crc = crc32Update(_crc, bytes);
     }
 
     always_inline Digest digest() {
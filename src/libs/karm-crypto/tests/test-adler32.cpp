@@ -19,4 +19,42 @@ test$("crypto-adler32") {
     return Ok();
 }
 
+// Byte at a time reference, slow but obviously correct.
+static u32 adler32Bytewise(Bytes bytes, u32 adler = 1) {
+    u32 s1 = adler & 0xFFFF;
+    u32 s2 = adler >> 16;
+    for (auto b : bytes) {
+        s1 = (s1 + b) % 65521;
+        s2 = (s2 + s1) % 65521;
+    }
+    return (s2 << 16) | s1;
+}
+
+test$("crypto-adler32-blocks") {
+    Vec<u8> data;
+    u32 seed = 0x12345678;
+    for (usize i = 0; i < 20000; i++) {
+        seed = seed * 1103515245 + 12345;
+        data.pushBack(seed >> 24);
+    }
+
+    for (usize off = 0; off < 16; off += 5) {
+        for (usize len = 0; len < 200; len++) {
+            auto bytes = sub(data, off, off + len);
+            expectEq$(adler32(bytes), adler32Bytewise(bytes));
+        }
+    }
+
+    // Long inputs span several chunks, all 0xff is the worst case for overflows.
+    expectEq$(adler32(data), adler32Bytewise(data));
+
+    Vec<u8> ones;
+    for (usize i = 0; i < 20000; i++)
+        ones.pushBack(0xFF);
+    expectEq$(adler32(ones), adler32Bytewise(ones));
+    expectEq$(adler32(ones, 0xFFF0FFF0), adler32Bytewise(ones, 0xFFF0FFF0));
+
+    return Ok();
+}
+
 } // namespace Karm::Crypto::Tests
@@ -17,4 +17,45 @@ test$("crypto-crc32") {
     return Ok();
 }
 
+// Bit at a time reference, slow but obviously correct.
+static u32 crc32Bitwise(u32 crc, Bytes bytes) {
+    for (auto b : bytes) {
+        crc ^= b;
+        for (usize i = 0; i < 8; i++)
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return crc;
+}
+
+test$("crypto-crc32-kernels") {
+    Vec<u8> data;
+    u32 seed = 0x12345678;
+    for (usize i = 0; i < 4096 + 64; i++) {
+        seed = seed * 1103515245 + 12345;
+        data.pushBack(seed >> 24);
+    }
+
+    // Cover every tail length around the folding thresholds and unaligned starts.
+    for (usize off = 0; off < 16; off += 3) {
+        for (usize len = 0; len < 300; len++) {
+            auto bytes = sub(data, off, off + len);
+            u32 expected = crc32Bitwise(0xFFFFFFFF, bytes);
+            expectEq$(crc32UpdateSlicing8(0xFFFFFFFF, bytes), expected);
+            expectEq$(crc32Update(0xFFFFFFFF, bytes), expected);
+        }
+    }
+
+    auto bytes = sub(data, 7, data.len());
+    u32 expected = crc32Bitwise(0xFFFFFFFF, bytes);
+    expectEq$(crc32Update(0xFFFFFFFF, bytes), expected);
+
+    // Chaining updates must give the same result as a single one.
+    Crc32 crc;
+    for (usize i = 0; i < bytes.len(); i += 301)
+        crc.update(sub(bytes, i, i + 301));
+    expectEq$(crc.digest(), expected ^ 0xFFFFFFFF);
+
+    return Ok();
+}
+
 } // namespace Karm::Crypto::Tests
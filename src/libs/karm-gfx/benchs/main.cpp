@@ -1,45 +1,23 @@
 #include <karm-cli/cursor.h>
 #include <karm-gfx/cpu/canvas.h>
+#include <karm-gfx/filters.h>
 #include <karm-sys/entry.h>
 #include <karm-sys/time.h>
+#include <karm-text/loader.h>
+#include <karm-text/prose.h>
 
-Async::Task<> entryPointAsync(Sys::Context&) {
+static constexpr isize SAMPLES = 100;
+
+void bench(Str name, auto fn) {
     Vec<Duration> samples;
-    auto surface = Gfx::Surface::alloc({1000, 1000});
 
-    for (isize i = 0; i < 100; i++) {
+    for (isize i = 0; i < SAMPLES; i++) {
         auto start = Sys::now();
-        for (isize size = 100; size < 1000; size += 10) {
-            f64 scale = size / 100.0;
-
-            Gfx::CpuCanvas g;
-            g.begin(surface->mutPixels());
-            g.scale(scale);
-
-            for (isize i = 0; i < 50; i++) {
-                Math::Rand rand{};
-
-                f64 s = rand.nextInt(4, 10);
-                s *= s;
-
-                g.beginPath();
-                g.ellipse({
-                    rand.nextVec2(Math::Recti{100, 100}).cast<f64>(),
-                    s,
-                });
-
-                g.strokeStyle(
-                    Gfx::stroke(Gfx::randomColor(rand))
-                        .withWidth(rand.nextInt(2, s))
-                );
-                g.stroke();
-            }
-        }
-
+        fn();
         auto elapsed = Sys::now() - start;
         samples.pushBack(elapsed);
 
-        Sys::print("sampling {}/100: {}\r", i + 1, elapsed);
+        Sys::print("{}: sampling {}/{}: {}\r", name, i + 1, SAMPLES, elapsed);
     }
 
     // median
@@ -53,10 +31,160 @@ Async::Task<> entryPointAsync(Sys::Context&) {
         sum += s.toUSecs();
 
     Sys::println("\n");
+    Sys::println("{}", name);
     Sys::println("median: {}", samples[samples.len() / 2]);
     Sys::println("average: {}", Duration::fromUSecs(sum / samples.len()));
     Sys::println("min: {}", first(samples));
     Sys::println("max: {}", last(samples));
+    Sys::println("");
+}
+
+void benchStrokes(Gfx::Surface& surface) {
+    for (isize size = 100; size < 1000; size += 10) {
+        f64 scale = size / 100.0;
+
+        Gfx::CpuCanvas g;
+        g.begin(surface.mutPixels());
+        g.scale(scale);
+
+        for (isize i = 0; i < 50; i++) {
+            Math::Rand rand{};
+
+            f64 s = rand.nextInt(4, 10);
+            s *= s;
+
+            g.beginPath();
+            g.ellipse({
+                rand.nextVec2(Math::Recti{100, 100}).cast<f64>(),
+                s,
+            });
+
+            g.strokeStyle(
+                Gfx::stroke(Gfx::randomColor(rand))
+                    .withWidth(rand.nextInt(2, s))
+            );
+            g.stroke();
+        }
+        g.end();
+    }
+}
+
+void benchFills(Gfx::Surface& surface, Gfx::FillRule rule) {
+    Gfx::CpuCanvas g;
+    g.begin(surface.mutPixels());
+    Math::Rand rand{};
+
+    for (isize i = 0; i < 200; i++) {
+        g.beginPath();
+        g.moveTo(rand.nextVec2(Math::Recti{1000, 1000}).cast<f64>());
+        for (isize j = 0; j < 16; j++)
+            g.lineTo(rand.nextVec2(Math::Recti{1000, 1000}).cast<f64>());
+        g.closePath();
+        g.fillStyle(Gfx::randomColor(rand).withOpacity(0.5));
+        g.fill(rule);
+    }
+    g.end();
+}
+
+void benchSpans(Gfx::Surface& surface, auto kernel) {
+    auto pixels = surface.mutPixels();
+    for (isize y = 0; y < pixels.height(); y++)
+        kernel(static_cast<u8*>(pixels.pixelUnsafe({0, y})), (usize)pixels.width());
+}
+
+void benchProse(Gfx::Surface& surface, Text::Prose& prose) {
+    Gfx::CpuCanvas g;
+    g.begin(surface.mutPixels());
+    g.clear(Gfx::WHITE);
+    for (isize y = 0; y < 1000; y += 200) {
+        g.push();
+        g.origin({0, (f64)y});
+        g.fill(prose);
+        g.pop();
+    }
+    g.end();
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    auto surface = Gfx::Surface::alloc({1000, 1000});
+
+    bench("strokes", [&] {
+        benchStrokes(*surface);
+    });
+
+    bench("fills-nonzero", [&] {
+        benchFills(*surface, Gfx::FillRule::NONZERO);
+    });
+
+    bench("fills-evenodd", [&] {
+        benchFills(*surface, Gfx::FillRule::EVENODD);
+    });
+
+    Array<u8, 1000> coverage;
+    for (usize i = 0; i < coverage.len(); i++)
+        coverage[i] = (i * 7) % 256;
+
+    auto color = Gfx::BLUE.withOpacity(0.5);
+
+    // NOTE: The vector kernels only kick in over opaque destinations
+    surface->mutPixels().clear(Gfx::WHITE);
+
+    bench("spans-blend-scalar", [&] {
+        benchSpans(*surface, [&](u8* row, usize len) {
+            Gfx::blendSpanScalar(Gfx::RGBA8888, row, len, color, coverage.buf());
+        });
+    });
+
+    bench("spans-blend-simd", [&] {
+        benchSpans(*surface, [&](u8* row, usize len) {
+            Gfx::blendSpan(Gfx::RGBA8888, row, len, color, coverage.buf());
+        });
+    });
+
+    auto src = Gfx::Surface::alloc({1000, 1000}, Gfx::BGRA8888);
+    src->mutPixels().clear(color);
+
+    bench("spans-blit-scalar", [&] {
+        benchSpans(*surface, [&](u8* row, usize len) {
+            Gfx::blitSpanScalar(Gfx::BGRA8888, static_cast<u8 const*>(src->pixels().scanline(0)), Gfx::RGBA8888, row, len);
+        });
+    });
+
+    bench("spans-blit-simd", [&] {
+        benchSpans(*surface, [&](u8* row, usize len) {
+            Gfx::blitSpan(Gfx::BGRA8888, static_cast<u8 const*>(src->pixels().scanline(0)), Gfx::RGBA8888, row, len);
+        });
+    });
+
+    Math::Rand rand{};
+    for (isize y = 0; y < 1000; y++)
+        for (isize x = 0; x < 1000; x++)
+            surface->mutPixels().store({x, y}, Gfx::randomColor(rand));
+
+    for (usize radius : {2, 4, 8, 16, 32, 64}) {
+        bench(Io::format("blur-{}", radius), [&] {
+            Gfx::BlurFilter{(f64)radius}.apply(surface->mutPixels());
+        });
+    }
+
+    Text::Prose prose = Text::ProseStyle{
+        .font = {
+            co_try$(Text::loadFontfaceOrFallback("bundle://fonts-inter/fonts/Inter-Regular.ttf"_url)),
+            14,
+        },
+        .color = Gfx::BLACK,
+    };
+
+    for (isize i = 0; i < 8; i++)
+        prose.append("The quick brown fox jumps over the lazy dog, pack my box with five dozen liquor jugs. "s);
+    prose.layout(Au{1000});
+
+    bench("prose", [&] {
+        benchProse(*surface, prose);
+    });
+
+    auto& glyphs = Gfx::GlyphCache::global();
+    Sys::println("glyph cache: {} glyphs, {} bytes, {.1}% hits", glyphs.len(), glyphs.bytes(), glyphs.hitRate() * 100);
 
     co_return Ok();
 }
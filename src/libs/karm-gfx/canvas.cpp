@@ -37,6 +37,10 @@ void Canvas::skew(Math::Vec2f pos) {
     transform(Math::Trans2f::makeSkew(pos));
 }
 
+Opt<Math::Trans2f> Canvas::currentTransform() const {
+    return NONE;
+}
+
 // MARK: Path Operations ---------------------------------------------------
 
 void Canvas::fill(Fill style, FillRule rule) {
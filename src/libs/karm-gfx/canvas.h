@@ -54,6 +54,10 @@ struct Canvas : Meta::NoCopy {
     // Skew subsequent drawing operations.
     virtual void skew(Math::Vec2f pos);
 
+    // Get the transform applied to subsequent drawing operations,
+    // NONE if the backend doesn't keep track of it.
+    virtual Opt<Math::Trans2f> currentTransform() const;
+
     // MARK: Path Operations ---------------------------------------------------
 
     // Begin a new path.
@@ -1,6 +1,7 @@
 #include <karm-base/ring.h>
 #include <karm-logger/logger.h>
 #include <karm-math/funcs.h>
+#include <karm-text/font.h>
 
 #include "canvas.h"
 
@@ -69,11 +70,46 @@ void CpuCanvas::transform(Math::Trans2f trans) {
     t = trans.multiply(t);
 }
 
+Opt<Math::Trans2f> CpuCanvas::currentTransform() const {
+    return current().trans;
+}
+
+void CpuCanvas::lcdLayout(Opt<LcdLayout> layout) {
+    _lcdLayout = layout;
+}
+
 // MARK: Path Operations -------------------------------------------------------
 
 void CpuCanvas::_fillImpl(auto fill, auto format, FillRule fillRule) {
+    auto pixels = mutPixels();
+
+    if constexpr (Meta::Same<decltype(fill), Color>) {
+        // Solid fills gather the coverage of contiguous fragments
+        // and blend them a whole span at a time.
+        Math::Vec2i start = {};
+        _coverage.clear();
+
+        auto flush = [&] {
+            if (not _coverage.len())
+                return;
+            u8* dst = static_cast<u8*>(pixels.pixelUnsafe(start));
+            blendSpan(format, dst, _coverage.len(), fill, _coverage.buf());
+            _coverage.clear();
+        };
+
+        _rast.fill(_poly, current().clip, fillRule, [&](CpuRast::Frag frag) {
+            if (frag.xy.y != start.y or frag.xy.x != start.x + (isize)_coverage.len()) {
+                flush();
+                start = frag.xy;
+            }
+            _coverage.pushBack(static_cast<u8>(frag.a * 255));
+        });
+
+        flush();
+        return;
+    }
+
     _rast.fill(_poly, current().clip, fillRule, [&](CpuRast::Frag frag) {
-        auto pixels = mutPixels();
         auto* pixel = pixels.pixelUnsafe(frag.xy);
         auto color = fill.sample(frag.uv);
         auto c = format.load(pixel);
@@ -97,9 +133,9 @@ void CpuCanvas::_FillSmoothImpl(auto fill, auto format, FillRule fillRule) {
         });
     };
 
-    fillComponent(Color::RED_COMPONENT, _lcdLayout.red);
-    fillComponent(Color::GREEN_COMPONENT, _lcdLayout.green);
-    fillComponent(Color::BLUE_COMPONENT, _lcdLayout.blue);
+    fillComponent(Color::RED_COMPONENT, _lcdLayout->red);
+    fillComponent(Color::GREEN_COMPONENT, _lcdLayout->green);
+    fillComponent(Color::BLUE_COMPONENT, _lcdLayout->blue);
 }
 
 void CpuCanvas::_fill(Fill fill, FillRule fillRule) {
@@ -199,20 +235,13 @@ void CpuCanvas::clip(FillRule) {
 
     r = current().clip.clipTo(r);
 
-    if (color.alpha == 255) {
-        mutPixels()
-            .clip(r)
-            .clear(color);
-    } else {
-        pixels().fmt().visit([&](auto f) {
-            for (isize y = r.y; y < r.y + r.height; ++y) {
-                for (isize x = r.x; x < r.x + r.width; ++x) {
-                    auto blended = color.blendOver(f.load(mutPixels().pixelUnsafe({x, y})));
-                    f.store(mutPixels().pixelUnsafe({x, y}), blended);
-                }
-            }
-        });
-    }
+    auto pixels = mutPixels();
+    pixels.fmt().visit([&](auto f) {
+        for (isize y = r.y; y < r.y + r.height; ++y) {
+            u8* row = static_cast<u8*>(pixels.pixelUnsafe({r.x, y}));
+            blendSpan(f, row, r.width, color);
+        }
+    });
 }
 
 void CpuCanvas::fill(Math::Recti r, Math::Radiif radii) {
@@ -252,10 +281,151 @@ void CpuCanvas::fill(Math::Path const& path, FillRule rule) {
     _fill(current().fill, rule);
 }
 
+Opt<u8> CpuCanvas::_lcdLayoutId() const {
+    if (not _lcdLayout)
+        return 0;
+
+    auto same = [&](LcdLayout const& l) {
+        return _lcdLayout->red == l.red and
+               _lcdLayout->green == l.green and
+               _lcdLayout->blue == l.blue;
+    };
+
+    if (same(RGB))
+        return 1;
+    if (same(BGR))
+        return 2;
+    if (same(VRGB))
+        return 3;
+    return NONE;
+}
+
+GlyphMask CpuCanvas::_rasterizeGlyph(Text::Fontface const& face, GlyphKey const& key) {
+    push();
+    current().trans = Math::Trans2f::makeTranslate({
+        key.subX / (f64)GlyphKey::SUBPIXEL,
+        key.subY / (f64)GlyphKey::SUBPIXEL,
+    });
+    scale(key.size / (f64)GlyphKey::SIZE_UNIT);
+    beginPath();
+    face.contour(*this, key.glyph);
+    _poly.clear();
+    createSolid(_poly, _path);
+    _poly.transform(current().trans);
+    pop();
+
+    u8 channels = key.layout ? 3 : 1;
+    if (isEmpty(_poly._edges))
+        return {{}, channels, {}};
+
+    // NOTE: Grow by a pixel to make room for the subpixel offsets.
+    auto b = _poly.bound();
+    Math::Recti bound = Math::Recti::fromTwoPoint(
+        {Math::floori(b.start()) - 1, Math::floori(b.top()) - 1},
+        {Math::ceili(b.end()) + 1, Math::ceili(b.bottom()) + 1}
+    );
+    _poly.offset(-bound.xy.cast<f64>());
+
+    GlyphMask mask{bound, channels, {}};
+    mask.coverage.resize(bound.width * bound.height * channels);
+    Math::Recti clip = {bound.width, bound.height};
+
+    auto rasterizeChannel = [&](usize channel) {
+        _rast.fill(_poly, clip, FillRule::NONZERO, [&](CpuRast::Frag frag) {
+            usize i = (frag.xy.y * bound.width + frag.xy.x) * channels + channel;
+            mask.coverage[i] = static_cast<u8>(frag.a * 255);
+        });
+    };
+
+    if (channels == 1) {
+        rasterizeChannel(0);
+        return mask;
+    }
+
+    Math::Vec2f last = {0, 0};
+    Array<Math::Vec2f, 3> offsets = {_lcdLayout->red, _lcdLayout->green, _lcdLayout->blue};
+    for (usize i = 0; i < 3; i++) {
+        _poly.offset(offsets[i] - last);
+        last = offsets[i];
+        rasterizeChannel(i);
+    }
+
+    return mask;
+}
+
+[[gnu::flatten]] void CpuCanvas::_fillMask(GlyphMask const& mask, Math::Vec2i origin, Color color) {
+    auto dest = mask.bound.offset(origin);
+    auto clipDest = current().clip.clipTo(dest);
+    if (clipDest.width <= 0 or clipDest.height <= 0)
+        return;
+
+    auto pixels = mutPixels();
+    pixels.fmt().visit([&](auto format) {
+        if (mask.channels == 1) {
+            for (isize y = clipDest.top(); y < clipDest.bottom(); y++) {
+                usize i = (y - dest.y) * dest.width + (clipDest.x - dest.x);
+                u8* row = static_cast<u8*>(pixels.pixelUnsafe({clipDest.x, y}));
+                blendSpan(format, row, clipDest.width, color, &mask.coverage[i]);
+            }
+            return;
+        }
+
+        for (isize y = clipDest.top(); y < clipDest.bottom(); y++) {
+            for (isize x = clipDest.start(); x < clipDest.end(); x++) {
+                usize i = ((y - dest.y) * dest.width + (x - dest.x)) * mask.channels;
+                u8 const* cov = &mask.coverage[i];
+                auto* pixel = pixels.pixelUnsafe({x, y});
+
+                if ((cov[0] | cov[1] | cov[2]) == 0)
+                    continue;
+
+                auto c = format.load(pixel);
+                c = color.withOpacity(cov[0] / 255.0).blendOverComponent(c, Color::RED_COMPONENT);
+                c = color.withOpacity(cov[1] / 255.0).blendOverComponent(c, Color::GREEN_COMPONENT);
+                c = color.withOpacity(cov[2] / 255.0).blendOverComponent(c, Color::BLUE_COMPONENT);
+                format.store(pixel, c);
+            }
+        }
+    });
+}
+
 void CpuCanvas::fill(Text::Font& font, Text::Glyph glyph, Math::Vec2f baseline) {
-    _useSpaa = true;
-    Canvas::fill(font, glyph, baseline);
-    _useSpaa = false;
+    auto const& trans = current().trans;
+    auto layout = _lcdLayoutId();
+
+    // Only axis-aligned, uniformly scaled solid text can be served from the
+    // glyph cache, everything else goes through the path rasterizer.
+    bool cacheable =
+        current().fill.is<Color>() and
+        layout and
+        trans.xy == 0 and trans.yx == 0 and
+        trans.xx == trans.yy and trans.xx > 0;
+
+    if (not cacheable) {
+        _useSpaa = (bool)_lcdLayout;
+        Canvas::fill(font, glyph, baseline);
+        _useSpaa = false;
+        return;
+    }
+
+    auto pos = trans.apply(baseline);
+    Math::Vec2i origin = {Math::floori(pos.x), Math::floori(pos.y)};
+    auto frac = pos - origin.cast<f64>();
+
+    GlyphKey key = {
+        .face = &*font.fontface,
+        .glyph = glyph,
+        .size = static_cast<u32>(Math::round(font.fontsize * trans.xx * GlyphKey::SIZE_UNIT)),
+        .subX = static_cast<u8>(min(Math::floori(frac.x * GlyphKey::SUBPIXEL), GlyphKey::SUBPIXEL - 1)),
+        .subY = static_cast<u8>(min(Math::floori(frac.y * GlyphKey::SUBPIXEL), GlyphKey::SUBPIXEL - 1)),
+        .layout = *layout,
+    };
+
+    auto mask = GlyphCache::global().access(key, font.fontface, [&] {
+        return _rasterizeGlyph(*font.fontface, key);
+    });
+
+    _fillMask(*mask, origin, current().fill.unwrap<Color>());
 }
 
 // MARK: Clear Operations ------------------------------------------------------
@@ -269,9 +439,14 @@ void CpuCanvas::clear(Math::Recti rect, Color color) {
     rect = current().trans.apply(rect.cast<f64>()).bound().cast<isize>();
 
     rect = current().clip.clipTo(rect);
-    mutPixels()
-        .clip(rect)
-        .clear(color);
+
+    auto pixels = mutPixels();
+    pixels.fmt().visit([&](auto f) {
+        for (isize y = rect.y; y < rect.y + rect.height; ++y) {
+            u8* row = static_cast<u8*>(pixels.pixelUnsafe({rect.x, y}));
+            fillSpan(f, row, rect.width, color);
+        }
+    });
 }
 
 // MARK: Plot Operations ---------------------------------------------------
@@ -327,6 +502,17 @@ void CpuCanvas::plot(Math::Recti rect, Color color) {
 
     auto clipDest = current().clip.clipTo(destRect);
 
+    if (srcRect.size() == destRect.size()) {
+        // Unscaled blits go through the span kernels a row at a time
+        for (isize y = 0; y < clipDest.height; ++y) {
+            Math::Vec2i srcXY = srcRect.xy + clipDest.xy - destRect.xy + Math::Vec2i{0, y};
+            u8 const* srcRow = static_cast<u8 const*>(src.pixelUnsafe(srcXY));
+            u8* destRow = static_cast<u8*>(dest.pixelUnsafe({clipDest.x, clipDest.y + y}));
+            blitSpan(srcFmt, srcRow, destFmt, destRow, clipDest.width);
+        }
+        return;
+    }
+
     auto hratio = srcRect.height / (f64)destRect.height;
     auto wratio = srcRect.width / (f64)destRect.width;
 
@@ -5,7 +5,9 @@
 #include "../fill.h"
 #include "../filters.h"
 #include "../stroke.h"
+#include "glyphs.h"
 #include "rast.h"
+#include "spans.h"
 
 namespace Karm::Gfx {
 
@@ -32,7 +34,8 @@ struct CpuCanvas : public Canvas {
     Math::Path _path{};
     Math::Polyf _poly;
     CpuRast _rast{};
-    LcdLayout _lcdLayout = RGB;
+    Vec<u8> _coverage{};
+    Opt<LcdLayout> _lcdLayout = RGB;
     bool _useSpaa = false;
 
     // MARK: Buffers -----------------------------------------------------------
@@ -67,6 +70,12 @@ struct CpuCanvas : public Canvas {
 
     void transform(Math::Trans2f trans) override;
 
+    Opt<Math::Trans2f> currentTransform() const override;
+
+    // Set the subpixel layout used to antialias text, NONE for grayscale.
+    // NOTE: Subpixel text only looks right blended onto an opaque surface.
+    void lcdLayout(Opt<LcdLayout> layout);
+
     // MARK: Path Operations ---------------------------------------------------
 
     // (internal) Fill the current shape with the given fill.
@@ -123,6 +132,16 @@ struct CpuCanvas : public Canvas {
 
     void fill(Math::Path const& path, FillRule rule = FillRule::NONZERO) override;
 
+    // (internal) Id of the current subpixel layout for the glyph cache, 0 for
+    // grayscale and NONE for a layout the cache doesn't know about.
+    Opt<u8> _lcdLayoutId() const;
+
+    // (internal) Rasterize a glyph into a coverage mask for the glyph cache.
+    GlyphMask _rasterizeGlyph(Text::Fontface const& face, GlyphKey const& key);
+
+    // (internal) Blend a solid color through a glyph coverage mask.
+    void _fillMask(GlyphMask const& mask, Math::Vec2i origin, Color color);
+
     void fill(Text::Font& font, Text::Glyph glyph, Math::Vec2f baseline) override;
 
     // MARK: Clear Operations --------------------------------------------------
@@ -0,0 +1,44 @@
+#include <karm-text/font.h>
+
+#include "glyphs.h"
+
+namespace Karm::Gfx {
+
+GlyphCache& GlyphCache::global() {
+    static GlyphCache cache{};
+    return cache;
+}
+
+GlyphCache::~GlyphCache() {
+    clear();
+}
+
+void GlyphCache::_insert(GlyphKey const& key, Rc<Text::Fontface> face, Arc<GlyphMask> mask) {
+    _bytes += mask->byteLen();
+    auto* item = new Item{key, std::move(face), std::move(mask)};
+    _ll.prepend(item, _ll.head());
+    _map.put(key, item);
+    _evict();
+}
+
+void GlyphCache::_evict() {
+    // NOTE: Always keep the most recent glyph, even if it's bigger than the budget.
+    while (_bytes > _budget and _ll.len() > 1) {
+        auto* item = _ll.tail();
+        _ll.detach(item);
+        _map.del(item->key);
+        _bytes -= item->mask->byteLen();
+        delete item;
+    }
+}
+
+void GlyphCache::clear() {
+    LockScope scope{_lock};
+    _map.clear();
+    _ll.clearApply([](Item* item) {
+        delete item;
+    });
+    _bytes = 0;
+}
+
+} // namespace Karm::Gfx
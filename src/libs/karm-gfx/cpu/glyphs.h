@@ -0,0 +1,140 @@
+#pragma once
+
+#include <karm-base/hashmap.h>
+#include <karm-base/list.h>
+#include <karm-base/lock.h>
+#include <karm-base/rc.h>
+#include <karm-math/rect.h>
+#include <karm-text/base.h>
+
+namespace Karm::Text {
+
+struct Fontface;
+
+} // namespace Karm::Text
+
+namespace Karm::Gfx {
+
+// Identifies a rasterized glyph, everything that can change
+// the coverage of the mask must be part of the key.
+struct GlyphKey {
+    // Subpixel positions are snapped to 1/SUBPIXEL of a pixel.
+    static constexpr u8 SUBPIXEL = 4;
+
+    // Sizes are snapped to 1/SIZE_UNIT of a pixel.
+    static constexpr u32 SIZE_UNIT = 64;
+
+    Text::Fontface const* face;
+    Text::Glyph glyph;
+    u32 size;
+    u8 subX;
+    u8 subY;
+
+    // 0 for grayscale, otherwise the id of the subpixel layout.
+    u8 layout;
+
+    bool operator==(GlyphKey const& other) const = default;
+};
+
+} // namespace Karm::Gfx
+
+template <>
+struct Karm::Hasher<Karm::Gfx::GlyphKey> {
+    static Karm::Hash hash(Karm::Gfx::GlyphKey const& key) {
+        Karm::Hash h = Karm::hash(key.face);
+        h = Karm::hashCombine(h, Karm::hash(key.glyph));
+        h = Karm::hashCombine(h, Karm::hash(key.size));
+        return Karm::hashCombine(h, Karm::hash<u32>(key.subX | (key.subY << 8) | (key.layout << 16)));
+    }
+};
+
+namespace Karm::Gfx {
+
+// Alpha coverage of a glyph, one channel for grayscale
+// and three (red, green, blue) for subpixel antialiasing.
+struct GlyphMask {
+    // Bound of the mask relative to the integer baseline origin.
+    Math::Recti bound;
+    u8 channels;
+    Vec<u8> coverage;
+
+    usize byteLen() const {
+        return coverage.len() + sizeof(GlyphMask);
+    }
+};
+
+// Cache of rasterized glyphs shared by all the cpu canvases,
+// least recently used masks are evicted once the budget is exceeded.
+struct GlyphCache {
+    static constexpr usize DEFAULT_BUDGET = 4 * 1024 * 1024;
+
+    struct Item {
+        GlyphKey key;
+        // Keeps the fontface alive so its address can't be reused by another face.
+        Rc<Text::Fontface> face;
+        Arc<GlyphMask> mask;
+        LlItem<Item> item{};
+    };
+
+    usize _budget;
+    usize _bytes = 0;
+    usize _hits = 0;
+    usize _misses = 0;
+    HashMap<GlyphKey, Item*> _map;
+    Ll<Item> _ll;
+    Lock _lock;
+
+    static GlyphCache& global();
+
+    GlyphCache(usize budget = DEFAULT_BUDGET)
+        : _budget(budget) {}
+
+    ~GlyphCache();
+
+    // NOTE: The fontface is only copied under the lock, its reference
+    //       count isn't atomic and canvases might run on several threads.
+    Arc<GlyphMask> access(GlyphKey const& key, Rc<Text::Fontface> const& face, auto const& make) {
+        {
+            LockScope scope{_lock};
+            if (auto item = _map.tryGet(key)) {
+                _ll.detach(*item);
+                _ll.prepend(*item, _ll.head());
+                _hits++;
+                return (*item)->mask;
+            }
+        }
+
+        // NOTE: Rasterize outside of the lock, two threads racing for
+        //       the same glyph will do the work twice but won't block
+        //       each other.
+        auto mask = makeArc<GlyphMask>(make());
+
+        LockScope scope{_lock};
+        _misses++;
+        if (_map.has(key))
+            return mask;
+        _insert(key, face, mask);
+        return mask;
+    }
+
+    void _insert(GlyphKey const& key, Rc<Text::Fontface> face, Arc<GlyphMask> mask);
+
+    void _evict();
+
+    void clear();
+
+    usize len() const {
+        return _map.len();
+    }
+
+    usize bytes() const {
+        return _bytes;
+    }
+
+    f64 hitRate() const {
+        usize total = _hits + _misses;
+        return total ? _hits / (f64)total : 0;
+    }
+};
+
+} // namespace Karm::Gfx
@@ -1,18 +1,41 @@
 #pragma once
 
 #include <karm-base/range.h>
+#include <karm-math/funcs.h>
 #include <karm-math/poly.h>
 
 #include "../types.h"
 
 namespace Karm::Gfx {
 
+// Scanline rasterizer with an active edge table.
+//
+// Edges are sorted by their top once per fill, each scanline only visits the
+// edges crossing it. Non-zero fills accumulate the signed area covered by
+// each edge in the cells it crosses (the font-rs/stb_truetype approach), the
+// coverage of a pixel is then the running sum of the cells on its left.
+// Even-odd fills need the crossing order, they are sampled on AA sub-rows.
 struct CpuRast {
     static constexpr auto AA = 3;
     static constexpr auto UNIT = 1.0f / AA;
     static constexpr auto HALF_UNIT = 1.0f / AA / 2.0;
 
-    struct Active {
+    // Coverage under half a level of an 8-bit channel is invisible.
+    static constexpr f64 EPSILON = 1.0 / 512;
+
+    struct Edge {
+        f64 sx, sy;
+        f64 ex, ey;
+        // +1 when the edge goes down, -1 when it goes up.
+        f64 dir;
+        f64 dxdy;
+
+        f64 xAt(f64 y) const {
+            return sx + (y - sy) * dxdy;
+        }
+    };
+
+    struct Crossing {
         f64 x;
         isize sign;
     };
@@ -23,125 +46,277 @@ struct CpuRast {
         f64 a;
     };
 
-    Vec<Active> _active{};
-    Vec<irange> _ranges;
+    Vec<Edge> _edges{};
+    Vec<usize> _active{};
+    Vec<Crossing> _crossings{};
     Vec<f64> _scanline{};
 
-    void _appendRange(irange range) {
-        usize i = 0;
-        for (auto& r : _ranges) {
-            if (r.overlaps(range)) {
-                auto merged = r.merge(range);
-                _ranges.removeAt(i);
-                _appendRange(merged);
-                return;
-            }
+    // Range of cells touched on the current scanline, relative to the clip.
+    isize _dirtyStart = 0;
+    isize _dirtyEnd = 0;
+
+    // MARK: Edge Table --------------------------------------------------------
+
+    void _buildEdges(Math::Polyf& poly) {
+        _edges.clear();
+        for (auto& e : poly) {
+            if (e.sy == e.ey)
+                continue;
+
+            Edge edge;
+            if (e.sy < e.ey)
+                edge = {e.sx, e.sy, e.ex, e.ey, 1, 0};
+            else
+                edge = {e.ex, e.ey, e.sx, e.sy, -1, 0};
+            edge.dxdy = (edge.ex - edge.sx) / (edge.ey - edge.sy);
+            _edges.pushBack(edge);
+        }
 
-            if (range.end() > r.start) {
-                _ranges.insert(i, range);
-                return;
+        sort(_edges, [](auto const& a, auto const& b) {
+            return a.sy <=> b.sy;
+        });
+    }
+
+    // Add the edges starting before `bottom` and drop the ones ending before `top`.
+    void _updateActive(usize& next, f64 top, f64 bottom) {
+        while (next < _edges.len() and _edges[next].sy < bottom)
+            _active.pushBack(next++);
+
+        for (usize i = 0; i < _active.len();) {
+            if (_edges[_active[i]].ey <= top) {
+                _active[i] = last(_active);
+                _active.popBack();
+            } else {
+                i++;
             }
+        }
+    }
+
+    // MARK: Coverage Accumulation ---------------------------------------------
 
-            i++;
+    void _touch(isize start, isize end) {
+        _dirtyStart = min(_dirtyStart, start);
+        _dirtyEnd = max(_dirtyEnd, end);
+    }
+
+    // Accumulate the signed area of a segment fully inside [0, width].
+    void _accumulate(f64 x0, f64 y0, f64 x1, f64 y1) {
+        f64 d = y1 - y0;
+        if (d == 0)
+            return;
+
+        if (x0 > x1)
+            std::swap(x0, x1);
+
+        f64 x0floor = Math::floor(x0);
+        isize x0i = x0floor;
+        f64 x1ceil = Math::ceil(x1);
+        isize x1i = x1ceil;
+
+        if (x1i <= x0i + 1) {
+            // The segment stays in a single cell
+            f64 xmf = 0.5 * (x0 + x1) - x0floor;
+            _scanline[x0i] += d - d * xmf;
+            _scanline[x0i + 1] += d * xmf;
+            _touch(x0i, x0i + 2);
+            return;
         }
 
-        _ranges.pushBack(range);
+        f64 s = 1.0 / (x1 - x0);
+        f64 x0f = x0 - x0floor;
+        f64 a0 = 0.5 * s * (1.0 - x0f) * (1.0 - x0f);
+        f64 x1f = x1 - x1ceil + 1.0;
+        f64 am = 0.5 * s * x1f * x1f;
+
+        _scanline[x0i] += d * a0;
+        if (x1i == x0i + 2) {
+            _scanline[x0i + 1] += d * (1.0 - a0 - am);
+        } else {
+            f64 a1 = s * (1.5 - x0f);
+            _scanline[x0i + 1] += d * (a1 - a0);
+            for (isize xi = x0i + 2; xi < x1i - 1; xi++)
+                _scanline[xi] += d * s;
+            f64 a2 = a1 + (x1i - x0i - 3) * s;
+            _scanline[x1i - 1] += d * (1.0 - a2 - am);
+        }
+        _scanline[x1i] += d * am;
+        _touch(x0i, x1i + 1);
     }
 
-    void fill(Math::Polyf& poly, Math::Recti clip, FillRule fillRule, auto cb) {
-        auto polyBound = poly.bound().grow(UNIT);
-        auto clipBound = polyBound
-                             .ceil()
-                             .cast<isize>()
-                             .clipTo(clip);
+    // Clip a segment horizontally to [0, width] before accumulating it.
+    // Parts on the left are projected on the left border so they still
+    // contribute to the running sum, parts on the right are dropped.
+    void _segment(f64 x0, f64 y0, f64 x1, f64 y1, f64 width) {
+        if (x0 >= width and x1 >= width)
+            return;
+
+        if (x0 <= 0 and x1 <= 0) {
+            _scanline[0] += y1 - y0;
+            _touch(0, 1);
+            return;
+        }
 
-        _scanline.resize(clipBound.width + 1);
+        auto split = [&](f64 x) {
+            f64 y = y0 + (x - x0) * (y1 - y0) / (x1 - x0);
+            _segment(x0, y0, x, y, width);
+            _segment(x, y, x1, y1, width);
+        };
 
-        for (isize y = clipBound.top(); y < clipBound.bottom(); y++) {
-            zeroFill<f64>(mutSub(_scanline, 0, clipBound.width + 1));
-            _ranges.clear();
+        if ((x0 < 0) != (x1 < 0))
+            return split(0);
 
-            for (f64 yy = y; yy < y + 1.0; yy += UNIT) {
-                _active.clear();
+        if ((x0 > width) != (x1 > width))
+            return split(width);
 
-                for (auto& edge : poly) {
-                    auto sample = yy + HALF_UNIT;
+        _accumulate(x0, y0, x1, y1);
+    }
 
-                    if (edge.bound().top() <= sample and sample < edge.bound().bottom()) {
-                        _active.pushBack({
-                            .x = edge.sx + (sample - edge.sy) / (edge.ey - edge.sy) * (edge.ex - edge.sx),
-                            .sign = edge.sy > edge.ey ? 1 : -1,
-                        });
-                    }
-                }
+    void _fillNonZero(isize y, isize clipX, f64 width) {
+        for (auto i : _active) {
+            auto& e = _edges[i];
+            f64 top = max(e.sy, (f64)y);
+            f64 bottom = min(e.ey, (f64)(y + 1));
+            if (top >= bottom)
+                continue;
+
+            f64 dy = bottom - top;
+            f64 xt = e.xAt(top) - clipX;
+            f64 xb = e.xAt(bottom) - clipX;
+            if (e.dir > 0)
+                _segment(xt, 0, xb, dy, width);
+            else
+                _segment(xb, dy, xt, 0, width);
+        }
+    }
 
-                if (_active.len() == 0)
-                    continue;
+    // MARK: Sub-row Sampling --------------------------------------------------
+
+    void _span(f64 x1, f64 x2, isize clipX, isize clipEnd) {
+        x1 = max(x1, (f64)clipX);
+        x2 = min(x2, (f64)clipEnd);
+        if (x1 >= x2)
+            return;
 
-                sort(_active, [](auto const& a, auto const& b) {
-                    return a.x <=> b.x;
-                });
-
-                isize rule = 0;
-                for (usize i = 0; i + 1 < _active.len(); i++) {
-                    if (fillRule == FillRule::NONZERO) {
-                        rule += _active[i].sign;
-                        if (rule == 0)
-                            continue;
-                    }
-
-                    if (fillRule == FillRule::EVENODD) {
-                        rule++;
-                        if (rule % 2 == 0)
-                            continue;
-                    }
-
-                    // Clip the range to the clip rect
-                    // NOTE: The following looks a bit verbose but it's necessary to avoid
-                    //       floating point errors when converting to integer coordinates.
-                    f64 x1 = max(_active[i].x, clipBound.start());
-
-                    isize cx1 = max(Math::ceili(_active[i].x), clipBound.start());
-                    isize fx1 = max(Math::floori(_active[i].x), clipBound.start());
-
-                    f64 x2 = min(_active[i + 1].x, clipBound.end());
-                    isize cx2 = min(Math::ceili(_active[i + 1].x), clipBound.end());
-                    isize fx2 = min(Math::floori(_active[i + 1].x), clipBound.end());
-
-                    // Skip if the range is empty
-                    if (x1 >= x2)
-                        continue;
-
-                    _appendRange(irange::fromStartEnd(fx1, cx2));
-
-                    // Are x1 and x2 on the same pixel?
-                    if (fx1 == fx2) {
-                        _scanline[fx1 - clipBound.x] += (x2 - x1) * UNIT;
-                        continue;
-                    }
-
-                    // Compute the coverage for the first and last pixel
-                    _scanline[x1 - clipBound.x] += (cx1 - x1) * UNIT;
-                    _scanline[x2 - clipBound.x] += (x2 - fx2) * UNIT;
-
-                    // Fill the pixels in between
-                    for (isize x = cx1; x < fx2; x++)
-                        _scanline[x - clipBound.x] += UNIT;
+        isize fx1 = Math::floori(x1);
+        isize cx1 = Math::ceili(x1);
+        isize fx2 = Math::floori(x2);
+
+        _touch(fx1 - clipX, Math::ceili(x2) - clipX + 1);
+
+        // Are x1 and x2 on the same pixel?
+        if (fx1 == fx2) {
+            _scanline[fx1 - clipX] += (x2 - x1) * UNIT;
+            return;
+        }
+
+        // Compute the coverage for the first and last pixel
+        _scanline[fx1 - clipX] += (cx1 - x1) * UNIT;
+        _scanline[fx2 - clipX] += (x2 - fx2) * UNIT;
+
+        // Fill the pixels in between
+        for (isize x = cx1; x < fx2; x++)
+            _scanline[x - clipX] += UNIT;
+    }
+
+    void _fillEvenOdd(isize y, isize clipX, isize clipEnd) {
+        for (f64 yy = y; yy < y + 1.0; yy += UNIT) {
+            auto sample = yy + HALF_UNIT;
+
+            _crossings.clear();
+            for (auto i : _active) {
+                auto& e = _edges[i];
+                if (e.sy <= sample and sample < e.ey)
+                    _crossings.pushBack({e.xAt(sample), (isize)e.dir});
+            }
+
+            if (_crossings.len() < 2)
+                continue;
+
+            // NOTE: There are only a handful of crossings per sub-row,
+            //       insertion sort is cheaper than a full sort here.
+            for (usize i = 1; i < _crossings.len(); i++) {
+                auto c = _crossings[i];
+                usize j = i;
+                while (j > 0 and _crossings[j - 1].x > c.x) {
+                    _crossings[j] = _crossings[j - 1];
+                    j--;
                 }
+                _crossings[j] = c;
             }
 
-            for (auto r : _ranges) {
-                for (isize x = r.start; x < r.end(); x++) {
-                    auto xy = Math::Vec2i{x, y};
+            for (usize i = 0; i + 1 < _crossings.len(); i += 2)
+                _span(_crossings[i].x, _crossings[i + 1].x, clipX, clipEnd);
+        }
+    }
 
-                    auto uv = Math::Vec2f{
-                        (x - polyBound.start()) / polyBound.width,
-                        (y - polyBound.top()) / polyBound.height,
-                    };
+    // MARK: Fill --------------------------------------------------------------
 
-                    cb(Frag{xy, uv, clamp01(_scanline[x - clipBound.x])});
+    void fill(Math::Polyf& poly, Math::Recti clip, FillRule fillRule, auto cb) {
+        if (isEmpty(poly._edges))
+            return;
+
+        auto polyBound = poly.bound();
+        auto clipBound = Math::Recti::fromTwoPoint(
+                             {Math::floori(polyBound.start()), Math::floori(polyBound.top())},
+                             {Math::ceili(polyBound.end()), Math::ceili(polyBound.bottom())}
+        )
+                             .clipTo(clip);
+
+        if (clipBound.width <= 0 or clipBound.height <= 0)
+            return;
+
+        _buildEdges(poly);
+        _active.clear();
+
+        // NOTE: Two extra cells, the accumulation spills one cell to the
+        //       right of the last covered pixel.
+        _scanline.resize(clipBound.width + 2);
+        zeroFill<f64>(mutSub(_scanline));
+
+        usize next = 0;
+        for (isize y = clipBound.top(); y < clipBound.bottom(); y++) {
+            _updateActive(next, y, y + 1);
+            if (_active.len() == 0)
+                continue;
+
+            _dirtyStart = clipBound.width;
+            _dirtyEnd = 0;
+
+            if (fillRule == FillRule::NONZERO)
+                _fillNonZero(y, clipBound.x, clipBound.width);
+            else
+                _fillEvenOdd(y, clipBound.x, clipBound.end());
+
+            f64 acc = 0;
+            for (isize x = _dirtyStart; x < clipBound.width; x++) {
+                f64 a;
+                if (fillRule == FillRule::NONZERO) {
+                    // NOTE: Past the touched cells the running sum stays
+                    //       constant, keep going while we are inside the shape.
+                    acc += _scanline[x];
+                    if (x >= _dirtyEnd and Math::abs(acc) < EPSILON)
+                        break;
+                    a = clamp01(Math::abs(acc));
+                } else {
+                    if (x >= _dirtyEnd)
+                        break;
+                    a = clamp01(_scanline[x]);
                 }
+
+                if (a < EPSILON)
+                    continue;
+
+                auto xy = Math::Vec2i{clipBound.x + x, y};
+
+                auto uv = Math::Vec2f{
+                    (xy.x - polyBound.start()) / polyBound.width,
+                    (xy.y - polyBound.top()) / polyBound.height,
+                };
+
+                cb(Frag{xy, uv, a});
             }
+
+            zeroFill<f64>(mutSub(_scanline, _dirtyStart, _dirtyEnd + 1));
         }
     }
 };
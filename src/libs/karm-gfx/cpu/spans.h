@@ -0,0 +1,218 @@
+#pragma once
+
+#include <karm-base/simd.h>
+#include <karm-meta/traits.h>
+
+#include "../buffer.h"
+
+// Span kernels for 32-bit pixel formats.
+//
+// The vector kernels process 4 pixels at a time, they only handle the common
+// case of an opaque destination and defer everything else (and the tails) to
+// the scalar kernels, which go through Color::blendOver and are the reference
+// for the results.
+
+namespace Karm::Gfx {
+
+// MARK: Scalar Kernels --------------------------------------------------------
+
+always_inline Color _withCoverage(Color color, u8 const* cov, usize i) {
+    if (not cov)
+        return color;
+    return color.withAlpha((color.alpha * cov[i]) / 255);
+}
+
+template <typename F>
+void fillSpanScalar(F fmt, u8* dst, usize len, Color color) {
+    for (usize i = 0; i < len; i++)
+        fmt.store(dst + i * 4, color);
+}
+
+// Blend a solid color over the span, the coverage is optional.
+template <typename F>
+void blendSpanScalar(F fmt, u8* dst, usize len, Color color, u8 const* cov = nullptr) {
+    for (usize i = 0; i < len; i++) {
+        auto c = _withCoverage(color, cov, i);
+        if (c.alpha == 0)
+            continue;
+        auto* p = dst + i * 4;
+        fmt.store(p, c.blendOver(fmt.load(p)));
+    }
+}
+
+template <typename S, typename D>
+void copySpanScalar(S srcFmt, u8 const* src, D destFmt, u8* dst, usize len) {
+    for (usize i = 0; i < len; i++)
+        destFmt.store(dst + i * 4, srcFmt.load(src + i * 4));
+}
+
+template <typename S, typename D>
+void blitSpanScalar(S srcFmt, u8 const* src, D destFmt, u8* dst, usize len) {
+    for (usize i = 0; i < len; i++) {
+        auto c = srcFmt.load(src + i * 4);
+        auto* p = dst + i * 4;
+        destFmt.store(p, c.blendOver(destFmt.load(p)));
+    }
+}
+
+// MARK: Vector Helpers --------------------------------------------------------
+
+static constexpr u8x16 _ALPHA_MASK = {
+    0, 0, 0, 255,
+    0, 0, 0, 255,
+    0, 0, 0, 255,
+    0, 0, 0, 255,
+};
+
+always_inline u8x16 _loadPixels(u8 const* p) {
+    u8x16 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+always_inline void _storePixels(u8* p, u8x16 v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+always_inline u8x16 _splatPixel(u8 const* p) {
+    return {
+        p[0], p[1], p[2], p[3],
+        p[0], p[1], p[2], p[3],
+        p[0], p[1], p[2], p[3],
+        p[0], p[1], p[2], p[3],
+    };
+}
+
+// Exact floor(x / 255) for x <= 255 * 255
+always_inline u16x16 _div255(u16x16 x) {
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+always_inline bool _allOpaque(u8x16 v) {
+    auto a = (u64x2)(v & _ALPHA_MASK);
+    return a[0] == 0xFF000000FF000000 and a[1] == 0xFF000000FF000000;
+}
+
+always_inline bool _allTransparent(u8x16 v) {
+    auto a = (u64x2)(v & _ALPHA_MASK);
+    return (a[0] | a[1]) == 0;
+}
+
+// Blend src over an opaque destination, `a` is the alpha of each lane.
+always_inline u8x16 _blendOverOpaque(u16x16 src, u16x16 a, u8x16 dst) {
+    u16x16 d = __builtin_convertvector(dst, u16x16);
+    u16x16 res = _div255(d * (255 - a) + src * a);
+    return __builtin_convertvector(res, u8x16) | _ALPHA_MASK;
+}
+
+// Convert pixels from the layout of S to the layout of D.
+template <typename S, typename D>
+always_inline u8x16 _swizzle(u8x16 v) {
+    if constexpr (Meta::Same<S, D>)
+        return v;
+    else
+        // RGBA <-> BGRA
+        return __builtin_shufflevector(v, v, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+}
+
+// MARK: Vector Kernels --------------------------------------------------------
+
+template <typename F>
+void fillSpan(F fmt, u8* dst, usize len, Color color) {
+    Array<u8, 4> px;
+    fmt.store(px.buf(), color);
+    u8x16 v = _splatPixel(px.buf());
+
+    usize i = 0;
+    for (; i + 4 <= len; i += 4)
+        _storePixels(dst + i * 4, v);
+    fillSpanScalar(fmt, dst + i * 4, len - i, color);
+}
+
+// Blend a solid color over the span, the coverage is optional.
+template <typename F>
+void blendSpan(F fmt, u8* dst, usize len, Color color, u8 const* cov = nullptr) {
+    if (color.alpha == 0)
+        return;
+
+    if (color.alpha == 255 and not cov)
+        return fillSpan(fmt, dst, len, color);
+
+    Array<u8, 4> px;
+    fmt.store(px.buf(), color);
+    u16x16 src = __builtin_convertvector(_splatPixel(px.buf()), u16x16);
+
+    usize i = 0;
+    for (; i + 4 <= len; i += 4) {
+        u8* d = dst + i * 4;
+
+        u16 a0 = cov ? (color.alpha * cov[i + 0]) / 255 : color.alpha;
+        u16 a1 = cov ? (color.alpha * cov[i + 1]) / 255 : color.alpha;
+        u16 a2 = cov ? (color.alpha * cov[i + 2]) / 255 : color.alpha;
+        u16 a3 = cov ? (color.alpha * cov[i + 3]) / 255 : color.alpha;
+
+        if ((a0 | a1 | a2 | a3) == 0)
+            continue;
+
+        u8x16 dv = _loadPixels(d);
+        if (not _allOpaque(dv)) {
+            blendSpanScalar(fmt, d, 4, color, cov ? cov + i : nullptr);
+            continue;
+        }
+
+        u16x16 a = {
+            a0, a0, a0, a0,
+            a1, a1, a1, a1,
+            a2, a2, a2, a2,
+            a3, a3, a3, a3,
+        };
+        _storePixels(d, _blendOverOpaque(src, a, dv));
+    }
+
+    blendSpanScalar(fmt, dst + i * 4, len - i, color, cov ? cov + i : nullptr);
+}
+
+// Copy pixels without blending.
+template <typename S, typename D>
+void copySpan(S srcFmt, u8 const* src, D destFmt, u8* dst, usize len) {
+    if constexpr (Meta::Same<S, D>) {
+        memcpy(dst, src, len * 4);
+    } else {
+        usize i = 0;
+        for (; i + 4 <= len; i += 4)
+            _storePixels(dst + i * 4, _swizzle<S, D>(_loadPixels(src + i * 4)));
+        copySpanScalar(srcFmt, src + i * 4, destFmt, dst + i * 4, len - i);
+    }
+}
+
+// Blend pixels over the span using their own alpha.
+template <typename S, typename D>
+void blitSpan(S srcFmt, u8 const* src, D destFmt, u8* dst, usize len) {
+    usize i = 0;
+    for (; i + 4 <= len; i += 4) {
+        u8* d = dst + i * 4;
+        u8x16 sv = _swizzle<S, D>(_loadPixels(src + i * 4));
+
+        if (_allOpaque(sv)) {
+            _storePixels(d, sv);
+            continue;
+        }
+
+        if (_allTransparent(sv))
+            continue;
+
+        u8x16 dv = _loadPixels(d);
+        if (not _allOpaque(dv)) {
+            blitSpanScalar(srcFmt, src + i * 4, destFmt, d, 4);
+            continue;
+        }
+
+        u16x16 s = __builtin_convertvector(sv, u16x16);
+        u16x16 a = __builtin_shufflevector(s, s, 3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15);
+        _storePixels(d, _blendOverOpaque(s, a, dv));
+    }
+
+    blitSpanScalar(srcFmt, src + i * 4, destFmt, dst + i * 4, len - i);
+}
+
+} // namespace Karm::Gfx
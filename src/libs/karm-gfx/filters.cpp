@@ -1,102 +1,144 @@
-#include <karm-base/ring.h>
+#include <karm-base/simd.h>
 #include <karm-math/rand.h>
 
 #include "filters.h"
 
 namespace Karm::Gfx {
 
+// Stack blur approximates a gaussian with a triangular kernel. The sums
+// entering and leaving the window are updated incrementally so the cost
+// per pixel doesn't depend on the radius.
 struct StackBlur {
-    isize _radius;
-    Ring<Math::Vec4u> _queue;
-    Math::Vec4u _sum;
+    usize _radius;
+    u32 _div;
+    Vec<u32x4> _stack;
 
-    StackBlur(isize radius)
-        : _radius(radius), _queue(width()) {
-        clear();
+    StackBlur(usize radius)
+        : _radius(radius), _div((radius + 1) * (radius + 1)) {
+        _stack.resize(radius * 2 + 1);
     }
 
-    Math::Vec4u outgoingSum() const {
-        Math::Vec4u sum = {};
-        for (isize i = 0; i < _radius; i++) {
-            sum = sum + _queue.peek(i);
+    // Blur `len` values spaced by `stride` in place, edges are clamped.
+    //
+    // NOTE: Writing in place is fine, the value at x + radius + 1 is
+    //       read before x + radius + 1 is written, and the last value
+    //       is only overwritten on the last iteration.
+    [[gnu::flatten]] void apply(u32x4* line, usize len, usize stride) {
+        isize r = _radius;
+        usize w = _stack.len();
+
+        auto at = [&](isize i) -> u32x4 {
+            return line[clamp(i, 0, (isize)len - 1) * stride];
+        };
+
+        u32x4 sum = {};
+        u32x4 sumIn = {};
+        u32x4 sumOut = {};
+
+        for (isize i = -r; i <= r; i++) {
+            auto v = at(i);
+            _stack[i + r] = v;
+            sum += v * (u32)(r + 1 - (i < 0 ? -i : i));
+            if (i <= 0)
+                sumOut += v;
+            else
+                sumIn += v;
         }
-        return sum;
-    }
 
-    Math::Vec4u incomingSum() const {
-        Math::Vec4u sum = {};
-        for (isize i = 0; i < _radius; i++) {
-            sum = sum + _queue.peek(width() - i - 1);
+        usize sp = r;
+        for (usize x = 0; x < len; x++) {
+            line[x * stride] = sum / _div;
+
+            // Slide the window, the oldest value leaves on the left...
+            sum -= sumOut;
+            usize oldest = sp + r + 1;
+            if (oldest >= w)
+                oldest -= w;
+            sumOut -= _stack[oldest];
+
+            // ...and a new one enters on the right.
+            auto v = at(x + r + 1);
+            _stack[oldest] = v;
+            sumIn += v;
+            sum += sumIn;
+
+            if (++sp == w)
+                sp = 0;
+            sumOut += _stack[sp];
+            sumIn -= _stack[sp];
         }
-        return sum;
     }
+};
 
-    isize width() const {
-        return _radius * 2 + 1;
-    }
+always_inline static u32x4 _unpack(Color c) {
+    return {c.red, c.green, c.blue, c.alpha};
+}
 
-    isize denominator() const {
-        return _radius * (_radius + 2) - 1;
-    }
+always_inline static Color _pack(u32x4 v) {
+    return Color::fromRgba(v[0], v[1], v[2], v[3]);
+}
 
-    void enqueue(Math::Vec4u color) {
-        _queue.pushBack(color);
-        _sum = _sum + incomingSum() - outgoingSum();
-    }
+// Columns are blurred in tiles so each row of the tile
+// is a contiguous read from the surface.
+static constexpr usize BLUR_TILE = 16;
 
-    Math::Vec4u dequeue() {
-        auto res = _sum / denominator();
-        _queue.popFront();
-        return res;
-    }
+// NOTE: Rows and columns in different ranges don't depend on each other,
+//       each pass can be split between workers given their own StackBlur.
+static void _blurRows(auto f, MutPixels p, StackBlur& blur, isize start, isize end) {
+    usize width = p.width();
+    Vec<u32x4> line;
+    line.resize(width);
 
-    void clear() {
-        _sum = {};
-        _queue.clear();
-        for (isize i = 0; i < width(); i++) {
-            _queue.pushBack({});
-        }
-    }
-};
+    for (isize y = start; y < end; y++) {
+        u8* row = static_cast<u8*>(p.scanline(y));
 
-[[gnu::flatten]] void BlurFilter::apply(MutPixels p) const {
-    if (amount == 0)
-        return;
+        for (usize x = 0; x < width; x++)
+            line[x] = _unpack(f.load(row + x * f.bpp()));
 
-    StackBlur stack{(isize)amount};
-    auto b = p.bound();
+        blur.apply(line.buf(), width, 1);
 
-    for (isize y = b.top(); y < b.bottom(); y++) {
-        for (isize i = 0; i < stack.width(); i++) {
-            auto x = b.start() + i - (isize)amount;
-            stack.dequeue();
-            stack.enqueue(p.load({x, y}));
-        }
+        for (usize x = 0; x < width; x++)
+            f.store(row + x * f.bpp(), _pack(line[x]));
+    }
+}
 
-        for (isize x = b.start(); x < b.end(); x++) {
-            p.store({x, y}, stack.dequeue());
-            stack.enqueue(p.load({x + (isize)amount + 1, y}));
-        }
+static void _blurColumns(auto f, MutPixels p, StackBlur& blur, isize start, isize end) {
+    usize height = p.height();
+    Vec<u32x4> tile;
+    tile.resize(height * BLUR_TILE);
 
-        stack.clear();
-    }
+    for (isize tx = start; tx < end; tx += BLUR_TILE) {
+        usize n = min(BLUR_TILE, (usize)(end - tx));
 
-    for (isize x = b.start(); x < b.end(); x++) {
-        for (isize i = 0; i < stack.width(); i++) {
-            isize const y = b.top() + i - (isize)amount;
-            stack.dequeue();
-            stack.enqueue(p.load({x, y}));
+        for (usize y = 0; y < height; y++) {
+            u8* row = static_cast<u8*>(p.pixelUnsafe({tx, (isize)y}));
+            for (usize c = 0; c < n; c++)
+                tile[y * BLUR_TILE + c] = _unpack(f.load(row + c * f.bpp()));
         }
 
-        for (isize y = b.top(); y < b.bottom(); y++) {
-            p.store({x, y}, stack.dequeue());
-            stack.enqueue(p.load({x, y + (isize)amount + 1}));
-        }
+        for (usize c = 0; c < n; c++)
+            blur.apply(tile.buf() + c, height, BLUR_TILE);
 
-        stack.clear();
+        for (usize y = 0; y < height; y++) {
+            u8* row = static_cast<u8*>(p.pixelUnsafe({tx, (isize)y}));
+            for (usize c = 0; c < n; c++)
+                f.store(row + c * f.bpp(), _pack(tile[y * BLUR_TILE + c]));
+        }
     }
 }
 
+void BlurFilter::apply(MutPixels p) const {
+    usize radius = amount;
+    if (radius == 0 or p.width() == 0 or p.height() == 0)
+        return;
+
+    StackBlur blur{radius};
+    p.fmt().visit([&](auto f) {
+        _blurRows(f, p, blur, 0, p.height());
+        _blurColumns(f, p, blur, 0, p.width());
+    });
+}
+
 void SaturationFilter::apply(MutPixels p) const {
     auto b = p.bound();
 
@@ -0,0 +1,41 @@
+#include <karm-image/jpeg/decoder.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/file.h>
+#include <karm-sys/mmap.h>
+#include <karm-sys/time.h>
+
+static constexpr usize ROUNDS = 10;
+
+// NOTE: The samples are shared with the decoder tests.
+static constexpr Array<Str, 4> JPEG_SAMPLES = {
+    "cat.jpg",
+    "birch.jpg",
+    "park.jpg",
+    "yosemite.jpg",
+};
+
+static Res<> benchJpeg(Str name, usize scale) {
+    auto file = try$(Sys::File::open("bundle://karm-image.jpeg.tests"_url / name));
+    auto map = try$(Sys::mmap().map(file));
+
+    usize bytes = 0;
+    auto start = Sys::now();
+    for (usize i = 0; i < ROUNDS; i++) {
+        auto jpeg = try$(Jpeg::Decoder::init(map.bytes()));
+        auto img = Gfx::Surface::alloc(jpeg.scaledSize(scale));
+        try$(jpeg.decode(*img, scale));
+        bytes += img->pixels().bytes().len();
+    }
+    auto elapsed = Sys::now() - start;
+
+    Sys::println("jpeg {} 1/{}: {} bytes of pixels in {}, {.1} MB/s", name, scale, bytes, elapsed, bytes / (elapsed.toUSecs() + 1.0));
+    return Ok();
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    for (auto name : JPEG_SAMPLES)
+        for (usize scale : {1uz, 8uz})
+            co_try$(benchJpeg(name, scale));
+
+    co_return Ok();
+}
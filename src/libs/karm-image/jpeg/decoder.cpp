@@ -1,3 +1,5 @@
+#include <karm-base/simd.h>
+
 #include "decoder.h"
 
 namespace Jpeg {
@@ -47,7 +49,7 @@ Res<Decoder> Decoder::init(Bytes slice) {
             try$(dec.defineHuffmanTable(s));
         } else if (marker == SOS) {
             try$(dec.startOfScan(s));
-            try$(dec.decodeHuffman(s));
+            try$(dec.entropyCodedData(s));
         } else if (marker == EOI) {
             reachedEoi = true;
         } else if (marker == TEM) {
@@ -298,136 +300,574 @@ Res<> Decoder::startOfScan(Io::BScan& x) {
     return Ok();
 }
 
-Res<> Decoder::decodeHuffman(Io::BScan& s) {
-    _mcus.resize(mcuWidth() * mcuHeight() * _componentCount);
+Res<> Decoder::entropyCodedData(Io::BScan& s) {
+    auto bytes = s.remBytes();
 
-    Array<isize, 3> prevDc = {};
+    // NOTE: The segment ends on the first marker that is neither
+    //       a stuffed 0xFF nor a restart marker.
+    usize len = 0;
+    while (len + 1 < bytes.len()) {
+        if (bytes[len] == 0xFF) {
+            u8 next = bytes[len + 1];
+            if (next != 0x00 and (next < RST0 or next > RST7))
+                break;
+            len += 2;
+            continue;
+        }
+        len++;
+    }
 
-    BitReader bs{s};
+    if (len + 1 >= bytes.len()) {
+        logError("jpeg: unterminated scan");
+        return Error::invalidData("unterminated scan");
+    }
 
-    for (usize i = 0; i < _mcus.len(); ++i) {
-        Mcu& mcu = _mcus[i];
-        usize cid = i % _componentCount;
+    _scan = sub(bytes, 0, len);
+    s.skip(len);
 
-        // logDebug("jpeg: decoding mcu {} of {} (cid: {})", i + 1, _mcus.len(), cid);
+    return Ok();
+}
 
-        // handle restart interval
-        if (_restartInterval > 0 and (i / _componentCount) % _restartInterval == 0) {
-            prevDc = {};
-            bs.reset();
+// MARK: Entropy Decoding ------------------------------------------------------
+
+// Reads the entropy coded segment a word at a time, byte stuffing is removed
+// on the fly and running into a marker feeds zeros until the next restart.
+struct ScanReader {
+    Bytes _buf;
+    usize _pos = 0;
+    u64 _bits = 0;
+    isize _count = 0;
+    bool _marker = false;
+
+    always_inline void refill() {
+        while (_count <= 56) {
+            u64 byte = 0;
+            if (not _marker and _pos < _buf.len()) {
+                byte = _buf[_pos];
+                if (byte != 0xFF) {
+                    _pos++;
+                } else if (_pos + 1 < _buf.len() and _buf[_pos + 1] == 0x00) {
+                    _pos += 2;
+                } else {
+                    _marker = true;
+                    byte = 0;
+                }
+            }
+            _bits |= byte << (56 - _count);
+            _count += 8;
         }
+    }
 
-        if (not _scanComponents[cid]) {
-            logError("jpeg: undefined component id: {}", cid);
-            return Error::invalidData("undefined component id");
+    always_inline u32 peek(usize n) const {
+        return _bits >> (64 - n);
+    }
+
+    always_inline void consume(usize n) {
+        _bits <<= n;
+        _count -= n;
+    }
+
+    // Read `n` bits and extend them to a signed value (F.2.2.1)
+    always_inline i32 receive(usize n) {
+        if (n == 0)
+            return 0;
+        refill();
+        i32 v = peek(n);
+        consume(n);
+        if (v < (1 << (n - 1)))
+            v -= (1 << n) - 1;
+        return v;
+    }
+
+    Res<> restart() {
+        _bits = 0;
+        _count = 0;
+        _marker = false;
+
+        while (_pos + 1 < _buf.len()) {
+            u8 next = _buf[_pos + 1];
+            if (_buf[_pos] == 0xFF and RST0 <= next and next <= RST7) {
+                _pos += 2;
+                return Ok();
+            }
+            _pos++;
         }
 
-        auto& c = _scanComponents[cid].unwrap();
+        logError("jpeg: missing restart marker");
+        return Error::invalidData("missing restart marker");
+    }
+};
 
-        // logDebug("jpeg: decoding using huffman table (dc: {}, ac: {})", c.dcHuffId, c.acHuffId);
+// Canonical Huffman decoding table, codes up to LOOKUP_BITS long are
+// resolved with a single lookup, longer ones walk the code lengths.
+struct HuffLut {
+    static constexpr usize LOOKUP_BITS = 9;
+
+    // (length << 8) | symbol, zero when the code is longer.
+    Array<u16, 1 << LOOKUP_BITS> _lookup = {};
+    Array<i32, 17> _maxCode = {};
+    Array<i32, 17> _valOff = {};
+    Huff const* _huff = nullptr;
+
+    Res<> build(Huff const& huff) {
+        _huff = &huff;
+        i32 code = 0;
+        for (usize len = 1; len <= 16; len++) {
+            usize start = huff.offs[len - 1];
+            usize end = huff.offs[len];
+            _valOff[len] = start - code;
+
+            for (usize i = start; i < end; i++) {
+                if (code >= (1 << len)) {
+                    logError("jpeg: oversubscribed huffman table");
+                    return Error::invalidData("oversubscribed huffman table");
+                }
 
-        if (not _dcHuff[c.dcHuffId]) {
-            logError("jpeg: undefined dc huffman table id: {}", c.dcHuffId);
-            return Error::invalidData("undefined dc huffman table id");
+                if (len <= LOOKUP_BITS) {
+                    usize shift = LOOKUP_BITS - len;
+                    for (usize j = 0; j < (1uz << shift); j++)
+                        _lookup[(code << shift) | j] = (len << 8) | huff.syms[i];
+                }
+                code++;
+            }
+
+            _maxCode[len] = end > start ? code - 1 : -1;
+            code <<= 1;
         }
+        return Ok();
+    }
 
-        auto& dcHuff = _dcHuff[c.dcHuffId].unwrap();
+    always_inline Res<u8> decode(ScanReader& r) const {
+        r.refill();
+        if (u16 e = _lookup[r.peek(LOOKUP_BITS)]) {
+            r.consume(e >> 8);
+            return Ok(e & 0xFF);
+        }
 
-        if (not _acHuff[c.acHuffId]) {
-            logError("jpeg: undefined ac huffman table id: {}", c.acHuffId);
-            return Error::invalidData("undefined ac huffman table id");
+        for (usize len = LOOKUP_BITS + 1; len <= 16; len++) {
+            i32 code = r.peek(len);
+            if (code <= _maxCode[len]) {
+                r.consume(len);
+                return Ok(_huff->syms[_valOff[len] + code]);
+            }
         }
 
-        auto& acHuff = _acHuff[c.acHuffId].unwrap();
+        logError("jpeg: invalid huffman code");
+        return Error::invalidData("invalid huffman code");
+    }
+};
 
-        Byte len = try$(dcHuff.next(bs));
+using Block = Array<i16, 64>;
 
-        if (len > 11) {
-            logError("jpeg: invalid dc huffman code length: {}", len);
-            return Error::invalidData("invalid dc huffman code length");
-        }
+// Decode the coefficients of a block in natural order, returns the
+// zig-zag index of the last non-zero coefficient.
+static Res<usize> _decodeBlock(ScanReader& r, HuffLut const& dc, HuffLut const& ac, i32& pred, Block& block) {
+    block = {};
+
+    u8 size = try$(dc.decode(r));
+    if (size > 11) {
+        logError("jpeg: invalid dc huffman code length: {}", size);
+        return Error::invalidData("invalid dc huffman code length");
+    }
+
+    pred += r.receive(size);
+    block[0] = pred;
 
-        isize coeff = try$(bs.nextBits(len));
+    usize last = 0;
+    for (usize k = 1; k < 64;) {
+        u8 sym = try$(ac.decode(r));
+        u8 run = sym >> 4;
+        size = sym & 0xF;
 
-        if (len != 0 and coeff < (1 << (len - 1))) {
-            coeff -= (1 << len) - 1;
+        if (size == 0) {
+            if (run != 15)
+                break;
+            k += 16;
+            continue;
         }
 
-        mcu[0] = prevDc[cid] + coeff;
-        prevDc[cid] = mcu[0];
+        k += run;
+        if (k >= 64) {
+            logError("jpeg: zero run length exceeds block size: {}", k);
+            return Error::invalidData("zero run length exceeds block size");
+        }
 
-        usize k = 1;
-        while (k < 64) {
-            Byte sym = try$(acHuff.next(bs));
+        block[ZIGZAG[k]] = r.receive(size);
+        last = k++;
+    }
 
-            if (sym == 0) {
-                break;
-            }
+    return Ok(last);
+}
 
-            Byte numZeroes = sym >> 4;
+// MARK: Inverse DCT -----------------------------------------------------------
+
+// Scale factors of the AAN algorithm in 14-bit fixed point, they are
+// folded into the quantization tables, see _prescale().
+static constexpr Array<i32, 64> AAN_SCALES = {
+    16384, 22725, 21407, 19266, 16384, 12873, 8867, 4520,
+    22725, 31521, 29692, 26722, 22725, 17855, 12299, 6270,
+    21407, 29692, 27969, 25172, 21407, 16819, 11585, 5906,
+    19266, 26722, 25172, 22654, 19266, 15137, 10426, 5315,
+    16384, 22725, 21407, 19266, 16384, 12873, 8867, 4520,
+    12873, 17855, 16819, 15137, 12873, 10114, 6967, 3552,
+    8867, 12299, 11585, 10426, 8867, 6967, 4799, 2446,
+    4520, 6270, 5906, 5315, 4520, 3552, 2446, 1247
+};
 
-            if (sym == 0xF0) {
-                numZeroes = 16;
-            }
+// The prescaled coefficients carry PASS_BITS of extra precision.
+static constexpr usize PASS_BITS = 2;
 
-            if (k + numZeroes >= 64) {
-                logError("jpeg: zero run length exceeds block size: {}", k + numZeroes);
-                return Error::invalidData("zero run length exceeds block size");
-            }
+static constexpr i32 FIX_1_082392200 = 277;
+static constexpr i32 FIX_1_414213562 = 362;
+static constexpr i32 FIX_1_847759065 = 473;
+static constexpr i32 FIX_2_613125930 = 669;
 
-            k += numZeroes;
+using Prescaled = Array<i32, 64>;
 
-            Byte len = sym & 0xF;
+static Prescaled _prescale(Quant const& quant) {
+    Prescaled res;
+    for (usize i = 0; i < 64; i++)
+        res[i] = (quant[i] * AAN_SCALES[i] + (1 << (13 - PASS_BITS))) >> (14 - PASS_BITS);
+    return res;
+}
 
-            if (len > 10) {
-                logError("jpeg: invalid ac huffman code length: {}", len);
-                return Error::invalidData("invalid ac huffman code length");
-            }
+always_inline static i32x8 _mul(i32x8 v, i32 c) {
+    return (v * c) >> 8;
+}
 
-            if (len) {
-                coeff = try$(bs.nextBits(len));
+always_inline static u8 _sample(i32 v) {
+    return clamp(v + 128, 0, 255);
+}
 
-                if (coeff < (1 << (len - 1))) {
-                    coeff -= (1 << len) - 1;
-                }
+// One dimensional AAN inverse DCT, each lane is an independent transform.
+always_inline static void _idct8(Array<i32x8, 8>& v) {
+    // Even part
+    i32x8 tmp10 = v[0] + v[4];
+    i32x8 tmp11 = v[0] - v[4];
+    i32x8 tmp13 = v[2] + v[6];
+    i32x8 tmp12 = _mul(v[2] - v[6], FIX_1_414213562) - tmp13;
+
+    i32x8 e0 = tmp10 + tmp13;
+    i32x8 e3 = tmp10 - tmp13;
+    i32x8 e1 = tmp11 + tmp12;
+    i32x8 e2 = tmp11 - tmp12;
+
+    // Odd part
+    i32x8 z13 = v[5] + v[3];
+    i32x8 z10 = v[5] - v[3];
+    i32x8 z11 = v[1] + v[7];
+    i32x8 z12 = v[1] - v[7];
+
+    i32x8 o7 = z11 + z13;
+    i32x8 z5 = _mul(z10 + z12, FIX_1_847759065);
+    i32x8 o6 = _mul(z10, -FIX_2_613125930) + z5 - o7;
+    i32x8 o5 = _mul(z11 - z13, FIX_1_414213562) - o6;
+    i32x8 o4 = _mul(z12, FIX_1_082392200) - z5 + o5;
+
+    v[0] = e0 + o7;
+    v[7] = e0 - o7;
+    v[1] = e1 + o6;
+    v[6] = e1 - o6;
+    v[2] = e2 + o5;
+    v[5] = e2 - o5;
+    v[4] = e3 + o4;
+    v[3] = e3 - o4;
+}
 
-                mcu[ZIGZAG[k++]] = coeff;
-            }
+always_inline static void _transpose(Array<i32x8, 8>& v) {
+    Array<i32x8, 8> t;
+    for (usize i = 0; i < 8; i++)
+        for (usize j = 0; j < 8; j++)
+            t[i][j] = v[j][i];
+    v = t;
+}
+
+static void _idctBlock(Block const& block, usize last, Prescaled const& quant, u8* out, usize stride) {
+    constexpr usize SHIFT = PASS_BITS + 3;
+
+    if (last == 0) {
+        u8 dc = _sample((block[0] * quant[0] + (1 << (SHIFT - 1))) >> SHIFT);
+        for (usize y = 0; y < 8; y++)
+            memset(out + y * stride, dc, 8);
+        return;
+    }
+
+    // NOTE: Rows of coefficients are loaded in the lanes so the first pass
+    //       transforms all the columns at once, the second pass does the
+    //       same on the transposed result.
+    Array<i32x8, 8> v;
+    for (usize y = 0; y < 8; y++)
+        for (usize x = 0; x < 8; x++)
+            v[y][x] = block[y * 8 + x] * quant[y * 8 + x];
+
+    _idct8(v);
+    _transpose(v);
+    _idct8(v);
+
+    for (usize y = 0; y < 8; y++)
+        for (usize x = 0; x < 8; x++)
+            out[y * stride + x] = _sample((v[x][y] + (1 << (SHIFT - 1))) >> SHIFT);
+}
+
+// Basis of the reduced inverse DCTs in 10-bit fixed point, rows are indexed by
+// the output sample: C(u) times the average of cos((2x + 1) * u * pi / 16) over
+// the 8 / N full size samples covered by the output sample. The result is the
+// full size decode box filtered down, computed straight from the coefficients.
+static constexpr Array<i32, 32> IDCT4_BASIS = {
+    724, 928, 669, 326, 0, -218, -277, -185,
+    724, 384, -669, -787, 0, 526, 277, -76,
+    724, -384, -669, 787, 0, -526, 277, 76,
+    724, -928, 669, -326, 0, 218, -277, 185,
+};
+
+static constexpr Array<i32, 16> IDCT2_BASIS = {
+    724, 656, 0, -230, 0, 154, 0, -131,
+    724, -656, 0, 230, 0, -154, 0, 131,
+};
+
+template <usize N>
+static void _idctReduced(Block const& block, Quant const& quant, Array<i32, N * 8> const& basis, u8* out, usize stride) {
+    Array<i32, 8 * N> tmp;
+    for (usize v = 0; v < 8; v++) {
+        for (usize x = 0; x < N; x++) {
+            i32 sum = 0;
+            for (usize u = 0; u < 8; u++)
+                sum += basis[x * 8 + u] * block[v * 8 + u] * (i32)quant[v * 8 + u];
+            tmp[v * N + x] = (sum + 512) >> 10;
         }
     }
 
-    return Ok();
+    // NOTE: The extra shift by 2 is the 1/4 factor of the 2D transform.
+    for (usize y = 0; y < N; y++) {
+        for (usize x = 0; x < N; x++) {
+            i32 sum = 0;
+            for (usize v = 0; v < 8; v++)
+                sum += basis[y * 8 + v] * tmp[v * N + x];
+            out[y * stride + x] = _sample((sum + 2048) >> 12);
+        }
+    }
 }
 
-Res<> Decoder::decode(Gfx::MutPixels pixels) {
-    for (usize i = 0; i < _mcus.len(); i += _componentCount) {
-        usize x = (i / _componentCount) % mcuWidth();
-        usize y = (i / _componentCount) / mcuWidth();
+// Only the DC coefficient is left at 1/8, it's the average of the block.
+static void _idctDc(Block const& block, Quant const& quant, u8* out) {
+    out[0] = _sample((block[0] * (i32)quant[0] + 4) >> 3);
+}
 
-        for (usize j = 0; j < _componentCount; j++) {
-            auto& mcu = _mcus[i + j];
+// MARK: Color Conversion ------------------------------------------------------
 
-            if (not _quant[_components[j]->quantId]) {
-                logError("jpeg: undefined quantization table id: {}", _components[j]->quantId);
-                return Error::invalidData("undefined quantization table id");
-            }
+always_inline static Gfx::Color _yCbCrToRgb(i32 y, i32 cb, i32 cr) {
+    cb -= 128;
+    cr -= 128;
+    return Gfx::Color::fromRgb(
+        clamp(y + ((91881 * cr + 32768) >> 16), 0, 255),
+        clamp(y + ((-22554 * cb - 46802 * cr + 32768) >> 16), 0, 255),
+        clamp(y + ((116130 * cb + 32768) >> 16), 0, 255)
+    );
+}
+
+// MARK: Decoding --------------------------------------------------------------
+
+usize Decoder::scaleFor(Math::Vec2i size) const {
+    usize scale = 8;
+    while (scale > 1) {
+        auto scaled = scaledSize(scale);
+        if (scaled.x >= size.x and scaled.y >= size.y)
+            break;
+        scale /= 2;
+    }
+    return scale;
+}
+
+// State of a component while decoding, samples of the current
+// MCU row are kept in a plane and upsampled when emitting the rows.
+struct Channel {
+    usize hFactor;
+    usize vFactor;
+    HuffLut const* dc;
+    HuffLut const* ac;
+    Quant const* quant;
+    Prescaled prescaled;
+    i32 pred = 0;
+
+    // Size of the blocks once transformed, 8 / scale or larger for
+    // subsampled components so they need less upsampling.
+    usize blockSize = 8;
+    Vec<u8> plane = {};
+    usize stride = 0;
+
+    // Sample of the plane used for each output column.
+    Vec<u16> columns = {};
+
+    usize row(usize y, usize vMax, usize outBlockSize) const {
+        return (y * vFactor * blockSize) / (vMax * outBlockSize);
+    }
+
+    void idct(Block const& block, usize last, u8* out) const {
+        if (blockSize == 8)
+            _idctBlock(block, last, prescaled, out, stride);
+        else if (blockSize == 4)
+            _idctReduced<4>(block, *quant, IDCT4_BASIS, out, stride);
+        else if (blockSize == 2)
+            _idctReduced<2>(block, *quant, IDCT2_BASIS, out, stride);
+        else
+            _idctDc(block, *quant, out);
+    }
+};
+
+Res<> Decoder::decode(Gfx::MutPixels pixels, usize scale) {
+    if (scale != 1 and scale != 2 and scale != 4 and scale != 8) {
+        logError("jpeg: unsupported scale: {}", scale);
+        return Error::invalidInput("unsupported scale");
+    }
+
+    if (_scan.len() == 0) {
+        logError("jpeg: missing scan");
+        return Error::invalidData("missing scan");
+    }
 
-            auto& quant = _quant[_components[j]->quantId].unwrap();
-            dequantize(mcu, quant);
-            idct(mcu);
+    Array<HuffLut, 4> dcLuts;
+    Array<HuffLut, 4> acLuts;
+    Array<bool, 4> dcBuilt = {};
+    Array<bool, 4> acBuilt = {};
+
+    Vec<Channel> channels;
+    usize hMax = 1;
+    usize vMax = 1;
+
+    for (usize i = 0; i < _componentCount; i++) {
+        if (not _components[i] or not _scanComponents[i]) {
+            logError("jpeg: undefined component id: {}", i);
+            return Error::invalidData("undefined component id");
         }
 
-        auto& yMcu = _mcus[i + 0];
-        auto& cbMcu = _mcus[i + 1];
-        auto& crMcu = _mcus[i + 2];
+        auto& comp = _components[i].unwrap();
+        auto& scanComp = _scanComponents[i].unwrap();
 
-        for (usize k = 0; k < 64; ++k) {
-            isize px = x * 8 + k % 8;
-            isize py = y * 8 + k / 8;
+        if (comp.quantId > 3 or not _quant[comp.quantId]) {
+            logError("jpeg: undefined quantization table id: {}", comp.quantId);
+            return Error::invalidData("undefined quantization table id");
+        }
 
-            Gfx::YCbCr ycbcr{(float)yMcu[k], (float)cbMcu[k], (float)crMcu[k]};
-            pixels.storeUnsafe({px, py}, Gfx::yCbCrToRgb(ycbcr));
+        if (not _dcHuff[scanComp.dcHuffId]) {
+            logError("jpeg: undefined dc huffman table id: {}", scanComp.dcHuffId);
+            return Error::invalidData("undefined dc huffman table id");
         }
+
+        if (not _acHuff[scanComp.acHuffId]) {
+            logError("jpeg: undefined ac huffman table id: {}", scanComp.acHuffId);
+            return Error::invalidData("undefined ac huffman table id");
+        }
+
+        if (not dcBuilt[scanComp.dcHuffId]) {
+            try$(dcLuts[scanComp.dcHuffId].build(_dcHuff[scanComp.dcHuffId].unwrap()));
+            dcBuilt[scanComp.dcHuffId] = true;
+        }
+
+        if (not acBuilt[scanComp.acHuffId]) {
+            try$(acLuts[scanComp.acHuffId].build(_acHuff[scanComp.acHuffId].unwrap()));
+            acBuilt[scanComp.acHuffId] = true;
+        }
+
+        // NOTE: A scan with a single component isn't interleaved,
+        //       each MCU is a single block whatever the factors say.
+        usize h = _componentCount == 1 ? 1 : comp.hFactor;
+        usize v = _componentCount == 1 ? 1 : comp.vFactor;
+        if (h < 1 or h > 4 or v < 1 or v > 4) {
+            logError("jpeg: invalid sampling factors: {}x{}", h, v);
+            return Error::invalidData("invalid sampling factors");
+        }
+
+        hMax = max(hMax, h);
+        vMax = max(vMax, v);
+
+        auto& quant = _quant[comp.quantId].unwrap();
+        channels.pushBack(Channel{
+            .hFactor = h,
+            .vFactor = v,
+            .dc = &dcLuts[scanComp.dcHuffId],
+            .ac = &acLuts[scanComp.acHuffId],
+            .quant = &quant,
+            .prescaled = _prescale(quant),
+        });
+    }
+
+    usize blockSize = 8 / scale;
+    usize mcusX = (_width + 8 * hMax - 1) / (8 * hMax);
+    usize mcusY = (_height + 8 * vMax - 1) / (8 * vMax);
+    usize mcuRows = vMax * blockSize;
+
+    auto size = scaledSize(scale);
+    usize outWidth = min(pixels.width(), size.x);
+    usize outHeight = min(pixels.height(), size.y);
+
+    for (auto& c : channels) {
+        c.blockSize = blockSize;
+        for (usize ratio = min(hMax / c.hFactor, vMax / c.vFactor); ratio > 1 and c.blockSize < 8; ratio /= 2)
+            c.blockSize *= 2;
+
+        c.stride = mcusX * c.hFactor * c.blockSize;
+        c.plane.resize(c.stride * c.vFactor * c.blockSize, 0);
+        c.columns.resize(outWidth, 0);
+        for (usize x = 0; x < outWidth; x++)
+            c.columns[x] = (x * c.hFactor * c.blockSize) / (hMax * blockSize);
+    }
+
+    ScanReader r{_scan};
+    Block block;
+    usize mcuIndex = 0;
+
+    for (usize my = 0; my < mcusY; my++) {
+        for (usize mx = 0; mx < mcusX; mx++) {
+            if (_restartInterval and mcuIndex and mcuIndex % _restartInterval == 0) {
+                try$(r.restart());
+                for (auto& c : channels)
+                    c.pred = 0;
+            }
+            mcuIndex++;
+
+            for (auto& c : channels) {
+                for (usize v = 0; v < c.vFactor; v++) {
+                    for (usize h = 0; h < c.hFactor; h++) {
+                        usize last = try$(_decodeBlock(r, *c.dc, *c.ac, c.pred, block));
+                        c.idct(block, last, c.plane.buf() + v * c.blockSize * c.stride + (mx * c.hFactor + h) * c.blockSize);
+                    }
+                }
+            }
+        }
+
+        // Upsample and convert the rows covered by this MCU row
+        usize top = my * mcuRows;
+        usize rows = min(mcuRows, outHeight - min(top, outHeight));
+
+        pixels.fmt().visit([&](auto f) {
+            usize bpp = f.bpp();
+            for (usize ly = 0; ly < rows; ly++) {
+                u8* dst = static_cast<u8*>(pixels.scanline(top + ly));
+
+                if (channels.len() == 1) {
+                    auto& c = channels[0];
+                    u8 const* src = c.plane.buf() + ly * c.stride;
+                    for (usize x = 0; x < outWidth; x++)
+                        f.store(dst + x * bpp, Gfx::Color::fromRgb(src[x], src[x], src[x]));
+                    continue;
+                }
+
+                auto& cy = channels[0];
+                auto& ccb = channels[1];
+                auto& ccr = channels[2];
+
+                u8 const* ys = cy.plane.buf() + cy.row(ly, vMax, blockSize) * cy.stride;
+                u8 const* cbs = ccb.plane.buf() + ccb.row(ly, vMax, blockSize) * ccb.stride;
+                u8 const* crs = ccr.plane.buf() + ccr.row(ly, vMax, blockSize) * ccr.stride;
+
+                for (usize x = 0; x < outWidth; x++) {
+                    f.store(
+                        dst + x * bpp,
+                        _yCbCrToRgb(ys[cy.columns[x]], cbs[ccb.columns[x]], crs[ccr.columns[x]])
+                    );
+                }
+            }
+        });
     }
 
     return Ok();
@@ -44,9 +44,16 @@ struct Decoder {
 
     isize height() const { return _height; }
 
-    isize mcuWidth() const { return (_width + 7) / 8; }
+    Math::Vec2i scaledSize(usize scale) const {
+        return {
+            (_width + (isize)scale - 1) / (isize)scale,
+            (_height + (isize)scale - 1) / (isize)scale,
+        };
+    }
 
-    isize mcuHeight() const { return (_height + 7) / 8; }
+    // Largest downscaling factor supported by decode() that
+    // keeps the image at least as big as `size`.
+    usize scaleFor(Math::Vec2i size) const;
 
     struct Component {
         u8 hFactor;
@@ -87,15 +94,19 @@ struct Decoder {
 
     Res<> startOfScan(Io::BScan& x);
 
-    // MARK: Huffman Data ------------------------------------------------------
+    // MARK: Entropy Coded Data ------------------------------------------------
 
-    Vec<Mcu> _mcus;
+    // Entropy coded segment of the scan, restart markers included.
+    // It's decoded one MCU row at a time by decode().
+    Bytes _scan{};
 
-    Res<> decodeHuffman(Io::BScan& s);
+    Res<> entropyCodedData(Io::BScan& s);
 
     // MARK: Decoding ----------------------------------------------------------
 
-    Res<> decode(Gfx::MutPixels pixels);
+    // Decode the image into `pixels`, `scale` (1, 2, 4 or 8) downscales
+    // the image in the DCT domain, see scaledSize().
+    Res<> decode(Gfx::MutPixels pixels, usize scale = 1);
 
     // MARK: Dumping -----------------------------------------------------------
 
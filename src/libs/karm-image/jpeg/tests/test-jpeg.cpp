@@ -0,0 +1,103 @@
+#include <karm-image/jpeg/decoder.h>
+#include <karm-sys/file.h>
+#include <karm-sys/mmap.h>
+#include <karm-test/macros.h>
+
+namespace Jpeg::Tests {
+
+static Res<Sys::Mmap> mapFile(Str name) {
+    auto file = try$(Sys::File::open("bundle://karm-image.jpeg.tests"_url / name));
+    return Sys::mmap().map(file);
+}
+
+static Res<Rc<Gfx::Surface>> decodeFile(Str name, usize scale = 1) {
+    auto map = try$(mapFile(name));
+    auto jpeg = try$(Decoder::init(map.bytes()));
+    auto img = Gfx::Surface::alloc(jpeg.scaledSize(scale));
+    try$(jpeg.decode(*img, scale));
+    return Ok(img);
+}
+
+// The decoder trades a bit of precision for speed, compare
+// channels with some tolerance against libjpeg's results.
+static bool near(Gfx::Color a, Gfx::Color b, u8 tolerance = 3) {
+    return Math::abs(a.red - b.red) <= tolerance and
+           Math::abs(a.green - b.green) <= tolerance and
+           Math::abs(a.blue - b.blue) <= tolerance;
+}
+
+// Mean absolute difference between a downscaled decode and
+// the full size decode box filtered down by the same factor.
+static f64 scaledError(Gfx::Pixels full, Gfx::Pixels scaled, usize scale) {
+    f64 sum = 0;
+    usize count = 0;
+
+    for (isize y = 0; y < full.height() / (isize)scale; y++) {
+        for (isize x = 0; x < full.width() / (isize)scale; x++) {
+            Array<u32, 3> acc = {};
+            for (isize j = 0; j < (isize)scale; j++) {
+                for (isize i = 0; i < (isize)scale; i++) {
+                    auto c = full.loadUnsafe({x * (isize)scale + i, y * (isize)scale + j});
+                    acc[0] += c.red;
+                    acc[1] += c.green;
+                    acc[2] += c.blue;
+                }
+            }
+
+            auto c = scaled.loadUnsafe({x, y});
+            f64 area = scale * scale;
+            sum += Math::abs(c.red - acc[0] / area);
+            sum += Math::abs(c.green - acc[1] / area);
+            sum += Math::abs(c.blue - acc[2] / area);
+            count += 3;
+        }
+    }
+
+    return sum / count;
+}
+
+test$("jpeg-decode") {
+    auto img = try$(decodeFile("cat-8mcu.jpg"));
+    expectEq$(img->width(), 64);
+    expectEq$(img->height(), 64);
+    expect$(near(img->pixels().load({0, 0}), Gfx::Color::fromRgb(14, 9, 6)));
+    expect$(near(img->pixels().load({10, 20}), Gfx::Color::fromRgb(16, 6, 4)));
+
+    return Ok();
+}
+
+test$("jpeg-subsampled") {
+    // 4:2:0 with a restart marker every 4 MCUs
+    auto img = try$(decodeFile("cat-420-rst.jpg"));
+    expectEq$(img->width(), 960);
+    expectEq$(img->height(), 600);
+    expect$(near(img->pixels().load({0, 0}), Gfx::Color::fromRgb(16, 11, 8)));
+
+    return Ok();
+}
+
+test$("jpeg-scaled") {
+    for (Str name : {"cat-smaller.jpg", "cat-420-rst.jpg"}) {
+        auto full = try$(decodeFile(name));
+        for (usize scale : {2uz, 4uz, 8uz}) {
+            auto scaled = try$(decodeFile(name, scale));
+            expectEq$(scaled->width(), (full->width() + (isize)scale - 1) / (isize)scale);
+            expectLt$(scaledError(full->pixels(), scaled->pixels(), scale), 1.0);
+        }
+    }
+
+    return Ok();
+}
+
+test$("jpeg-scale-for") {
+    auto map = try$(mapFile("cat-smaller.jpg"));
+    auto jpeg = try$(Decoder::init(map.bytes()));
+    expectEq$(jpeg.scaleFor({960, 600}), 1uz);
+    expectEq$(jpeg.scaleFor({480, 100}), 2uz);
+    expectEq$(jpeg.scaleFor({100, 100}), 4uz);
+    expectEq$(jpeg.scaleFor({64, 64}), 8uz);
+
+    return Ok();
+}
+
+} // namespace Jpeg::Tests
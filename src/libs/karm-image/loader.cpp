@@ -40,6 +40,14 @@ static Res<Picture> loadJpeg(Bytes bytes) {
     return Ok(img);
 }
 
+static Res<Picture> loadJpegThumbnail(Bytes bytes, Math::Vec2i size) {
+    auto jpeg = try$(Jpeg::Decoder::init(bytes));
+    usize scale = jpeg.scaleFor(size);
+    auto img = Gfx::Surface::alloc(jpeg.scaledSize(scale));
+    try$(jpeg.decode(*img, scale));
+    return Ok(img);
+}
+
 static Res<Picture> loadTga(Bytes bytes) {
     auto tga = try$(Tga::Decoder::init(bytes));
     auto img = Gfx::Surface::alloc({tga.width(), tga.height()});
@@ -78,6 +86,14 @@ Res<Picture> load(Mime::Url url) {
     return load(std::move(map));
 }
 
+Res<Picture> loadThumbnail(Mime::Url url, Math::Vec2i size) {
+    auto file = try$(Sys::File::open(url));
+    auto map = try$(Sys::mmap().map(file));
+    if (Jpeg::Decoder::sniff(map.bytes()))
+        return loadJpegThumbnail(map.bytes(), size);
+    return load(std::move(map));
+}
+
 Res<Picture> loadOrFallback(Mime::Url url) {
     if (auto result = load(url); result)
         return result;
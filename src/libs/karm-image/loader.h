@@ -12,4 +12,9 @@ Res<Picture> load(Mime::Url url);
 
 Res<Picture> loadOrFallback(Mime::Url url);
 
+// Load a picture that is going to be displayed at `size`, JPEG images are
+// downscaled while decoding (by up to 8) but never smaller than `size`,
+// other formats are loaded at full size.
+Res<Picture> loadThumbnail(Mime::Url url, Math::Vec2i size);
+
 } // namespace Karm::Image
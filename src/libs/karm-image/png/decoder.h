@@ -1,7 +1,9 @@
 #pragma once
 
+#include <karm-archive/zlib/spec.h>
 #include <karm-base/string.h>
 #include <karm-gfx/canvas.h>
+#include <karm-gfx/cpu/spans.h>
 #include <karm-io/bscan.h>
 #include <karm-logger/logger.h>
 
@@ -41,6 +43,19 @@ struct Ihdr : public Io::BChunk {
 
 struct Plte : public Io::BChunk {
     static constexpr Str SIG = "PLTE";
+
+    usize len() const {
+        return bytes().len() / 3;
+    }
+
+    Gfx::Color color(usize index) const {
+        auto b = bytes();
+        return Gfx::Color::fromRgb(b[index * 3], b[index * 3 + 1], b[index * 3 + 2]);
+    }
+};
+
+struct Trns : public Io::BChunk {
+    static constexpr Str SIG = "tRNS";
 };
 
 struct Idat : public Io::BChunk {
@@ -51,6 +66,112 @@ struct Iend : public Io::BChunk {
     static constexpr Str SIG = "IEND";
 };
 
+// Color types
+static constexpr u8 GRAYSCALE = 0;
+static constexpr u8 TRUECOLOR = 2;
+static constexpr u8 INDEXED = 3;
+static constexpr u8 GRAYSCALE_ALPHA = 4;
+static constexpr u8 TRUECOLOR_ALPHA = 6;
+
+// Filter types
+static constexpr u8 FILTER_NONE = 0;
+static constexpr u8 FILTER_SUB = 1;
+static constexpr u8 FILTER_UP = 2;
+static constexpr u8 FILTER_AVG = 3;
+static constexpr u8 FILTER_PAETH = 4;
+
+struct Pass {
+    isize x, y;
+    isize dx, dy;
+};
+
+static constexpr Array<Pass, 1> NO_INTERLACE = {
+    Pass{0, 0, 1, 1},
+};
+
+static constexpr Array<Pass, 7> ADAM7 = {
+    Pass{0, 0, 8, 8},
+    Pass{4, 0, 8, 8},
+    Pass{0, 4, 4, 8},
+    Pass{2, 0, 4, 4},
+    Pass{0, 2, 2, 4},
+    Pass{1, 0, 2, 2},
+    Pass{0, 1, 1, 2},
+};
+
+// MARK: Unfiltering -----------------------------------------------------------
+
+always_inline static u8 _paeth(u8 a, u8 b, u8 c) {
+    isize p = (isize)a + b - c;
+    isize pa = p > a ? p - a : a - p;
+    isize pb = p > b ? p - b : b - p;
+    isize pc = p > c ? p - c : c - p;
+    if (pa <= pb and pa <= pc)
+        return a;
+    if (pb <= pc)
+        return b;
+    return c;
+}
+
+// Reverse the filter of a scanline in place. `BPP` is the distance in bytes
+// between a byte and the same byte of the previous pixel, knowing it at
+// compile time lets the compiler unroll and vectorize each pixel.
+template <usize BPP>
+static Res<> _unfilter(u8 filter, u8* row, u8 const* prev, usize len) {
+    switch (filter) {
+    case FILTER_NONE:
+        return Ok();
+
+    case FILTER_SUB:
+        for (usize i = BPP; i < len; i++)
+            row[i] += row[i - BPP];
+        return Ok();
+
+    case FILTER_UP:
+        for (usize i = 0; i < len; i++)
+            row[i] += prev[i];
+        return Ok();
+
+    case FILTER_AVG:
+        for (usize i = 0; i < BPP and i < len; i++)
+            row[i] += prev[i] >> 1;
+        for (usize i = BPP; i < len; i++)
+            row[i] += (row[i - BPP] + prev[i]) >> 1;
+        return Ok();
+
+    case FILTER_PAETH:
+        for (usize i = 0; i < BPP and i < len; i++)
+            row[i] += prev[i];
+        for (usize i = BPP; i < len; i++)
+            row[i] += _paeth(row[i - BPP], prev[i], prev[i - BPP]);
+        return Ok();
+
+    default:
+        return Error::invalidData("invalid filter type");
+    }
+}
+
+static Res<> _unfilter(usize bpp, u8 filter, u8* row, u8 const* prev, usize len) {
+    switch (bpp) {
+    case 1:
+        return _unfilter<1>(filter, row, prev, len);
+    case 2:
+        return _unfilter<2>(filter, row, prev, len);
+    case 3:
+        return _unfilter<3>(filter, row, prev, len);
+    case 4:
+        return _unfilter<4>(filter, row, prev, len);
+    case 6:
+        return _unfilter<6>(filter, row, prev, len);
+    case 8:
+        return _unfilter<8>(filter, row, prev, len);
+    default:
+        return Error::invalidData("invalid pixel size");
+    }
+}
+
+// MARK: Decoder ---------------------------------------------------------------
+
 struct Decoder {
     static constexpr Array<u8, 8> SIG = {
         0x89, 0x50, 0x4E, 0x47,
@@ -61,7 +182,7 @@ struct Decoder {
 
     Ihdr _ihdr;
     Plte _plte;
-    Idat _idat;
+    Trns _trns;
 
     Bytes sig() {
         return begin().nextBytes(8);
@@ -71,19 +192,6 @@ struct Decoder {
         return slice.len() >= 8 and sub(slice, 0, 8) == SIG;
     }
 
-    static Res<Decoder> init(Bytes slice) {
-        Decoder dec{slice};
-
-        if (dec.sig() == SIG)
-            return Error::invalidData("invalid signature");
-
-        dec._ihdr = dec.lookupChunk<Ihdr>();
-        dec._plte = dec.lookupChunk<Plte>();
-        dec._idat = dec.lookupChunk<Idat>();
-
-        return Ok(dec);
-    }
-
     Decoder(Bytes slice)
         : _slice(slice) {}
 
@@ -103,6 +211,10 @@ struct Decoder {
         };
 
         return Iter{[s] mutable -> Opt<Chunk> {
+            // Length, type and crc
+            if (s.rem() < 12)
+                return NONE;
+
             Chunk c;
 
             c.len = s.nextI32be();
@@ -130,6 +242,29 @@ struct Decoder {
         return T{};
     }
 
+    static Res<Decoder> init(Bytes slice) {
+        Decoder dec{slice};
+
+        if (not sniff(slice))
+            return Error::invalidData("invalid signature");
+
+        for (auto chunk : dec.iterChunks()) {
+            if (chunk.sig == Ihdr::SIG)
+                dec._ihdr = Ihdr{chunk.data};
+            else if (chunk.sig == Plte::SIG)
+                dec._plte = Plte{chunk.data};
+            else if (chunk.sig == Trns::SIG)
+                dec._trns = Trns{chunk.data};
+        }
+
+        if (dec._ihdr.bytes().len() < 13)
+            return Error::invalidData("missing IHDR chunk");
+
+        try$(dec._validate());
+
+        return Ok(dec);
+    }
+
     isize width() {
         return _ihdr.size().x;
     }
@@ -138,7 +273,254 @@ struct Decoder {
         return _ihdr.size().y;
     }
 
-    Res<> decode(Gfx::MutPixels) {
+    usize channels() {
+        switch (_ihdr.colorType()) {
+        case TRUECOLOR:
+            return 3;
+        case GRAYSCALE_ALPHA:
+            return 2;
+        case TRUECOLOR_ALPHA:
+            return 4;
+        default:
+            return 1;
+        }
+    }
+
+    Res<> _validate() {
+        u8 depth = _ihdr.bitDepth();
+        bool valid = false;
+        switch (_ihdr.colorType()) {
+        case GRAYSCALE:
+            valid = depth == 1 or depth == 2 or depth == 4 or depth == 8 or depth == 16;
+            break;
+        case INDEXED:
+            valid = depth == 1 or depth == 2 or depth == 4 or depth == 8;
+            break;
+        case TRUECOLOR:
+        case GRAYSCALE_ALPHA:
+        case TRUECOLOR_ALPHA:
+            valid = depth == 8 or depth == 16;
+            break;
+        }
+
+        if (not valid)
+            return Error::invalidData("invalid color type and bit depth");
+
+        if (_ihdr.compressionMethod() != 0 or _ihdr.filterMethod() != 0)
+            return Error::invalidData("unsupported compression or filter method");
+
+        if (_ihdr.interlaceMethod() > 1)
+            return Error::invalidData("unsupported interlace method");
+
+        if (_ihdr.colorType() == INDEXED and not _plte.present())
+            return Error::invalidData("missing PLTE chunk");
+
+        if (width() <= 0 or height() <= 0)
+            return Error::invalidData("invalid image size");
+
+        return Ok();
+    }
+
+    // MARK: Pixels ------------------------------------------------------------
+
+    // Sample `i` of a scanline at its full bit depth.
+    always_inline static u16 _raw(u8 const* row, usize i, u8 depth) {
+        if (depth == 8)
+            return row[i];
+        if (depth == 16)
+            return (row[i * 2] << 8) | row[i * 2 + 1];
+        usize bit = i * depth;
+        return (row[bit / 8] >> (8 - depth - bit % 8)) & ((1 << depth) - 1);
+    }
+
+    always_inline static u8 _scale(u16 v, u8 depth) {
+        if (depth == 16)
+            return v >> 8;
+        if (depth == 8)
+            return v;
+        return v * 255 / ((1 << depth) - 1);
+    }
+
+    u16 _key(usize i) {
+        auto b = _trns.bytes();
+        if (b.len() < i * 2 + 2)
+            return 0xFFFF;
+        return (b[i * 2] << 8) | b[i * 2 + 1];
+    }
+
+    void _emitRow(Gfx::MutPixels out, u8 const* row, Pass pass, isize len, isize y) {
+        u8 depth = _ihdr.bitDepth();
+        bool keyed = _trns.present();
+
+        out.fmt().visit([&](auto f) {
+            u8* dst = static_cast<u8*>(out.pixelUnsafe({pass.x, pass.y + y * pass.dy}));
+            usize step = pass.dx * f.bpp();
+
+            auto emit = [&](auto sample) {
+                for (isize x = 0; x < len; x++)
+                    f.store(dst + x * step, sample(x));
+            };
+
+            switch (_ihdr.colorType()) {
+            case GRAYSCALE: {
+                u16 key = _key(0);
+                emit([&](isize x) {
+                    u16 v = _raw(row, x, depth);
+                    u8 g = _scale(v, depth);
+                    return Gfx::Color::fromRgba(g, g, g, keyed and v == key ? 0 : 255);
+                });
+                break;
+            }
+
+            case TRUECOLOR: {
+                if (depth == 8 and not keyed) {
+                    emit([&](isize x) {
+                        return Gfx::Color::fromRgb(row[x * 3], row[x * 3 + 1], row[x * 3 + 2]);
+                    });
+                    break;
+                }
+
+                u16 kr = _key(0);
+                u16 kg = _key(1);
+                u16 kb = _key(2);
+                emit([&](isize x) {
+                    u16 r = _raw(row, x * 3, depth);
+                    u16 g = _raw(row, x * 3 + 1, depth);
+                    u16 b = _raw(row, x * 3 + 2, depth);
+                    bool transparent = keyed and r == kr and g == kg and b == kb;
+                    return Gfx::Color::fromRgba(
+                        _scale(r, depth), _scale(g, depth), _scale(b, depth),
+                        transparent ? 0 : 255
+                    );
+                });
+                break;
+            }
+
+            case INDEXED: {
+                auto alpha = _trns.bytes();
+                emit([&](isize x) {
+                    u16 i = _raw(row, x, depth);
+                    if (i >= _plte.len())
+                        return Gfx::BLACK;
+                    return _plte.color(i).withAlpha(i < alpha.len() ? alpha[i] : 255);
+                });
+                break;
+            }
+
+            case GRAYSCALE_ALPHA:
+                emit([&](isize x) {
+                    u8 g = _scale(_raw(row, x * 2, depth), depth);
+                    return Gfx::Color::fromRgba(g, g, g, _scale(_raw(row, x * 2 + 1, depth), depth));
+                });
+                break;
+
+            case TRUECOLOR_ALPHA:
+                if (depth == 8 and pass.dx == 1) {
+                    Gfx::copySpan(Gfx::RGBA8888, row, f, dst, len);
+                    break;
+                }
+
+                emit([&](isize x) {
+                    return Gfx::Color::fromRgba(
+                        _scale(_raw(row, x * 4, depth), depth),
+                        _scale(_raw(row, x * 4 + 1, depth), depth),
+                        _scale(_raw(row, x * 4 + 2, depth), depth),
+                        _scale(_raw(row, x * 4 + 3, depth), depth)
+                    );
+                });
+                break;
+            }
+        });
+    }
+
+    // MARK: Decoding ----------------------------------------------------------
+
+    // Decode the image straight into `out`, the IDAT chunks are inflated
+    // as a stream and only two scanlines are kept around for unfiltering.
+    Res<> decode(Gfx::MutPixels out) {
+        if (out.width() < width() or out.height() < height())
+            return Error::invalidData("destination too small");
+
+        usize bitsPerPixel = channels() * _ihdr.bitDepth();
+        usize bpp = max(bitsPerPixel / 8, 1uz);
+
+        bool interlaced = _ihdr.interlaceMethod() == 1;
+        usize passCount = interlaced ? ADAM7.len() : NO_INTERLACE.len();
+        auto passAt = [&](usize i) {
+            return interlaced ? ADAM7[i] : NO_INTERLACE[i];
+        };
+
+        // NOTE: The scanlines of the first pass are always the widest,
+        //       one byte in front of the current row holds the filter type.
+        usize maxRowLen = (width() * bitsPerPixel + 7) / 8;
+        Vec<u8> buf;
+        buf.resize((maxRowLen + 1) * 2);
+        u8* cur = buf.buf();
+        u8* prev = buf.buf() + maxRowLen + 1;
+
+        usize passIndex = 0;
+        Pass pass{};
+        isize passWidth = 0;
+        isize passHeight = 0;
+        usize rowLen = 0;
+        isize y = 0;
+        usize filled = 0;
+
+        // Move to the next pass that has pixels.
+        auto startPass = [&] {
+            for (; passIndex < passCount; passIndex++) {
+                pass = passAt(passIndex);
+                passWidth = width() > pass.x ? (width() - pass.x + pass.dx - 1) / pass.dx : 0;
+                passHeight = height() > pass.y ? (height() - pass.y + pass.dy - 1) / pass.dy : 0;
+                if (passWidth == 0 or passHeight == 0)
+                    continue;
+
+                rowLen = (passWidth * bitsPerPixel + 7) / 8;
+                y = 0;
+                filled = 0;
+                zeroFill<u8>(mutSub(buf));
+                return;
+            }
+        };
+
+        auto sink = [&](Bytes bytes) -> Res<> {
+            while (bytes.len() and passIndex < passCount) {
+                usize n = min(rowLen + 1 - filled, bytes.len());
+                memcpy(cur + filled, bytes.buf(), n);
+                bytes = sub(bytes, n, bytes.len());
+                filled += n;
+
+                if (filled < rowLen + 1)
+                    continue;
+
+                try$(_unfilter(bpp, cur[0], cur + 1, prev + 1, rowLen));
+                _emitRow(out, cur + 1, pass, passWidth, y);
+                std::swap(cur, prev);
+                filled = 0;
+
+                if (++y == passHeight) {
+                    passIndex++;
+                    startPass();
+                }
+            }
+            return Ok();
+        };
+
+        startPass();
+
+        auto idats = iterChunks()
+                         .filter([](auto const& c) {
+                             return c.sig == Idat::SIG;
+                         })
+                         .map([](auto const& c) {
+                             return c.data;
+                         });
+
+        try$(Zlib::decompress(idats.next, sink));
+
+        if (passIndex < passCount)
+            return Error::invalidData("missing image data");
+
         return Ok();
     }
 };
@@ -0,0 +1,109 @@
+#include <karm-image/png/decoder.h>
+#include <karm-sys/file.h>
+#include <karm-sys/mmap.h>
+#include <karm-sys/time.h>
+#include <karm-test/macros.h>
+
+namespace Png::Tests {
+
+static Res<Sys::Mmap> mapFile(Str name) {
+    auto file = try$(Sys::File::open("bundle://karm-image.png.tests/pngsuite"_url / name));
+    return Sys::mmap().map(file);
+}
+
+static Res<Rc<Gfx::Surface>> decodeFile(Str name) {
+    auto map = try$(mapFile(name));
+    auto png = try$(Decoder::init(map.bytes()));
+    auto img = Gfx::Surface::alloc({png.width(), png.height()});
+    try$(png.decode(*img));
+    return Ok(img);
+}
+
+static bool samePixels(Gfx::Pixels a, Gfx::Pixels b) {
+    if (a.size() != b.size())
+        return false;
+
+    for (isize y = 0; y < a.height(); y++)
+        for (isize x = 0; x < a.width(); x++)
+            if (a.loadUnsafe({x, y}) != b.loadUnsafe({x, y}))
+                return false;
+
+    return true;
+}
+
+// Same image in every color type and bit depth, without and with interlacing.
+static Array<Str, 15> const BASIC = {
+    "0g01", "0g02", "0g04", "0g08", "0g16",
+    "2c08", "2c16",
+    "3p01", "3p02", "3p04", "3p08",
+    "4a08", "4a16",
+    "6a08", "6a16"
+};
+
+test$("png-decode") {
+    auto img = try$(decodeFile("basn6a08.png"));
+    expectEq$(img->width(), 32);
+    expectEq$(img->height(), 32);
+    expectEq$(img->pixels().load({0, 0}), Gfx::Color::fromRgba(255, 0, 8, 0));
+    expectEq$(img->pixels().load({5, 0}), Gfx::Color::fromRgba(255, 0, 8, 41));
+
+    return Ok();
+}
+
+test$("png-interlaced") {
+    for (auto type : BASIC) {
+        auto plain = try$(decodeFile(Io::format("basn{}.png", type)));
+        auto interlaced = try$(decodeFile(Io::format("basi{}.png", type)));
+        expect$(samePixels(plain->pixels(), interlaced->pixels()));
+    }
+
+    return Ok();
+}
+
+test$("png-transparency") {
+    // Color key on a truecolor image
+    auto rgb = try$(decodeFile("tbrn2c08.png"));
+    expectEq$(rgb->pixels().load({0, 0}).alpha, 0);
+
+    // Alpha table on an indexed image
+    auto indexed = try$(decodeFile("tbbn3p08.png"));
+    expectEq$(indexed->pixels().load({0, 0}).alpha, 0);
+
+    return Ok();
+}
+
+test$("png-corrupted") {
+    // Bad signature, bad color type and missing image data
+    for (Str name : {"xs1n0g01.png", "xc9n2c08.png", "xdtn0g01.png"}) {
+        auto map = try$(mapFile(name));
+        auto png = Decoder::init(map.bytes());
+        if (not png)
+            continue;
+        auto img = Gfx::Surface::alloc({png.unwrap().width(), png.unwrap().height()});
+        expect$(not png.unwrap().decode(*img));
+    }
+
+    return Ok();
+}
+
+test$("png-throughput") {
+    static constexpr usize ROUNDS = 20;
+
+    usize bytes = 0;
+    auto start = Sys::now();
+    for (usize i = 0; i < ROUNDS; i++) {
+        for (auto type : BASIC) {
+            for (Str prefix : {"basn", "basi"}) {
+                auto img = try$(decodeFile(Io::format("{}{}.png", prefix, type)));
+                bytes += img->pixels().bytes().len();
+            }
+        }
+    }
+    auto elapsed = Sys::now() - start;
+
+    logInfo("png: decoded {} bytes of pixels in {}, {.1} MB/s", bytes, elapsed, bytes / (elapsed.toUSecs() + 1.0));
+
+    return Ok();
+}
+
+} // namespace Png::Tests
@@ -543,6 +543,23 @@ struct Formatter<Rc<T>> {
     }
 };
 
+template <typename T>
+struct Formatter<Arc<T>> {
+    Formatter<T> formatter;
+
+    void parse(Io::SScan& scan) {
+        if constexpr (requires() {
+                          formatter.parse(scan);
+                      }) {
+            formatter.parse(scan);
+        }
+    }
+
+    Res<> format(Io::TextWriter& writer, Arc<T> const& val) {
+        return formatter.format(writer, val.unwrap());
+    }
+};
+
 template <typename T>
 struct Formatter<Weak<T>> {
     Formatter<T> formatter;
@@ -1,5 +1,6 @@
 module;
 
+#include <karm-base/opt.h>
 #include <karm-base/rc.h>
 #include <karm-base/slice.h>
 
@@ -117,4 +118,11 @@ Blob MutBlob::slice(urange slice) const {
     };
 }
 
+// A key and its value, NONE marks a deleted key that
+// still has to shadow older versions of itself.
+export struct Entry {
+    Blob key;
+    Opt<Blob> value;
+};
+
 } // namespace Karm::Kv
@@ -0,0 +1,70 @@
+module;
+
+#include <karm-base/align.h>
+#include <karm-base/vec.h>
+
+export module Karm.Kv:bloom;
+
+namespace Karm::Kv {
+
+// NOTE: Filters are persisted in tables, this hash must never change.
+export u64 hashKey(Bytes key) {
+    // FNV-1a followed by the murmur3 finalizer to spread the bits.
+    u64 h = 0xcbf29ce484222325;
+    for (auto b : key) {
+        h ^= b;
+        h *= 0x100000001b3;
+    }
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccd;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53;
+    h ^= h >> 33;
+    return h;
+}
+
+// A bloom filter over the keys of a table, it lets lookups skip tables
+// that can't contain a key without touching their index or data blocks.
+export struct Bloom {
+    // About 1% of false positives.
+    static constexpr usize BITS_PER_KEY = 10;
+    static constexpr usize PROBES = 7;
+
+    Bytes _bits;
+
+    static Vec<u8> build(Slice<u64> hashes) {
+        usize nbits = max(hashes.len() * BITS_PER_KEY, 64uz);
+        Vec<u8> bits;
+        bits.resize(alignUp(nbits, 8) / 8, 0);
+        nbits = bits.len() * 8;
+
+        for (auto h : hashes) {
+            u64 delta = (h >> 17) | (h << 47);
+            for (usize i = 0; i < PROBES; i++) {
+                usize bit = h % nbits;
+                bits[bit / 8] |= 1 << (bit % 8);
+                h += delta;
+            }
+        }
+
+        return bits;
+    }
+
+    bool mayContain(u64 h) const {
+        usize nbits = _bits.len() * 8;
+        if (nbits == 0)
+            return true;
+
+        u64 delta = (h >> 17) | (h << 47);
+        for (usize i = 0; i < PROBES; i++) {
+            usize bit = h % nbits;
+            if (not(_bits[bit / 8] & (1 << (bit % 8))))
+                return false;
+            h += delta;
+        }
+        return true;
+    }
+};
+
+} // namespace Karm::Kv
@@ -1,13 +1,141 @@
 #include <karm-sys/entry.h>
+#include <karm-sys/time.h>
 
 import Karm.Kv;
 
-Async::Task<> entryPointAsync(Sys::Context&) {
-    auto wal = co_try$(Kv::Wal::open("file:./db.wal"_url));
-    auto store = Kv::Store::open(wal);
+static constexpr usize KEYS = 200000;
+static constexpr usize VALUE_SIZE = 100;
+
+// Durable writes are bound by the sync, so fewer of them are enough.
+static constexpr usize SYNCED_WRITES = 2000;
+static constexpr usize WRITERS = 32;
+
+// Big endian keys sort in numeric order, the multiplier is
+// coprime with KEYS so every key is visited in a scattered order.
+static u64be keyFor(usize i) {
+    return (i * 7919) % KEYS;
+}
+
+static Bytes bytesOf(u64be const& key) {
+    return {reinterpret_cast<u8 const*>(&key), sizeof(key)};
+}
+
+static void report(Str name, usize ops, Duration elapsed) {
+    Sys::println("{}: {} ops in {}, {.1} ops/s", name, ops, elapsed, ops / (elapsed.toUSecs() / 1e6));
+}
+
+static Array<u8, VALUE_SIZE> const VALUE = [] {
+    Array<u8, VALUE_SIZE> value;
+    for (auto& b : value)
+        b = 'v';
+    return value;
+}();
 
-    co_try$(store->put(bytes("hello"s), bytes("world"s)));
-    co_try$(store->del(bytes("hello"s)));
+// MARK: Writes ----------------------------------------------------------------
 
+static Async::Task<> writerAsync(Kv::Store& store, usize writer, usize count) {
+    for (usize i = 0; i < count; i++) {
+        u64be key = writer * count + i;
+        co_trya$(store.putAsync(bytesOf(key), VALUE));
+    }
+    co_return Ok();
+}
+
+// Compare one write per put against concurrent writers sharing their writes.
+static Async::Task<> benchWritesAsync(Str name, Kv::Durability durability) {
+    auto url = Mime::Url::parse(Io::format("file:./bench-{}.kv", name));
+    auto store = co_try$(Kv::Store::open(url, {.durability = durability}));
+
+    auto start = Sys::now();
+    for (usize i = 0; i < SYNCED_WRITES; i++) {
+        u64be key = i;
+        co_try$(store->put(bytesOf(key), VALUE));
+    }
+    report(Io::format("put ({})", name), SYNCED_WRITES, Sys::now() - start);
+
+    usize running = WRITERS;
+    Res<> res = Ok();
+    start = Sys::now();
+    for (usize i = 0; i < WRITERS; i++) {
+        Async::detach(writerAsync(*store, i, SYNCED_WRITES / WRITERS), [&](Res<> r) {
+            if (not r)
+                res = r;
+            running--;
+        });
+    }
+    while (running)
+        co_trya$(Sys::globalSched().sleepAsync(Sys::instant()));
+    co_try$(res);
+    report(Io::format("putAsync ({}, {} writers)", name, WRITERS), SYNCED_WRITES, Sys::now() - start);
+
+    co_return Ok();
+}
+
+// MARK: Reads -----------------------------------------------------------------
+
+static Async::Task<> benchReadsAsync() {
+    auto url = "file:./bench.kv"_url;
+    usize found = 0;
+    usize scanned = 0;
+
+    {
+        auto store = co_try$(Kv::Store::open(url, {.durability = Kv::Durability::NONE}));
+
+        auto start = Sys::now();
+        for (usize i = 0; i < KEYS; i++) {
+            auto key = keyFor(i);
+            co_try$(store->put(bytesOf(key), VALUE));
+        }
+        report("put", KEYS, Sys::now() - start);
+
+        start = Sys::now();
+        co_try$(store->compact());
+        Sys::println("compact: {}", Sys::now() - start);
+
+        start = Sys::now();
+        for (usize i = 0; i < KEYS; i++) {
+            auto key = keyFor(i);
+            if (co_try$(store->get(bytesOf(key))))
+                found++;
+        }
+        report("get", KEYS, Sys::now() - start);
+
+        start = Sys::now();
+        for (usize i = 0; i < KEYS; i++) {
+            u64be key = KEYS + i;
+            if (co_try$(store->get(bytesOf(key))))
+                found++;
+        }
+        report("get (missing)", KEYS, Sys::now() - start);
+
+        start = Sys::now();
+        auto entries = store->scan();
+        while (auto entry = entries.next()) {
+            if (not *entry)
+                co_return entry->none();
+            scanned++;
+        }
+        report("scan", scanned, Sys::now() - start);
+
+        // NOTE: The writes above don't wait for the log, they have to be
+        //       on disk before the store is closed and opened again.
+        co_try$(store->flush());
+    }
+
+    auto start = Sys::now();
+    [[maybe_unused]] auto reopened = co_try$(Kv::Store::open(url));
+    Sys::println("reopen: {}", Sys::now() - start);
+
+    if (found != KEYS or scanned != KEYS)
+        co_return Error::other("store lost some keys");
+
+    co_return Ok();
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    co_trya$(benchWritesAsync("none", Kv::Durability::NONE));
+    co_trya$(benchWritesAsync("batch", Kv::Durability::BATCH));
+    co_trya$(benchWritesAsync("record", Kv::Durability::RECORD));
+    co_trya$(benchReadsAsync());
     co_return Ok();
 }
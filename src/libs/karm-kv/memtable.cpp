@@ -0,0 +1,120 @@
+module;
+
+#include <karm-base/array.h>
+#include <karm-base/iter.h>
+#include <karm-base/opt.h>
+
+export module Karm.Kv:memtable;
+
+import :blob;
+
+namespace Karm::Kv {
+
+// The sorted in-memory part of the store, a skip list so writes stay
+// cheap and it can be written out in key order when it gets too big.
+export struct Memtable : Meta::NoCopy {
+    static constexpr usize MAX_HEIGHT = 12;
+
+    struct Node {
+        Blob key;
+        Opt<Blob> value;
+        Array<Node*, MAX_HEIGHT> next = {};
+    };
+
+    using Links = Array<Node*, MAX_HEIGHT>;
+
+    Links _head = {};
+    usize _height = 1;
+    usize _len = 0;
+    usize _size = 0;
+    u64 _seed = 0x9e3779b97f4a7c15;
+
+    Memtable() = default;
+
+    ~Memtable() {
+        auto* node = _head[0];
+        while (node) {
+            auto* next = node->next[0];
+            delete node;
+            node = next;
+        }
+    }
+
+    usize len() const {
+        return _len;
+    }
+
+    // Approximate memory used by the entries.
+    usize size() const {
+        return _size;
+    }
+
+    usize _randomHeight() {
+        // xorshift64, each level is a quarter as likely as the one below
+        _seed ^= _seed << 13;
+        _seed ^= _seed >> 7;
+        _seed ^= _seed << 17;
+
+        usize height = 1;
+        u64 r = _seed;
+        while (height < MAX_HEIGHT and (r & 3) == 0) {
+            height++;
+            r >>= 2;
+        }
+        return height;
+    }
+
+    // Returns the first node with a key greater or equal to `key`, and
+    // the links pointing to it on each level in `prev` when provided.
+    Node* _seek(Bytes key, Array<Links*, MAX_HEIGHT>* prev = nullptr) {
+        Links* links = &_head;
+        for (usize level = _height; level-- > 0;) {
+            while ((*links)[level] and (*links)[level]->key.bytes() < key)
+                links = &(*links)[level]->next;
+            if (prev)
+                (*prev)[level] = links;
+        }
+        return (*links)[0];
+    }
+
+    void put(Blob key, Opt<Blob> value) {
+        Array<Links*, MAX_HEIGHT> prev;
+        auto* node = _seek(key.bytes(), &prev);
+
+        if (node and node->key == key) {
+            _size -= node->value ? node->value->len() : 0;
+            _size += value ? value->len() : 0;
+            node->value = value;
+            return;
+        }
+
+        usize height = _randomHeight();
+        for (usize level = _height; level < height; level++)
+            prev[level] = &_head;
+        _height = max(_height, height);
+
+        node = new Node{key, value};
+        for (usize level = 0; level < height; level++) {
+            node->next[level] = (*prev[level])[level];
+            (*prev[level])[level] = node;
+        }
+
+        _len++;
+        _size += sizeof(Node) + key.len() + (value ? value->len() : 0);
+    }
+
+    Opt<Entry> get(Bytes key) {
+        auto* node = _seek(key);
+        if (not node or node->key.bytes() != key)
+            return NONE;
+        return Entry{node->key, node->value};
+    }
+
+    // NOTE: The memtable must outlive the generator.
+    Generator<Entry> iter(Blob start) {
+        for (auto* node = _seek(start.bytes()); node; node = node->next[0])
+            co_yield Entry{node->key, node->value};
+    }
+};
+
+} // namespace Karm::Kv
@@ -1,5 +1,8 @@
 export module Karm.Kv;
 
 export import :blob;
+export import :bloom;
+export import :memtable;
 export import :store;
+export import :table;
 export import :wal;
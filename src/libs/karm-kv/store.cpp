@@ -1,43 +1,592 @@
 module;
 
+#include <karm-async/task.h>
 #include <karm-base/rc.h>
 #include <karm-crypto/crc32.h>
+#include <karm-io/bscan.h>
+#include <karm-io/fmt.h>
+#include <karm-io/impls.h>
 #include <karm-logger/logger.h>
+#include <karm-sys/async.h>
+#include <karm-sys/dir.h>
+#include <karm-sys/file.h>
+#include <karm-sys/mmap.h>
+#include <karm-sys/time.h>
 
 export module Karm.Kv:store;
 
 import :blob;
+import :memtable;
+import :table;
 import :wal;
 
 namespace Karm::Kv {
 
+// A store at `file:./db` lives in files sharing its name as a prefix:
+//
+//  - db.manifest-0 and db.manifest-1, the checkpoints,
+//  - db.<id>.wal, the log of the writes since the last checkpoint,
+//  - db.<id>.sst, the tables.
+
+static Mime::Url _path(Mime::Url const& url, Str suffix) {
+    return url.parent(1) / Io::format("{}.{}", url.basename(), suffix);
+}
+
+static Mime::Url _walPath(Mime::Url const& url, u64 id) {
+    return _path(url, Io::format("{}.wal", id));
+}
+
+static Mime::Url _tablePath(Mime::Url const& url, u64 id) {
+    return _path(url, Io::format("{}.sst", id));
+}
+
+// MARK: Manifest --------------------------------------------------------------
+
+// The tables making up each level and the log to replay on top of them.
+// Two slots are written in turn so a crash while writing one leaves the
+// previous checkpoint intact, opening picks the newest valid slot.
+struct Manifest {
+    static constexpr Array<u8, 8> MAGIC = {
+        'K', 'V', 'M', 'A', 'N', 'I', 'F', 0
+    };
+
+    u64 seq = 0;
+    u64 walId = 0;
+    u64 nextId = 1;
+    Vec<Vec<u64>> levels = {};
+
+    static Mime::Url _slot(Mime::Url const& url, u64 seq) {
+        return _path(url, Io::format("manifest-{}", seq % 2));
+    }
+
+    static Res<Manifest> _decode(Bytes bytes) {
+        if (bytes.len() < MAGIC.len() + 4)
+            return Error::invalidData("manifest too small");
+
+        auto body = sub(bytes, 0, bytes.len() - 4);
+        Io::BScan s{bytes};
+        if (s.nextBytes(MAGIC.len()) != MAGIC)
+            return Error::invalidData("invalid manifest file");
+
+        if (Crypto::crc32(body) != Io::BScan{sub(bytes, body.len(), bytes.len())}.nextU32le())
+            return Error::invalidData("invalid crc for manifest");
+
+        Manifest manifest;
+        s = Io::BScan{sub(body, MAGIC.len(), body.len())};
+        manifest.seq = s.nextU64le();
+        manifest.walId = s.nextU64le();
+        manifest.nextId = s.nextU64le();
+        usize nlevels = s.nextU32le();
+        for (usize i = 0; i < nlevels; i++) {
+            auto& level = manifest.levels.emplaceBack();
+            usize ntables = s.nextU32le();
+            for (usize j = 0; j < ntables; j++)
+                level.pushBack(s.nextU64le());
+        }
+
+        if (not s.ended())
+            return Error::invalidData("trailing data in manifest");
+
+        return Ok(manifest);
+    }
+
+    static Res<Manifest> _load(Mime::Url const& url) {
+        auto file = try$(Sys::File::open(url));
+        auto map = try$(Sys::mmap().map(file));
+        return _decode(map.bytes());
+    }
+
+    // Returns the newest checkpoint, or an empty store when there is none.
+    static Manifest load(Mime::Url const& url) {
+        Manifest best;
+        for (u64 slot = 0; slot < 2; slot++) {
+            auto manifest = _load(_slot(url, slot));
+            if (manifest and manifest.unwrap().seq >= best.seq)
+                best = manifest.take();
+        }
+        return best;
+    }
+
+    Res<> save(Mime::Url const& url) {
+        seq++;
+
+        Io::BufferWriter buf;
+        Io::BEmit e{buf};
+        e.writeBytes(MAGIC);
+        e.writeU64le(seq);
+        e.writeU64le(walId);
+        e.writeU64le(nextId);
+        e.writeU32le(levels.len());
+        for (auto& level : levels) {
+            e.writeU32le(level.len());
+            for (auto id : level)
+                e.writeU64le(id);
+        }
+        e.writeU32le(Crypto::crc32(buf.bytes()));
+
+        auto file = try$(Sys::File::create(_slot(url, seq)));
+        try$(file.write(buf.bytes()));
+        try$(file.flush());
+        return file.sync();
+    }
+};
+
+// MARK: Store -----------------------------------------------------------------
+
+// Operations on the storage the store relies on the order of.
+export enum struct StorageOp {
+    SYNC,
+    SYNC_DIR,
+    REMOVE,
+};
+
+// An ordered key-value store built as a log-structured merge tree.
+//
+// Writes go to the log and to the memtable, when the memtable is full it
+// is written out as a table in level 0 and a checkpoint starts a new log,
+// so opening a store only ever replays the writes since the last flush.
+//
+// Level 0 holds the flushed tables, which may overlap. Every level after
+// it is a single sorted table, `levelRatio` times bigger than the one
+// before, and compaction merges a level into the next one when it grows
+// past its budget.
 export struct Store {
+    struct Options {
+        // Size of the memtable before it is written out as a table.
+        usize memtableSize = 4 * 1024 * 1024;
+
+        // Number of tables in level 0 that calls for a compaction.
+        usize level0Tables = 4;
+
+        // Number of tables in level 0 past which writes wait for compaction.
+        usize level0Stall = 12;
+
+        // Size of level 1, each level after it gets `levelRatio` times more.
+        usize level1Size = 16 * 1024 * 1024;
+        usize levelRatio = 10;
+
+        // When writes are considered done, see Durability.
+        Durability durability = Durability::BATCH;
+    };
+
+    Mime::Url _url;
+    Options _options;
+    Manifest _manifest;
     Rc<Wal> _wal;
-    Map<Blob, Blob> _memdb;
+    Rc<Memtable> _memtable;
+    Vec<Vec<Rc<Table>>> _levels;
+
+    // Told about every sync and removal, in the order they happen.
+    Opt<Func<void(StorageOp, Mime::Url const&)>> _observer = NONE;
 
-    static Rc<Store> open(Rc<Wal> wal) {
-        auto db = makeRc<Store>(wal);
+    Opt<Weak<Store>> _self = NONE;
+    bool _compacting = false;
+
+    static Res<Rc<Store>> open(Mime::Url const& url) {
+        return open(url, {});
+    }
+
+    static Res<Rc<Store>> open(Mime::Url const& url, Options options) {
+        auto manifest = Manifest::load(url);
+        if (manifest.levels.len() == 0)
+            manifest.levels.emplaceBack();
+
+        Vec<Vec<Rc<Table>>> levels;
+        for (auto& ids : manifest.levels) {
+            auto& level = levels.emplaceBack();
+            for (auto id : ids)
+                level.pushBack(try$(Table::open(_tablePath(url, id), id)));
+        }
+
+        auto wal = try$(Wal::open(_walPath(url, manifest.walId), options.durability));
+        auto memtable = makeRc<Memtable>();
         for (Wal::Record const& r : wal->iter()) {
             if (r.type == Wal::PUT) {
-                db->_memdb.put(r.key, r.value);
+                memtable->put(r.key, r.value);
             } else if (r.type == Wal::DEL) {
-                db->_memdb.del(r.key);
+                memtable->put(r.key, NONE);
             }
         }
-        return db;
-    };
+        try$(wal->rewind());
+
+        auto store = makeRc<Store>(url, options, std::move(manifest), wal, memtable, std::move(levels));
+        store->_self = store;
+        try$(store->_maybeFlush());
+        return Ok(store);
+    }
+
+    // MARK: Reads -------------------------------------------------------------
+
+    Res<Opt<Blob>> get(Bytes key) {
+        if (auto entry = _memtable->get(key))
+            return Ok(entry->value);
+
+        // Newer tables shadow older ones, level 0 is kept oldest first.
+        for (usize i = _levels[0].len(); i-- > 0;) {
+            if (auto entry = try$(_levels[0][i]->get(key)))
+                return Ok(entry->value);
+        }
+
+        for (usize l = 1; l < _levels.len(); l++) {
+            for (auto& table : _levels[l]) {
+                if (auto entry = try$(table->get(key)))
+                    return Ok(entry->value);
+            }
+        }
+
+        return Ok(NONE);
+    }
+
+    // Tables from the newest to the oldest.
+    Vec<Rc<Table>> _tables() const {
+        Vec<Rc<Table>> tables;
+        for (usize i = _levels[0].len(); i-- > 0;)
+            tables.pushBack(_levels[0][i]);
+        for (usize l = 1; l < _levels.len(); l++)
+            for (auto& table : _levels[l])
+                tables.pushBack(table);
+        return tables;
+    }
+
+    static Generator<Res<Entry>> _iter(Rc<Memtable> memtable, Blob start) {
+        auto entries = memtable->iter(start);
+        while (auto entry = entries.next())
+            co_yield Ok(entry.take());
+    }
+
+    // Merge sorted sources into one, when several of them have the same
+    // key the one that comes first wins. The first error from any of the
+    // sources is yielded and ends the merge.
+    static Generator<Res<Entry>> _merge(Vec<Generator<Res<Entry>>> sources) {
+        Vec<Opt<Entry>> heads;
+        heads.resize(sources.len());
+
+        auto pull = [&](usize i) -> Res<> {
+            heads[i] = NONE;
+            if (auto next = sources[i].next())
+                heads[i] = try$(next.take());
+            return Ok();
+        };
+
+        for (usize i = 0; i < sources.len(); i++) {
+            if (auto res = pull(i); not res) {
+                co_yield res.none();
+                co_return;
+            }
+        }
+
+        while (true) {
+            Opt<usize> min = NONE;
+            for (usize i = 0; i < heads.len(); i++) {
+                if (heads[i] and (not min or heads[i]->key < heads[*min]->key))
+                    min = i;
+            }
+
+            if (not min)
+                co_return;
+
+            auto entry = heads[*min].take();
+            for (usize i = 0; i < heads.len(); i++) {
+                if (i != *min and not(heads[i] and heads[i]->key == entry.key))
+                    continue;
+                if (auto res = pull(i); not res) {
+                    co_yield res.none();
+                    co_return;
+                }
+            }
+
+            co_yield Ok(entry);
+        }
+    }
+
+    static Generator<Res<Pair<Blob>>> _scan(Blob start, Blob end, Rc<Memtable> memtable, Vec<Rc<Table>> tables) {
+        Vec<Generator<Res<Entry>>> sources;
+        sources.pushBack(_iter(memtable, start));
+        for (auto& table : tables)
+            sources.pushBack(table->iter(start));
+
+        auto merged = _merge(std::move(sources));
+        while (auto next = merged.next()) {
+            if (not *next) {
+                co_yield next->none();
+                co_return;
+            }
+
+            auto& entry = next->unwrap();
+            if (end.len() and entry.key >= end)
+                co_return;
+            if (entry.value)
+                co_yield Ok(Pair<Blob>{entry.key, entry.value.unwrap()});
+        }
+    }
+
+    // Live entries with a key in [start, end) in order, an empty end means
+    // until the last key. The scan sees the store as it was when it started,
+    // a table that can't be read is yielded as an error and ends the scan.
+    Generator<Res<Pair<Blob>>> scan(Bytes start = {}, Bytes end = {}) {
+        return _scan(Blob::from(start), Blob::from(end), _memtable, _tables());
+    }
+
+    // MARK: Writes ------------------------------------------------------------
 
     Res<> put(Bytes key, Bytes value) {
         try$(_wal->record(Wal::PUT, key, value));
-        _memdb.put(Blob::from(key), Blob::from(value));
-        return Ok();
+        _memtable->put(Blob::from(key), Blob::from(value));
+        return _maybeFlush();
     }
 
     Res<> del(Bytes key) {
         try$(_wal->record(Wal::DEL, key, {}));
-        _memdb.del(Blob::from(key));
+        _memtable->put(Blob::from(key), NONE);
+        return _maybeFlush();
+    }
+
+    // A flush that happened while a write waited for its batch has let go
+    // of the log the write went to, it's recorded again in the current
+    // one so it's not lost along with it.
+    Res<> _relog(Rc<Wal> const& wal, Wal::Record::Type type, Bytes key, Bytes value) {
+        if (wal._cell == _wal._cell)
+            return Ok();
+        return _wal->record(type, key, value);
+    }
+
+    // NOTE: The key and value must stay alive until the task completes.
+    Async::Task<> putAsync(Bytes key, Bytes value) {
+        // The write is only applied once it's durable, the log is held on
+        // to since a flush can swap it out in the meantime.
+        auto wal = _wal;
+        co_trya$(wal->recordAsync(Wal::PUT, key, value));
+        co_try$(_relog(wal, Wal::PUT, key, value));
+        _memtable->put(Blob::from(key), Blob::from(value));
+        co_try$(_maybeFlush());
+        _scheduleCompaction();
+        co_return Ok();
+    }
+
+    // NOTE: The key must stay alive until the task completes.
+    Async::Task<> delAsync(Bytes key) {
+        auto wal = _wal;
+        co_trya$(wal->recordAsync(Wal::DEL, key, {}));
+        co_try$(_relog(wal, Wal::DEL, key, {}));
+        _memtable->put(Blob::from(key), NONE);
+        co_try$(_maybeFlush());
+        _scheduleCompaction();
+        co_return Ok();
+    }
+
+    Res<> _maybeFlush() {
+        if (_memtable->size() < _options.memtableSize)
+            return Ok();
+
+        try$(flush());
+
+        // Compaction runs in the background for async writers, but when
+        // it can't keep up (or nothing schedules it) writes have to wait.
+        if (_levels[0].len() >= _options.level0Stall)
+            try$(compact());
+
         return Ok();
     }
+
+    void _observe(StorageOp op, Mime::Url const& url) {
+        if (_observer)
+            (*_observer)(op, url);
+    }
+
+    // The table and the manifest slot were synced as they were written,
+    // make their directory entries durable too. Only then can the files
+    // they replace be removed, otherwise a power loss could leave the
+    // checkpoint pointing at missing files.
+    Res<> _commitCheckpoint(Mime::Url const& table) {
+        _observe(StorageOp::SYNC, table);
+        _observe(StorageOp::SYNC, Manifest::_slot(_url, _manifest.seq));
+
+        auto dir = _url.parent(1);
+        try$(Sys::Dir::sync(dir));
+        _observe(StorageOp::SYNC_DIR, dir);
+        return Ok();
+    }
+
+    void _removeFile(Mime::Url const& url) {
+        auto res = Sys::File::remove(url);
+        if (not res)
+            logWarn("kv: could not remove {}: {}", url, res.none());
+        _observe(StorageOp::REMOVE, url);
+    }
+
+    // Write the memtable out as a table and checkpoint the store.
+    Res<> flush() {
+        // Writers waiting on the log are let go, see _relog().
+        try$(_wal->commit());
+
+        if (_memtable->len() == 0)
+            return Ok();
+
+        u64 tableId = _manifest.nextId++;
+        auto writer = try$(TableWriter::create(_tablePath(_url, tableId)));
+        auto entries = _memtable->iter(Blob::from({}));
+        while (auto entry = entries.next())
+            try$(writer.add(entry->key.bytes(), entry->value.map([](auto& v) { return v.bytes(); })));
+        try$(writer.finish());
+        auto table = try$(Table::open(_tablePath(_url, tableId), tableId));
+
+        u64 walId = _manifest.nextId++;
+        auto wal = try$(Wal::create(_walPath(_url, walId), _options.durability));
+
+        u64 oldWalId = std::exchange(_manifest.walId, walId);
+        _manifest.levels[0].pushBack(tableId);
+        try$(_manifest.save(_url));
+        try$(_commitCheckpoint(_tablePath(_url, tableId)));
+
+        _levels[0].pushBack(table);
+        _wal = wal;
+        _memtable = makeRc<Memtable>();
+        _removeFile(_walPath(_url, oldWalId));
+
+        return Ok();
+    }
+
+    // MARK: Compaction --------------------------------------------------------
+
+    usize _levelSize(usize l) const {
+        usize size = 0;
+        for (auto& table : _levels[l])
+            size += table->size();
+        return size;
+    }
+
+    // The level that is the most in need of being merged into the next one.
+    Opt<usize> _pickCompaction() const {
+        if (_levels[0].len() >= _options.level0Tables)
+            return 0;
+
+        usize budget = _options.level1Size;
+        for (usize l = 1; l < _levels.len(); l++) {
+            if (_levelSize(l) > budget)
+                return l;
+            budget *= _options.levelRatio;
+        }
+
+        return NONE;
+    }
+
+    static Res<> _writeMerged(TableWriter& writer, Vec<Generator<Res<Entry>>> sources, bool dropTombstones) {
+        auto merged = _merge(std::move(sources));
+        while (auto next = merged.next()) {
+            auto entry = try$(next.take());
+            if (dropTombstones and not entry.value)
+                continue;
+            try$(writer.add(entry.key.bytes(), entry.value.map([](auto& v) { return v.bytes(); })));
+        }
+        try$(writer.finish());
+        return Ok();
+    }
+
+    // Merge level `l` into level `l + 1`.
+    Res<> _compactLevel(usize l) {
+        if (l + 1 == _levels.len()) {
+            _levels.emplaceBack();
+            _manifest.levels.emplaceBack();
+        }
+
+        Vec<Rc<Table>> inputs;
+        for (usize i = _levels[l].len(); i-- > 0;)
+            inputs.pushBack(_levels[l][i]);
+        for (auto& table : _levels[l + 1])
+            inputs.pushBack(table);
+
+        // Nothing older is left to shadow at the last level.
+        bool last = l + 2 == _levels.len();
+
+        Vec<Generator<Res<Entry>>> sources;
+        for (auto& table : inputs)
+            sources.pushBack(table->iter(Blob::from({})));
+
+        u64 tableId = _manifest.nextId++;
+        auto writer = try$(TableWriter::create(_tablePath(_url, tableId)));
+
+        // A corrupted input aborts the compaction before anything is
+        // checkpointed, the inputs stay where they are and only the
+        // partial output goes away.
+        if (auto res = _writeMerged(writer, std::move(sources), last); not res) {
+            _removeFile(_tablePath(_url, tableId));
+            return res.none();
+        }
+
+        Vec<Rc<Table>> output;
+        if (writer.len())
+            output.pushBack(try$(Table::open(_tablePath(_url, tableId), tableId)));
+
+        _manifest.levels[l].clear();
+        _manifest.levels[l + 1].clear();
+        for (auto& table : output)
+            _manifest.levels[l + 1].pushBack(table->id());
+        try$(_manifest.save(_url));
+        try$(_commitCheckpoint(_tablePath(_url, tableId)));
+
+        _levels[l].clear();
+        _levels[l + 1] = output;
+
+        if (not writer.len())
+            _removeFile(_tablePath(_url, tableId));
+
+        // NOTE: Scans still holding on to the inputs keep their mappings.
+        for (auto& table : inputs)
+            _removeFile(_tablePath(_url, table->id()));
+
+        return Ok();
+    }
+
+    // Compact until every level is within its budget.
+    Res<> compact() {
+        while (auto l = _pickCompaction())
+            try$(_compactLevel(*l));
+        return Ok();
+    }
+
+    // Same as compact(), but gives the scheduler a chance to run other
+    // tasks before each merge. The task only holds on to the store while
+    // it merges, dropping the store ends it.
+    static Async::Task<> _compactAsync(Weak<Store> self) {
+        while (true) {
+            co_trya$(Sys::globalSched().sleepAsync(Sys::instant()));
+
+            {
+                auto store = self.upgrade();
+                if (not store)
+                    co_return Ok();
+
+                auto& s = store->unwrap();
+                auto l = s._pickCompaction();
+                if (not l) {
+                    s._compacting = false;
+                    co_return Ok();
+                }
+
+                if (auto res = s._compactLevel(*l); not res) {
+                    s._compacting = false;
+                    co_return res;
+                }
+            }
+        }
+    }
+
+    // Start compacting in the background after a flush left a level over
+    // its budget, unless it's already running.
+    void _scheduleCompaction() {
+        if (_compacting or not _self or not _pickCompaction())
+            return;
+
+        auto self = _self->upgrade();
+        if (not self)
+            return;
+
+        _compacting = true;
+        Async::detach(_compactAsync(self.unwrap()), [](Res<> res) {
+            if (not res)
+                logError("kv: compaction failed: {}", res.none());
+        });
+    }
 };
 
 } // namespace Karm::Kv
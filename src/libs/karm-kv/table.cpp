@@ -0,0 +1,308 @@
+module;
+
+#include <karm-crypto/crc32.h>
+#include <karm-io/bscan.h>
+#include <karm-io/impls.h>
+#include <karm-sys/file.h>
+#include <karm-sys/mmap.h>
+
+export module Karm.Kv:table;
+
+import :blob;
+import :bloom;
+
+namespace Karm::Kv {
+
+// Tables are immutable sorted files written when the memtable is flushed
+// or when tables are compacted together. They are laid out as:
+//
+//  - data blocks of about BLOCK_SIZE bytes, each followed by its crc32,
+//  - a sparse index with the last key, offset and length of each block,
+//  - a bloom filter over all the keys,
+//  - a fixed size footer locating the index and the filter.
+//
+// Readers map the file and only ever touch the blocks they need.
+
+enum struct EntryType : u8 {
+    PUT,
+    DEL,
+};
+
+struct [[gnu::packed]] RawFooter {
+    static constexpr Array<u8, 8> MAGIC = {
+        'K', 'V', 'T', 'A', 'B', 'L', 'E', 0
+    };
+
+    Le<u64> indexOffset;
+    Le<u64> indexLen;
+    Le<u64> bloomLen;
+    Le<u64> count;
+    Le<u32> crc;
+    Array<u8, 8> magic;
+};
+
+export struct TableWriter : Meta::NoCopy {
+    static constexpr usize BLOCK_SIZE = 4096;
+
+    Sys::FileWriter _file;
+    Io::BufferWriter _block{BLOCK_SIZE * 2};
+    Io::BufferWriter _index;
+    Vec<u64> _hashes;
+    Opt<Blob> _lastKey = NONE;
+    u64 _offset = 0;
+    u64 _count = 0;
+
+    static Res<TableWriter> create(Mime::Url const& url) {
+        return Ok(TableWriter{try$(Sys::File::create(url))});
+    }
+
+    TableWriter(Sys::FileWriter file)
+        : _file(std::move(file)) {}
+
+    TableWriter(TableWriter&&) = default;
+
+    usize len() const {
+        return _count;
+    }
+
+    // NOTE: Keys must be added in strictly increasing order.
+    Res<> add(Bytes key, Opt<Bytes> value) {
+        Io::BEmit e{_block};
+        e.writeU8le(toUnderlyingType(value ? EntryType::PUT : EntryType::DEL));
+        e.writeU32le(key.len());
+        e.writeU32le(value ? value->len() : 0);
+        e.writeBytes(key);
+        if (value)
+            e.writeBytes(*value);
+
+        _hashes.pushBack(hashKey(key));
+        _lastKey = Blob::from(key);
+        _count++;
+
+        if (_block.bytes().len() >= BLOCK_SIZE)
+            try$(_flushBlock());
+
+        return Ok();
+    }
+
+    Res<> _flushBlock() {
+        if (not _block.bytes().len())
+            return Ok();
+
+        Io::BEmit{_block}.writeU32le(Crypto::crc32(_block.bytes()));
+        try$(_file.write(_block.bytes()));
+
+        Io::BEmit e{_index};
+        auto lastKey = _lastKey->bytes();
+        e.writeU32le(lastKey.len());
+        e.writeBytes(lastKey);
+        e.writeU64le(_offset);
+        e.writeU32le(_block.bytes().len());
+
+        _offset += _block.bytes().len();
+        _block.clear();
+        return Ok();
+    }
+
+    // Write the index, the filter and the footer and sync the table,
+    // returns its size.
+    Res<usize> finish() {
+        try$(_flushBlock());
+
+        auto bloom = Bloom::build(_hashes);
+
+        RawFooter footer = {};
+        footer.indexOffset = _offset;
+        footer.indexLen = _index.bytes().len();
+        footer.bloomLen = bloom.len();
+        footer.count = _count;
+
+        Crypto::Crc32 crc;
+        crc.update(_index.bytes());
+        crc.update(bloom);
+        footer.crc = crc.digest();
+        footer.magic = RawFooter::MAGIC;
+
+        try$(_file.write(_index.bytes()));
+        try$(_file.write(bloom));
+        try$(_file.write({reinterpret_cast<u8 const*>(&footer), sizeof(footer)}));
+        try$(_file.flush());
+        try$(_file.sync());
+
+        return Ok(_offset + _index.bytes().len() + bloom.len() + sizeof(footer));
+    }
+};
+
+export struct Table {
+    struct Block {
+        Bytes lastKey;
+        u64 offset;
+        u32 len;
+    };
+
+    u64 _id;
+    Sys::Mmap _map;
+    Vec<Block> _index;
+    Bloom _bloom;
+    u64 _count;
+
+    static Res<Rc<Table>> open(Mime::Url const& url, u64 id) {
+        auto file = try$(Sys::File::open(url));
+        auto map = try$(Sys::mmap().map(file));
+        auto bytes = map.bytes();
+
+        if (bytes.len() < sizeof(RawFooter))
+            return Error::invalidData("table too small");
+
+        RawFooter footer;
+        copy(sub(bytes, bytes.len() - sizeof(RawFooter), bytes.len()), MutBytes{reinterpret_cast<u8*>(&footer), sizeof(footer)});
+        if (footer.magic != RawFooter::MAGIC)
+            return Error::invalidData("invalid table file");
+
+        usize end = footer.indexOffset + footer.indexLen + footer.bloomLen;
+        if (end + sizeof(RawFooter) != bytes.len())
+            return Error::invalidData("invalid table footer");
+
+        auto meta = sub(bytes, footer.indexOffset, end);
+        if (Crypto::crc32(meta) != footer.crc)
+            return Error::invalidData("invalid crc for table index");
+
+        Vec<Block> index;
+        Io::BScan s{sub(meta, 0, footer.indexLen)};
+        while (not s.ended()) {
+            if (s.rem() < 4)
+                return Error::invalidData("truncated table index");
+            auto lastKey = s.nextBytes(s.nextU32le());
+            if (s.rem() < 12)
+                return Error::invalidData("truncated table index");
+            u64 offset = s.nextU64le();
+            u32 len = s.nextU32le();
+            if (offset + len > footer.indexOffset)
+                return Error::invalidData("table block out of bounds");
+            index.pushBack({lastKey, offset, len});
+        }
+
+        Bloom bloom{sub(meta, footer.indexLen, meta.len())};
+        return Ok(makeRc<Table>(id, std::move(map), std::move(index), bloom, footer.count));
+    }
+
+    u64 id() const {
+        return _id;
+    }
+
+    usize len() const {
+        return _count;
+    }
+
+    usize size() const {
+        return _map.bytes().len();
+    }
+
+    // Index of the first block that may contain keys greater or equal to `key`.
+    usize _lowerBound(Bytes key) const {
+        usize lo = 0, hi = _index.len();
+        while (lo < hi) {
+            usize mid = lo + (hi - lo) / 2;
+            if (_index[mid].lastKey < key)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    // NOTE: Checking the crc costs more than the lookup itself, so point
+    //       reads skip it and rely on the bounds checks of the parser,
+    //       scans and compactions always verify it.
+    Res<Bytes> _block(usize i, bool verify) const {
+        auto const& b = _index[i];
+        auto bytes = sub(_map.bytes(), b.offset, b.offset + b.len);
+        if (bytes.len() < 4)
+            return Error::invalidData("truncated table block");
+
+        auto data = sub(bytes, 0, bytes.len() - 4);
+        if (not verify)
+            return Ok(data);
+
+        u32 crc = Io::BScan{sub(bytes, data.len(), bytes.len())}.nextU32le();
+        if (Crypto::crc32(data) != crc)
+            return Error::invalidData("invalid crc for table block");
+        return Ok(data);
+    }
+
+    static Res<Entry> _next(Io::BScan& s) {
+        if (s.rem() < 9)
+            return Error::invalidData("truncated table entry");
+
+        auto type = EntryType{s.nextU8le()};
+        usize keylen = s.nextU32le();
+        usize vallen = s.nextU32le();
+        if (s.rem() < keylen + vallen)
+            return Error::invalidData("truncated table entry");
+
+        auto key = Blob::from(s.nextBytes(keylen));
+        auto value = s.nextBytes(vallen);
+        if (type == EntryType::DEL)
+            return Ok(Entry{key, NONE});
+        return Ok(Entry{key, Blob::from(value)});
+    }
+
+    // Returns the entry for `key` if the table has one, it might be a tombstone.
+    Res<Opt<Entry>> get(Bytes key) const {
+        if (not _bloom.mayContain(hashKey(key)))
+            return Ok(NONE);
+
+        usize i = _lowerBound(key);
+        if (i == _index.len())
+            return Ok(NONE);
+
+        Io::BScan s{try$(_block(i, false))};
+        while (not s.ended()) {
+            // Skip over the values of the entries before the key without copying them.
+            if (s.rem() < 9)
+                return Error::invalidData("truncated table entry");
+            auto peek = s;
+            peek.skip(1);
+            usize keylen = peek.nextU32le();
+            usize vallen = peek.nextU32le();
+            if (peek.rem() < keylen + vallen)
+                return Error::invalidData("truncated table entry");
+
+            auto k = peek.nextBytes(keylen);
+            if (k == key)
+                return Ok(try$(_next(s)));
+            if (k > key)
+                return Ok(NONE);
+            s = peek.skip(vallen);
+        }
+
+        return Ok(NONE);
+    }
+
+    // Entries with a key greater or equal to `start` in order. A corrupted
+    // or truncated block is yielded as an error and ends the iteration.
+    // NOTE: The table must outlive the generator.
+    Generator<Res<Entry>> iter(Blob start) const {
+        for (usize i = _lowerBound(start.bytes()); i < _index.len(); i++) {
+            auto block = _block(i, true);
+            if (not block) {
+                co_yield block.none();
+                co_return;
+            }
+
+            Io::BScan s{block.unwrap()};
+            while (not s.ended()) {
+                auto entry = _next(s);
+                if (not entry) {
+                    co_yield entry.none();
+                    co_return;
+                }
+                if (entry.unwrap().key < start)
+                    continue;
+                co_yield Ok(entry.take());
+            }
+        }
+    }
+};
+
+} // namespace Karm::Kv
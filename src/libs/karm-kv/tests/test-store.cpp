@@ -0,0 +1,232 @@
+#include <karm-sys/dir.h>
+#include <karm-sys/file.h>
+#include <karm-test/macros.h>
+
+import Karm.Kv;
+
+namespace Karm::Kv::Tests {
+
+static constexpr Str STORE = "karm-kv-test-store";
+
+static Mime::Url _url() {
+    return "file:/tmp"_url / STORE;
+}
+
+static void _cleanup() {
+    auto dir = Sys::Dir::open("file:/tmp"_url);
+    if (not dir)
+        return;
+    for (auto& entry : dir.unwrap().entries()) {
+        if (startWith(entry.name, STORE) == Match::PARTIAL)
+            (void)Sys::File::remove("file:/tmp"_url / entry.name);
+    }
+}
+
+static Res<bool> _has(Store& store, Str key, Str value) {
+    auto got = try$(store.get(key.bytes()));
+    return Ok(got and got->bytes() == value.bytes());
+}
+
+static Res<bool> _missing(Store& store, Str key) {
+    auto got = try$(store.get(key.bytes()));
+    return Ok(not got);
+}
+
+test$("kv-store-put-get-del") {
+    _cleanup();
+
+    auto store = try$(Store::open(_url()));
+    try$(store->put("a"s.bytes(), "1"s.bytes()));
+    try$(store->put("b"s.bytes(), "2"s.bytes()));
+    try$(store->put("a"s.bytes(), "3"s.bytes()));
+    expect$(try$(_has(*store, "a", "3")));
+    expect$(try$(_has(*store, "b", "2")));
+    expect$(try$(_missing(*store, "c")));
+
+    // The tombstone has to shadow the value once it's in a table too.
+    try$(store->flush());
+    try$(store->del("a"s.bytes()));
+    expect$(try$(_missing(*store, "a")));
+    try$(store->flush());
+    expect$(try$(_missing(*store, "a")));
+    expect$(try$(_has(*store, "b", "2")));
+
+    _cleanup();
+    return Ok();
+}
+
+test$("kv-store-scan") {
+    _cleanup();
+
+    auto store = try$(Store::open(_url()));
+    try$(store->put("a"s.bytes(), "1"s.bytes()));
+    try$(store->put("c"s.bytes(), "3"s.bytes()));
+    try$(store->put("d"s.bytes(), "4"s.bytes()));
+    try$(store->flush());
+    try$(store->put("b"s.bytes(), "2"s.bytes()));
+    try$(store->put("c"s.bytes(), "5"s.bytes()));
+    try$(store->del("d"s.bytes()));
+    try$(store->put("e"s.bytes(), "6"s.bytes()));
+
+    Vec<Pair<Blob>> seen;
+    auto entries = store->scan("b"s.bytes(), "e"s.bytes());
+    while (auto entry = entries.next())
+        seen.pushBack(try$(entry.take()));
+
+    expectEq$(seen.len(), 2uz);
+    expect$(seen[0].v0.bytes() == "b"s.bytes() and seen[0].v1.bytes() == "2"s.bytes());
+    expect$(seen[1].v0.bytes() == "c"s.bytes() and seen[1].v1.bytes() == "5"s.bytes());
+
+    _cleanup();
+    return Ok();
+}
+
+test$("kv-store-reopen") {
+    _cleanup();
+
+    {
+        auto store = try$(Store::open(_url()));
+        try$(store->put("a"s.bytes(), "1"s.bytes()));
+        try$(store->put("b"s.bytes(), "2"s.bytes()));
+        try$(store->flush());
+
+        // Only in the wal.
+        try$(store->put("c"s.bytes(), "3"s.bytes()));
+        try$(store->del("a"s.bytes()));
+    }
+
+    auto store = try$(Store::open(_url()));
+    expect$(try$(_missing(*store, "a")));
+    expect$(try$(_has(*store, "b", "2")));
+    expect$(try$(_has(*store, "c", "3")));
+
+    _cleanup();
+    return Ok();
+}
+
+test$("kv-store-compaction") {
+    _cleanup();
+
+    auto store = try$(Store::open(
+        _url(),
+        {
+            .level0Tables = 2,
+        }
+    ));
+
+    try$(store->put("a"s.bytes(), "1"s.bytes()));
+    try$(store->put("b"s.bytes(), "2"s.bytes()));
+    try$(store->flush());
+    try$(store->put("a"s.bytes(), "3"s.bytes()));
+    try$(store->del("b"s.bytes()));
+    try$(store->flush());
+    try$(store->compact());
+
+    expectEq$(store->_levels[0].len(), 0uz);
+    expect$(try$(_has(*store, "a", "3")));
+    expect$(try$(_missing(*store, "b")));
+
+    // Nothing is left for the tombstone to shadow at the last level.
+    usize entries = 0;
+    for (auto& level : store->_levels) {
+        for (auto& table : level) {
+            auto it = table->iter(Blob::from({}));
+            while (auto entry = it.next()) {
+                expect$(try$(entry.take()).value.has());
+                entries++;
+            }
+        }
+    }
+    expectEq$(entries, 1uz);
+
+    _cleanup();
+    return Ok();
+}
+
+test$("kv-store-torn-wal") {
+    _cleanup();
+
+    Mime::Url wal;
+    {
+        auto store = try$(Store::open(_url()));
+        try$(store->put("a"s.bytes(), "1"s.bytes()));
+        try$(store->put("b"s.bytes(), "2"s.bytes()));
+        wal = "file:/tmp"_url / Io::format("{}.{}.wal", STORE, store->_manifest.walId);
+    }
+
+    // What a crash in the middle of a write leaves behind.
+    usize good = try$(Sys::stat(wal)).size;
+    {
+        auto file = try$(Sys::File::openOrCreate(wal));
+        try$(file.seek(Io::Seek::fromEnd(0)));
+        Array<u8, 7> torn = {0xff, 0xff, 0xff, 0xff, 0x01, 0x02, 0x03};
+        try$(file.write(bytes(torn)));
+    }
+
+    {
+        auto store = try$(Store::open(_url()));
+        expect$(try$(_has(*store, "a", "1")));
+        expect$(try$(_has(*store, "b", "2")));
+        expectEq$(try$(Sys::stat(wal)).size, good);
+
+        try$(store->put("c"s.bytes(), "3"s.bytes()));
+    }
+
+    auto store = try$(Store::open(_url()));
+    expect$(try$(_has(*store, "a", "1")));
+    expect$(try$(_has(*store, "c", "3")));
+
+    _cleanup();
+    return Ok();
+}
+
+test$("kv-store-removes-after-sync") {
+    _cleanup();
+
+    auto store = try$(Store::open(
+        _url(),
+        {
+            .memtableSize = 64,
+            .level0Tables = 2,
+        }
+    ));
+
+    Vec<StorageOp> ops;
+    store->_observer = [&](StorageOp op, Mime::Url const&) {
+        ops.pushBack(op);
+    };
+
+    for (usize i = 0; i < 64; i++) {
+        auto key = Io::format("key-{}", 100 + i);
+        try$(store->put(key.bytes(), key.bytes()));
+    }
+    try$(store->flush());
+    try$(store->compact());
+
+    // Every removal must come after a directory sync that covers
+    // everything synced before it.
+    bool pending = false;
+    bool removed = false;
+    bool durable = false;
+    for (auto op : ops) {
+        if (op == StorageOp::SYNC) {
+            pending = true;
+        } else if (op == StorageOp::SYNC_DIR) {
+            pending = false;
+            durable = true;
+        } else {
+            expect$(durable and not pending);
+            removed = true;
+        }
+    }
+    expect$(removed);
+
+    store = try$(Store::open(_url()));
+    auto value = try$(store->get("key-142"s.bytes()));
+    expect$(value and value->bytes() == "key-142"s.bytes());
+
+    _cleanup();
+    return Ok();
+}
+
+} // namespace Karm::Kv::Tests
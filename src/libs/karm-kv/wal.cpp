@@ -1,8 +1,15 @@
 module;
 
+#include <karm-async/promise.h>
+#include <karm-async/task.h>
 #include <karm-crypto/crc32.h>
+#include <karm-io/bscan.h>
+#include <karm-io/impls.h>
 #include <karm-logger/logger.h>
+#include <karm-sys/async.h>
 #include <karm-sys/file.h>
+#include <karm-sys/mmap.h>
+#include <karm-sys/time.h>
 
 export module Karm.Kv:wal;
 
@@ -10,7 +17,22 @@ import :blob;
 
 namespace Karm::Kv {
 
+export enum struct Durability : u8 {
+    // Records are buffered and written out in large chunks, nothing is
+    // ever synced, a crash loses the writes the system didn't get to.
+    NONE,
+
+    // A write completes once its record is synced, concurrent async
+    // writers are grouped so they share a single write and sync.
+    BATCH,
+
+    // Every record is written and synced on its own.
+    RECORD,
+};
+
 export struct Wal {
+    static constexpr usize BUFFER_SIZE = 64 * 1024;
+
     struct Record {
         enum struct Type : u8 {
             PUT,
@@ -74,27 +96,46 @@ export struct Wal {
 
     Sys::File _file;
     RawHeader _header;
-    using enum Record::Type;
+    usize _end;
+    Durability _durability;
 
-    static Res<Rc<Wal>> open(Mime::Url const& url) {
-        if (Sys::isFile(url)) {
-            auto file = try$(Sys::File::openOrCreate(url));
-            RawHeader header;
-            try$(file.read(header.mutBytes()));
-            if (header.magic != RawHeader::MAGIC)
-                return Error::invalidData("invalid wal file");
+    // Encoded records waiting to be written, and the writers waiting on them.
+    Io::BufferWriter _pending{BUFFER_SIZE};
+    Opt<Async::Promise<>> _batch = NONE;
+    bool _committing = false;
 
-            try$(file.seek(Io::Seek::fromEnd(0)));
-            return Ok(makeRc<Wal>(std::move(file), header));
-        }
+    using enum Record::Type;
 
+    static Res<Rc<Wal>> open(Mime::Url const& url, Durability durability = Durability::BATCH) {
         auto file = try$(Sys::File::openOrCreate(url));
         RawHeader header = {RawHeader::MAGIC};
-        try$(file.write(header.bytes()));
-        return Ok(makeRc<Wal>(std::move(file)));
+
+        if (try$(file.stat()).size == 0) {
+            try$(file.write(header.bytes()));
+            return Ok(makeRc<Wal>(std::move(file), header, sizeof(RawHeader), durability));
+        }
+
+        try$(file.read(header.mutBytes()));
+        if (header.magic != RawHeader::MAGIC)
+            return Error::invalidData("invalid wal file");
+
+        usize end = try$(file.seek(Io::Seek::fromEnd(0)));
+        return Ok(makeRc<Wal>(std::move(file), header, end, durability));
     }
 
-    Res<> record(Record::Type type, Bytes key, Bytes value) {
+    // Start an empty log, replacing any file left at `url`.
+    static Res<Rc<Wal>> create(Mime::Url const& url, Durability durability = Durability::BATCH) {
+        try$(Sys::File::create(url));
+        return open(url, durability);
+    }
+
+    ~Wal() {
+        auto res = commit();
+        if (not res)
+            logError("kv: could not write the end of the wal: {}", res.none());
+    }
+
+    void _encode(Record::Type type, Bytes key, Bytes value) {
         RawRecord record = {};
         record.type = type;
         record.keylen = key.len();
@@ -103,56 +144,129 @@ export struct Wal {
         record.crc = 0;
         record.crc = Crypto::crc32(record.bytes());
 
-        try$(_file.write(record.bytes()));
-
-        try$(_file.write(key));
-        try$(_file.write(value));
-
         Crypto::Crc32 crc = {};
         crc.update(key);
         crc.update(value);
-        try$(_file.write({reinterpret_cast<u8 const*>(&crc), sizeof(crc)}));
+
+        Io::BEmit e{_pending};
+        e.writeBytes(record.bytes());
+        e.writeBytes(key);
+        e.writeBytes(value);
+        e.writeU32le(crc.digest());
+    }
+
+    // Write out the pending records, sync them unless durability
+    // is NONE, and let the writers waiting on them know.
+    Res<> commit() {
+        auto res = _commit();
+        if (_batch)
+            _batch.take().resolve(res);
+        return res;
+    }
+
+    Res<> _commit() {
+        auto bytes = _pending.bytes();
+        if (not bytes.len())
+            return Ok();
+
+        while (bytes.len()) {
+            usize written = try$(_file.write(bytes));
+            if (written == 0)
+                return Error::writeZero();
+            bytes = next(bytes, written);
+            _end += written;
+        }
+        _pending.clear();
+
+        if (_durability != Durability::NONE)
+            try$(_file.sync());
 
         return Ok();
     }
 
+    Res<> record(Record::Type type, Bytes key, Bytes value) {
+        _encode(type, key, value);
+        if (_durability == Durability::NONE and _pending.bytes().len() < BUFFER_SIZE)
+            return Ok();
+        return commit();
+    }
+
+    // Same as record(), but in BATCH mode the records of all the writers
+    // that show up while a batch is being put together are committed at once.
+    // NOTE: The key and value must stay alive until the task completes.
+    Async::Task<> recordAsync(Record::Type type, Bytes key, Bytes value) {
+        if (_durability != Durability::BATCH)
+            co_return record(type, key, value);
+
+        _encode(type, key, value);
+        if (not _batch)
+            _batch.emplace();
+        auto future = _batch->future();
+
+        if (not _committing) {
+            // The first writer of a batch commits it, but lets the other
+            // writers that are ready to run add their records first.
+            _committing = true;
+            auto res = co_await Sys::globalSched().sleepAsync(Sys::instant());
+            _committing = false;
+            if (not res)
+                logWarn("kv: could not wait for the batch to fill: {}", res.none());
+            (void)commit();
+        }
+
+        co_return co_await future;
+    }
+
+    // Records of the log up to the first torn or corrupted one, which is
+    // what a crash in the middle of a write leaves behind. `_end` is moved
+    // back to the end of the last good record so rewind() can cut the rest.
     Generator<Record> iter() {
-        // FIXME: Handle errors properly
-        _file.seek(Io::Seek::fromBegin(sizeof(RawHeader))).unwrap("could not seek");
+        auto map = Sys::mmap().map(_file);
+        if (not map) {
+            logError("kv: could not map wal: {}", map.none());
+            co_return;
+        }
 
-        while (true) {
-            RawRecord record;
-            auto res = _file.read(record.mutBytes());
-            if (res.unwrapOr(0) == 0)
-                co_return;
+        Io::BScan s{map.unwrap().bytes()};
+        s.skip(sizeof(RawHeader));
+        _end = s.tell();
 
-            if (not record.check()) {
-                panic("invalid crc for record");
-                co_return;
-            }
+        while (not s.ended()) {
+            RawRecord record;
+            if (not s.readTo(&record) or not record.check())
+                break;
 
-            auto key = MutBlob::alloc(record.keylen);
-            _file.read(key.mutBytes()).unwrap("could not read key");
-            auto value = MutBlob::alloc(record.vallen);
-            _file.read(value.mutBytes()).unwrap("could not read value");
+            if (s.rem() < record.keylen + record.vallen + sizeof(u32le))
+                break;
 
-            u32le crc;
-            _file.read({reinterpret_cast<u8*>(&crc), sizeof(crc)}).unwrap("could not read crc");
+            auto key = Blob::from(s.nextBytes(record.keylen));
+            auto value = Blob::from(s.nextBytes(record.vallen));
 
             Crypto::Crc32 c;
             c.update(key.bytes());
             c.update(value.bytes());
+            if (s.nextU32le() != c.digest())
+                break;
 
-            if (crc != c.digest()) {
-                logError("invalid crc for key/value");
-            }
-
+            _end = s.tell();
             co_yield Record{
                 .type = record.type,
                 .key = key,
                 .value = value,
             };
         }
+
+        if (not s.ended())
+            logWarn("kv: dropping {} bytes of torn records at the end of the wal", s.tell() + s.rem() - _end);
+    }
+
+    // Continue the log after the last good record seen by iter(), the torn
+    // records after it are cut off so they can't be mistaken for a later
+    // write that was shorter than them.
+    Res<> rewind() {
+        try$(_file.truncate(_end));
+        try$(_file.seek(Io::Seek::fromBegin(_end)));
+        return Ok();
     }
 };
 
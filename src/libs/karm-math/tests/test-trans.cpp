@@ -0,0 +1,21 @@
+#include <karm-math/trans.h>
+#include <karm-test/macros.h>
+
+namespace Karm::Math::Tests {
+
+test$("trans-inverse") {
+    auto trans = Trans2f{}
+                     .translated({10, 20})
+                     .scaled({2, 4});
+    Vec2f p = {3, 5};
+
+    expect$(epsilonEq(trans.apply(p), Vec2f{26, 100}, 1e-9));
+    expect$(epsilonEq(trans.inverse().apply(trans.apply(p)), p, 1e-9));
+
+    auto rotated = trans.rotated(0.5);
+    expect$(epsilonEq(rotated.inverse().apply(rotated.apply(p)), p, 1e-9));
+
+    return Ok();
+}
+
+} // namespace Karm::Math::Tests
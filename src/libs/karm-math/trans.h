@@ -185,7 +185,7 @@ union Trans2 {
         return {
             yy / det, -xy / det,
             -yx / det, xx / det,
-            (oy * yy - ox * yx) / det,
+            (oy * yx - ox * yy) / det,
             (ox * xy - oy * xx) / det
         };
     }
@@ -114,13 +114,13 @@ void Canvas::fill(Gfx::FillRule rule) {
 }
 
 void Canvas::fill(Text::Prose& prose) {
+    auto fontId = _fontManager->getFontId(prose._style.font.fontface);
+    if (not contains(_fonts, fontId))
+        _fonts.pushBack(fontId);
+
     push();
     _e.ln("BT");
-    _e.ln(
-        "/F{} {} Tf",
-        _fontManager->getFontId(prose._style.font.fontface),
-        prose._style.font.fontSize()
-    );
+    _e.ln("/F{} {} Tf", fontId, prose._style.font.fontSize());
 
     if (prose._style.color)
         fillStyle(*prose._style.color);
@@ -151,6 +151,7 @@ void Canvas::fill(Text::Prose& prose) {
 
                 for (auto rune : cell.runes()) {
                     _e("{04x}", rune);
+                    _fontManager->markUsed(fontId, rune);
                 }
                 prevEndPos = prevEndPos + glyphAdvance - kern;
             }
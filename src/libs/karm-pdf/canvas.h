@@ -11,6 +11,10 @@ struct FontManager {
     // FIXME: using the address of the fontface since there is not comparison for the fontface obj
     Map<_Cell<NoLock>*, Tuple<usize, Rc<Text::Fontface>>> mapping;
 
+    // Runes drawn with each font, indexed by font id - 1,
+    // only the glyphs they map to are embedded in the document.
+    Vec<Vec<bool>> used;
+
     usize getFontId(Rc<Text::Fontface> font) {
         auto addr = font._cell;
         if (auto id = mapping.tryGet(addr))
@@ -18,8 +22,20 @@ struct FontManager {
 
         auto id = mapping.len() + 1;
         mapping.put(addr, {id, font});
+        used.emplaceBack();
         return id;
     }
+
+    void markUsed(usize id, Rune rune) {
+        // NOTE: Identity-H encodes runes as two bytes CIDs
+        if (rune > 0xFFFF)
+            return;
+
+        auto& runes = used[id - 1];
+        if (runes.len() <= rune)
+            runes.resize(rune + 1, false);
+        runes[rune] = true;
+    }
 };
 
 struct Canvas : public Gfx::Canvas {
@@ -29,6 +45,9 @@ struct Canvas : public Gfx::Canvas {
 
     MutCursor<FontManager> _fontManager;
 
+    // Fonts used on this page, for its resource dictionary.
+    Vec<usize> _fonts;
+
     Canvas(Io::Emit e, Math::Vec2f mediaBox, MutCursor<FontManager> fontManager)
         : _e{e}, _mediaBox{mediaBox}, _fontManager{fontManager} {}
 
@@ -1,3 +1,5 @@
+#include <karm-archive/zlib/spec.h>
+
 #include "values.h"
 
 namespace Karm::Pdf {
@@ -29,6 +31,16 @@ void Dict::write(Io::Emit& e) const {
     e(">>");
 }
 
+Stream Stream::compressed(Dict dict, Bytes data) {
+    auto compressed = Zlib::compress(data);
+    dict.put("Filter"s, Name{"FlateDecode"s});
+    dict.put("Length"s, compressed.len());
+    return {
+        .dict = std::move(dict),
+        .data = std::move(compressed._buf),
+    };
+}
+
 void Stream::write(Io::Emit& e) const {
     dict.write(e);
     e("stream\n");
@@ -67,45 +79,66 @@ void Value::write(Io::Emit& e) const {
 }
 
 Res<> File::write(Io::Writer& w) const {
-    Io::Count count{w};
-    Io::TextEncoder<> enc{w};
-    Io::Emit e{enc};
-    e("%{}\n", header);
-    e("%Powered By Karm PDF 🐢🏳️‍⚧️🦔\n", header);
-
-    XRef xref;
-
-    for (auto const& [k, v] : body.iter()) {
-        try$(e.flush());
-        xref.add(try$(Io::tell(count)), k.gen);
-        e("{} {} obj\n", k.num, k.gen);
-        v.write(e);
-        e("\nendobj\n");
+    Writer writer{w};
+    try$(writer.begin(header));
+    for (auto const& [k, v] : body.iter())
+        try$(writer.add(k, v));
+    return writer.end(trailer);
+}
+
+void XRef::write(Io::Emit& e) const {
+    e("0 {}\n", entries.len());
+    for (usize i = 0; i < entries.len(); ++i) {
+        auto const& entry = entries[i];
+        // NOTE: Entries are exactly 20 bytes long, the end of line included.
+        e("{:010} {:05} {} \n", entry.offset, entry.gen, Str{entry.used ? "n" : "f"});
     }
+}
 
-    try$(e.flush());
-    auto startxref = try$(Io::tell(count));
-    e("xref\n");
-    xref.write(e);
+// MARK: Writer ----------------------------------------------------------------
 
-    e("trailer\n");
-    trailer.write(e);
+Res<usize> Writer::_tell() {
+    try$(_e.flush());
+    return Ok(_flushed + _buf.bytes().len());
+}
 
-    e("startxref\n");
-    e("{}\n", startxref);
-    e("%%EOF");
+Res<> Writer::_flush() {
+    try$(_e.flush());
+    _flushed += try$(_out.write(_buf.bytes()));
+    _buf.clear();
+    return Ok();
+}
+
+Res<> Writer::begin(Str header) {
+    _e("%{}\n", header);
+    _e("%Powered By Karm PDF 🐢🏳️‍⚧️🦔\n");
+    return _e.flush();
+}
 
+Res<> Writer::add(Ref ref, Value const& value) {
+    _xref.add(ref, try$(_tell()));
+    _e("{} {} obj\n", ref.num, ref.gen);
+    value.write(_e);
+    _e("\nendobj\n");
+    try$(_e.flush());
+
+    if (_buf.bytes().len() >= FLUSH_THRESHOLD)
+        try$(_flush());
     return Ok();
 }
 
-void XRef::write(Io::Emit& e) const {
-    e("1 {}\n", entries.len());
-    for (usize i = 0; i < entries.len(); ++i) {
-        auto const& entry = entries[i];
-        if (entry.used) {
-            e("{:010} {:05} n\n", entry.offset, entry.gen);
-        }
-    }
+Res<> Writer::end(Dict const& trailer) {
+    auto startxref = try$(_tell());
+    _e("xref\n");
+    _xref.write(_e);
+
+    _e("trailer\n");
+    trailer.write(_e);
+
+    _e("\nstartxref\n");
+    _e("{}\n", startxref);
+    _e("%%EOF");
+    return _flush();
 }
 
 } // namespace Karm::Pdf
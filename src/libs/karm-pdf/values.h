@@ -2,6 +2,8 @@
 
 #include <karm-base/map.h>
 #include <karm-io/emit.h>
+#include <karm-io/impls.h>
+#include <karm-meta/nocopy.h>
 
 namespace Karm::Pdf {
 
@@ -41,6 +43,9 @@ struct Stream {
     Dict dict;
     Buf<Byte> data;
 
+    // 7.4.4 FlateDecode filter
+    static Stream compressed(Dict dict, Bytes data);
+
     void write(Io::Emit& e) const;
 };
 
@@ -83,13 +88,42 @@ struct XRef {
         bool used;
     };
 
-    Vec<Entry> entries;
+    // Indexed by object number, the first entry is always free.
+    Vec<Entry> entries = {{0, 65535, false}};
 
-    void add(usize offset, usize gen) {
-        entries.pushBack({offset, gen, true});
+    void add(Ref ref, usize offset) {
+        if (entries.len() <= ref.num)
+            entries.resize(ref.num + 1, {0, 0, false});
+        entries[ref.num] = {offset, ref.gen, true};
     }
 
     void write(Io::Emit& e) const;
 };
 
+// Writes the objects of a file as soon as they are ready, so that they
+// don't have to be kept around until the whole document is done.
+struct Writer : public Meta::Pinned {
+    static constexpr usize FLUSH_THRESHOLD = 64 * 1024;
+
+    Io::Writer& _out;
+    usize _flushed = 0;
+    Io::BufferWriter _buf;
+    Io::TextEncoder<> _enc;
+    Io::Emit _e;
+    XRef _xref;
+
+    Writer(Io::Writer& w)
+        : _out(w), _enc(_buf), _e(_enc) {}
+
+    Res<usize> _tell();
+
+    Res<> _flush();
+
+    Res<> begin(Str header);
+
+    Res<> add(Ref ref, Value const& value);
+
+    Res<> end(Dict const& trailer);
+};
+
 } // namespace Karm::Pdf
@@ -3,13 +3,11 @@
 #include <karm-pdf/canvas.h>
 #include <karm-pdf/values.h>
 #include <karm-text/ttf.h>
+#include <karm-text/ttf/subset.h>
 
 namespace Karm::Print {
 
 struct TtfGlyphInfoAdapter {
-
-    usize const CODESPACE = 1 << 16;
-
     Rc<Text::TtfFontface> _font;
 
     Map<u16, u16> codeMappings;
@@ -17,11 +15,25 @@ struct TtfGlyphInfoAdapter {
     TtfGlyphInfoAdapter(Rc<Text::TtfFontface> font, Map<u16, u16> mappings)
         : _font{font}, codeMappings{mappings} {}
 
-    static TtfGlyphInfoAdapter build(Rc<Text::TtfFontface> font) {
-        Map<u16, u16> codeMappings = font->_parser._cmapTable.extractMapping();
+    // Only maps the runes drawn with the font, `used` is indexed by rune.
+    static TtfGlyphInfoAdapter build(Rc<Text::TtfFontface> font, Slice<bool> used) {
+        Map<u16, u16> codeMappings;
+        for (usize rune = 0; rune < used.len(); ++rune) {
+            if (not used[rune])
+                continue;
+            // NOTE: Runes are visited in order, no need to check for duplicates.
+            codeMappings._els.pushBack({(u16)rune, (u16)font->_parser.glyph(rune).index});
+        }
         return TtfGlyphInfoAdapter{font, codeMappings};
     }
 
+    Vec<u16> glyphs() const {
+        Vec<u16> res;
+        for (auto const& [_, gid] : codeMappings.iter())
+            res.pushBack(gid);
+        return res;
+    }
+
     Pdf::Array fontBBox() {
         // Values in the glyph coordinate system
         f64 xMin = 0;
@@ -84,28 +96,14 @@ struct TtfGlyphInfoAdapter {
     }
 
     Buf<Byte> CIDToGIDMap() {
+        // CIDs past the end of the map have no glyph
+        usize len = codeMappings.len() ? (last(codeMappings._els).v0 + 1) * 2 : 0;
         Buf<Byte> buf;
+        buf.resize(len, 0);
 
-        u16 const BYTE_MASK = 255;
-
-        usize consecutiveUnmappedCIDs = 0;
-        for (usize i = 0; i < CODESPACE; ++i) {
-            auto glyph = codeMappings.tryGet(i);
-
-            if (not glyph) {
-                consecutiveUnmappedCIDs++;
-                continue;
-            }
-
-            for (usize j = 0; j < consecutiveUnmappedCIDs; ++j) {
-                buf.insert(buf.len(), 0);
-                buf.insert(buf.len(), 0);
-            }
-            consecutiveUnmappedCIDs = 0;
-
-            auto gid = glyph.unwrap();
-            buf.insert(buf.len(), (gid >> 8) & BYTE_MASK);
-            buf.insert(buf.len(), gid & BYTE_MASK);
+        for (auto const& [cid, gid] : codeMappings.iter()) {
+            buf[cid * 2] = gid >> 8;
+            buf[cid * 2 + 1] = gid & 0xFF;
         }
 
         return buf;
@@ -130,7 +128,7 @@ struct TrueTypeFontAdapter {
 
     Pdf::Name CIDFontName;
 
-    TrueTypeFontAdapter(Rc<Text::TtfFontface> font, Pdf::Ref& alloc)
+    TrueTypeFontAdapter(Rc<Text::TtfFontface> font, Slice<bool> used, Pdf::Ref& alloc)
         : _font(font),
           CIDFontRef(alloc.alloc()),
           CIDSystemInfoRef(alloc.alloc()),
@@ -139,7 +137,7 @@ struct TrueTypeFontAdapter {
           fontDescriptorRef(alloc.alloc()),
           fontRef(alloc.alloc()),
           ttfGlyphInfoAdapter{
-              TtfGlyphInfoAdapter::build(font)
+              TtfGlyphInfoAdapter::build(font, used)
           },
           CIDFontName{
               font->_parser._name.string(font->_parser._name.lookupRecord(Ttf::Name::POSTSCRIPT)).str()
@@ -164,13 +162,20 @@ struct TrueTypeFontAdapter {
 
     Pdf::Stream fontFile() {
         // 9.9 Embedded font programs
-        return Pdf::Stream{
-            .dict = Pdf::Dict{
-                {"Length"s, _font->_mmap.bytes().len()},
-                {"Length1"s, _font->_mmap.bytes().len()},
+        Bytes program = _font->_mmap.bytes();
+
+        auto subset = Ttf::subset(_font->_parser, ttfGlyphInfoAdapter.glyphs());
+        if (subset)
+            program = subset.unwrap();
+        else
+            logWarn("could not subset font, embedding it whole: {}", subset.none());
+
+        return Pdf::Stream::compressed(
+            Pdf::Dict{
+                {"Length1"s, program.len()},
             },
-            .data = _font->_mmap.bytes(),
-        };
+            program
+        );
     }
 
     Pdf::Dict CIDSystemInfo() {
@@ -214,13 +219,7 @@ struct TrueTypeFontAdapter {
     }
 
     Pdf::Stream CIDToGIDMap() {
-        auto stream = ttfGlyphInfoAdapter.CIDToGIDMap();
-        return Pdf::Stream{
-            .dict = Pdf::Dict{
-                {"Length"s, stream.len()},
-            },
-            .data = std::move(stream)
-        };
+        return Pdf::Stream::compressed({}, ttfGlyphInfoAdapter.CIDToGIDMap());
     }
 
     Pdf::Dict CIDFont() {
@@ -236,15 +235,15 @@ struct TrueTypeFontAdapter {
         };
     }
 
-    Pdf::Ref addToFile(Pdf::File& file) {
-        file.add(CIDToGIDMapRef, CIDToGIDMap());
-        file.add(CIDSystemInfoRef, CIDSystemInfo());
-        file.add(fontFileRef, fontFile());
-        file.add(CIDFontRef, CIDFont());
-        file.add(fontDescriptorRef, fontDescriptors());
+    Res<Pdf::Ref> write(Pdf::Writer& writer) {
+        try$(writer.add(CIDToGIDMapRef, CIDToGIDMap()));
+        try$(writer.add(CIDSystemInfoRef, CIDSystemInfo()));
+        try$(writer.add(fontFileRef, fontFile()));
+        try$(writer.add(CIDFontRef, CIDFont()));
+        try$(writer.add(fontDescriptorRef, fontDescriptors()));
 
-        file.add(fontRef, font());
-        return fontRef;
+        try$(writer.add(fontRef, font()));
+        return Ok(fontRef);
     }
 };
 
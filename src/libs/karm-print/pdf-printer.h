@@ -10,17 +10,34 @@ namespace Karm::Print {
 
 struct PdfPage {
     PaperStock paper;
-    Io::StringWriter data;
+    Pdf::Stream content = {};
+    Vec<usize> fonts = {};
 };
 
 struct PdfPrinter : public FilePrinter {
     Vec<PdfPage> _pages;
+    Io::StringWriter _data;
     Opt<Pdf::Canvas> _canvas;
     Pdf::FontManager fontManager;
 
+    // Pages are compressed as soon as they are done,
+    // only the current one is kept as plain text.
+    void _endPage() {
+        if (not _canvas)
+            return;
+
+        auto& page = last(_pages);
+        page.content = Pdf::Stream::compressed({}, _data.bytes());
+        page.fonts = std::move(_canvas->_fonts);
+
+        _canvas = NONE;
+        _data.clear();
+    }
+
     Gfx::Canvas& beginPage(PaperStock paper) override {
-        auto& page = _pages.emplaceBack(paper);
-        _canvas = Pdf::Canvas{page.data, paper.size(), &fontManager};
+        _endPage();
+        _pages.pushBack({paper});
+        _canvas = Pdf::Canvas{_data, paper.size(), &fontManager};
 
         // NOTE: PDF has the coordinate system origin at the bottom left corner.
         //       But we want to have it at the top left corner.
@@ -31,17 +48,19 @@ struct PdfPrinter : public FilePrinter {
         return *_canvas;
     }
 
-    Pdf::File pdf() {
-        Pdf::Ref alloc;
+    Res<> write(Io::Writer& w) override {
+        _endPage();
 
-        Pdf::File file;
-        file.header = "PDF-2.0"s;
+        Pdf::Ref alloc;
+        Pdf::Writer writer{w};
+        try$(writer.begin("PDF-2.0"));
 
-        Pdf::Array pagesKids;
         Pdf::Ref pagesRef = alloc.alloc();
+        Pdf::Ref catalogRef = alloc.alloc();
 
         // Fonts
-        Map<usize, Pdf::Ref> fontManagerId2FontObjRef;
+        // NOTE: Font ids are handed out in order, starting at 1.
+        Vec<Pdf::Ref> fontRefs;
         for (auto& [_, value] : fontManager.mapping._els) {
             auto& [id, fontFace] = value;
 
@@ -51,26 +70,26 @@ struct PdfPrinter : public FilePrinter {
 
             TrueTypeFontAdapter ttfAdapter{
                 fontFace.cast<Text::TtfFontface>().unwrap(),
+                fontManager.used[id - 1],
                 alloc
             };
 
-            auto fontRef = ttfAdapter.addToFile(file);
-            fontManagerId2FontObjRef.put(id, fontRef);
+            fontRefs.pushBack(try$(ttfAdapter.write(writer)));
         }
 
         // Page
+        Pdf::Array pagesKids;
         for (auto& p : _pages) {
             Pdf::Ref pageRef = alloc.alloc();
             Pdf::Ref contentsRef = alloc.alloc();
 
-            // FIXME: adding all fonts for now on each page; later, we will need to filter by page
             Pdf::Dict pageFontsDict;
-            for (auto& [managerId, objRef] : fontManagerId2FontObjRef._els) {
-                auto formattedName = Io::format("F{}", managerId);
-                pageFontsDict.put(formattedName.str(), objRef);
+            for (auto id : p.fonts) {
+                auto formattedName = Io::format("F{}", id);
+                pageFontsDict.put(formattedName.str(), fontRefs[id - 1]);
             }
 
-            file.add(
+            try$(writer.add(
                 pageRef,
                 Pdf::Dict{
                     {"Type"s, Pdf::Name{"Page"s}},
@@ -96,56 +115,39 @@ struct PdfPrinter : public FilePrinter {
                         },
                     }
                 }
-            );
+            ));
 
-            file.add(
-                contentsRef,
-                Pdf::Stream{
-                    .dict = Pdf::Dict{
-                        {"Length"s, p.data.bytes().len()},
-                    },
-                    .data = p.data.bytes(),
-                }
-            );
+            try$(writer.add(contentsRef, std::exchange(p.content, {})));
 
             pagesKids.pushBack(pageRef);
         }
 
         // Pages
-        file.add(
+        try$(writer.add(
             pagesRef,
             Pdf::Dict{
                 {"Type"s, Pdf::Name{"Pages"s}},
                 {"Count"s, _pages.len()},
                 {"Kids"s, std::move(pagesKids)},
             }
-        );
+        ));
 
         // Catalog
-        auto catalogRef = file.add(
-            alloc.alloc(),
+        try$(writer.add(
+            catalogRef,
             Pdf::Dict{
                 {"Type"s, Pdf::Name{"Catalog"s}},
                 {"Pages"s, pagesRef},
             }
-        );
+        ));
 
         // Trailer
-        file.trailer = Pdf::Dict{
-            {"Size"s, file.body.len() + 1},
-            {"Root"s, catalogRef},
-        };
-
-        // Sorting object by their refs, so they are printed in order
-        sort(file.body._els, [](auto& a, auto& b) {
-            return a.v0.num <=> b.v0.num;
-        });
-
-        return file;
-    }
-
-    Res<> write(Io::Writer& w) override {
-        return pdf().write(w);
+        return writer.end(
+            Pdf::Dict{
+                {"Size"s, alloc.num + 1},
+                {"Root"s, catalogRef},
+            }
+        );
     }
 };
 
@@ -0,0 +1,79 @@
+#include <karm-gfx/cpu/canvas.h>
+#include <karm-scene/box.h>
+#include <karm-scene/stack.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+
+static constexpr isize WIDTH = 800;
+static constexpr isize HEIGHT = 600;
+static constexpr isize LINE = 24;
+static constexpr isize STEP = 40;
+static constexpr usize FRAMES = 100;
+
+static Rc<Scene::Node> _box(Math::Rectf bound, Gfx::Color color) {
+    return makeRc<Scene::Box>(bound, Gfx::Borders{}, Gfx::Outline{}, Vec<Gfx::Fill>{color});
+}
+
+// A long page: a background per section and a few words per line.
+static Rc<Scene::Stack> buildPage(usize lines) {
+    auto page = makeRc<Scene::Stack>();
+    for (usize section = 0; section < lines; section += 50)
+        page->add(_box({0, (f64)(section * LINE), WIDTH, 50.0 * LINE}, Gfx::GRAY50));
+
+    Math::Rand rand{};
+    for (usize line = 0; line < lines; line++) {
+        f64 x = 8;
+        for (usize word = 0; word < 8; word++) {
+            f64 width = rand.nextInt(20, 90);
+            page->add(_box({x, (f64)(line * LINE + 4), width, LINE - 8.0}, Gfx::BLACK));
+            x += width + 8;
+        }
+    }
+
+    auto start = Sys::now();
+    page->prepare();
+    Sys::println("{} lines, {} nodes, prepared in {}", lines, page->_children.len(), Sys::now() - start);
+
+    return page;
+}
+
+// Scrolls down the page, only repainting the strip uncovered by every step
+// or, when `damage` is false, the whole page like before the damage rect
+// was passed down to the scene.
+static void benchScroll(Gfx::Surface& surface, Scene::Stack& page, bool damage) {
+    Gfx::CpuCanvas g;
+    g.begin(surface.mutPixels());
+
+    auto start = Sys::now();
+    for (usize frame = 0; frame < FRAMES; frame++) {
+        f64 scroll = frame * STEP;
+        Math::Rectf strip = {0, scroll + HEIGHT - STEP, WIDTH, STEP};
+
+        g.push();
+        g.clip(Math::Recti{0, HEIGHT - STEP, WIDTH, STEP});
+        g.origin({0, -scroll});
+        page.paint(g, damage ? strip : Math::Rectf::MAX);
+        g.pop();
+    }
+    auto elapsed = Sys::now() - start;
+
+    g.end();
+
+    Sys::println(
+        "  {}: {} per frame",
+        damage ? "damage" : "full",
+        Duration::fromUSecs(elapsed.toUSecs() / FRAMES)
+    );
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    auto surface = Gfx::Surface::alloc({WIDTH, HEIGHT});
+
+    for (usize lines : {100, 1000, 10000}) {
+        auto page = buildPage(lines);
+        benchScroll(*surface, *page, false);
+        benchScroll(*surface, *page, true);
+    }
+
+    co_return Ok();
+}
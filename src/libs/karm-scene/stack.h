@@ -4,11 +4,113 @@
 
 namespace Karm::Scene {
 
+// Packed R-tree over the children of a large stack, so painting a small
+// damage rect only visits the children overlapping it instead of every
+// one of them. Built bottom-up using Sort-Tile-Recursive.
+// See: Leutenegger et al., "STR: A Simple and Efficient Algorithm for R-Tree Packing"
+struct StackIndex {
+    // Below this many children a linear scan is just as fast.
+    static constexpr usize THRESHOLD = 64;
+    static constexpr usize FANOUT = 16;
+
+    struct _Entry {
+        Math::Rectf bound;
+        u32 first; // The child for leaves, the first entry of the level below otherwise
+        u32 count;
+    };
+
+    // From the leaves up to the root.
+    Vec<Vec<_Entry>> _levels;
+
+    // NOTE: Nodes without a bound may still draw something,
+    //       they are never culled.
+    Vec<u32> _always;
+
+    static StackIndex build(Slice<Math::Rectf> bounds, Math::Rectf bound) {
+        StackIndex index;
+
+        Vec<_Entry> leaves;
+        leaves.ensure(bounds.len());
+        for (usize i = 0; i < bounds.len(); i++) {
+            if (bounds[i].width <= 0 or bounds[i].height <= 0)
+                index._always.pushBack((u32)i);
+            else
+                leaves.pushBack({bounds[i], (u32)i, 0});
+        }
+
+        if (not leaves)
+            return index;
+
+        // Cut the children in vertical slabs, then group them top to
+        // bottom in each slab. Tall pages end up with few slabs.
+        usize pages = (leaves.len() + FANOUT - 1) / FANOUT;
+        f64 aspect = bound.height > 0 ? bound.width / bound.height : 1.0;
+        usize slabs = clamp((usize)Math::round(Math::sqrt(pages * aspect)), (usize)1, pages);
+        usize perSlab = ((pages + slabs - 1) / slabs) * FANOUT;
+
+        sort(leaves, [](_Entry const& a, _Entry const& b) {
+            return a.bound.center().x <=> b.bound.center().x;
+        });
+
+        for (usize i = 0; i < leaves.len(); i += perSlab) {
+            auto slab = mutSub(leaves, i, min(i + perSlab, leaves.len()));
+            sort(slab, [](_Entry const& a, _Entry const& b) {
+                return a.bound.center().y <=> b.bound.center().y;
+            });
+        }
+
+        index._levels.pushBack(std::move(leaves));
+
+        while (last(index._levels).len() > 1) {
+            auto const& below = last(index._levels);
+            Vec<_Entry> above;
+            for (usize i = 0; i < below.len(); i += FANOUT) {
+                usize count = min(FANOUT, below.len() - i);
+                Math::Rectf rect = below[i].bound;
+                for (usize j = 1; j < count; j++)
+                    rect = rect.mergeWith(below[i + j].bound);
+                above.pushBack({rect, (u32)i, (u32)count});
+            }
+            index._levels.pushBack(std::move(above));
+        }
+
+        return index;
+    }
+
+    void _query(Math::Rectf r, usize level, _Entry const& entry, Vec<u32>& out) const {
+        if (not entry.bound.colide(r))
+            return;
+
+        if (level == 0) {
+            out.pushBack(entry.first);
+            return;
+        }
+
+        for (usize i = entry.first; i < entry.first + entry.count; i++)
+            _query(r, level - 1, _levels[level - 1][i], out);
+    }
+
+    // Indices of the children that may overlap `r`, in paint order.
+    void query(Math::Rectf r, Vec<u32>& out) const {
+        out.pushBack(_always);
+        if (_levels)
+            _query(r, _levels.len() - 1, last(_levels)[0], out);
+
+        sort(out, [](u32 a, u32 b) {
+            return a <=> b;
+        });
+    }
+};
+
 struct Stack : public Node {
     Vec<Rc<Node>> _children;
+    Opt<Math::Rectf> _bound;
+    Opt<StackIndex> _index;
 
     void add(Rc<Node> child) {
         _children.pushBack(child);
+        _bound = NONE;
+        _index = NONE;
     }
 
     void prepare() override {
@@ -18,13 +120,31 @@ struct Stack : public Node {
 
         for (auto& child : _children)
             child->prepare();
+
+        // NOTE: The scene is not supposed to change once prepared,
+        //       bounds are computed once here, not on every paint.
+        Vec<Math::Rectf> bounds;
+        bounds.ensure(_children.len());
+        Math::Rectf rect;
+        for (auto& child : _children) {
+            bounds.pushBack(child->bound());
+            rect = rect.mergeWith(last(bounds));
+        }
+        _bound = rect;
+
+        _index = NONE;
+        if (_children.len() > StackIndex::THRESHOLD)
+            _index = StackIndex::build(bounds, rect);
     }
 
     Math::Rectf bound() override {
+        if (_bound)
+            return *_bound;
+
         Math::Rectf rect;
         for (auto& child : _children)
             rect = rect.mergeWith(child->bound());
-
+        _bound = rect;
         return rect;
     }
 
@@ -32,8 +152,16 @@ struct Stack : public Node {
         if (not bound().colide(r))
             return;
 
-        for (auto& child : _children)
-            child->paint(g, r, o);
+        if (not _index) {
+            for (auto& child : _children)
+                child->paint(g, r, o);
+            return;
+        }
+
+        Vec<u32> visible;
+        _index->query(r, visible);
+        for (auto i : visible)
+            _children[i]->paint(g, r, o);
     }
 
     void repr(Io::Emit& e) const override {
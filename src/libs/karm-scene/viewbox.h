@@ -26,7 +26,7 @@ struct Viewbox : public Node {
         g.origin(_viewbox.xy);
         g.clip(_viewbox);
 
-        _content->paint(g, r, o);
+        _content->paint(g, r.offset(-_viewbox.xy), o);
 
         g.pop();
     }
@@ -42,8 +42,20 @@ Res<Rc<Sys::Fd>> createErr();
 
 Res<Vec<Sys::DirEntry>> readDir(Mime::Url const& url);
 
+Res<> createDir(Mime::Url const& url);
+
 Res<Stat> stat(Mime::Url const& url);
 
+Res<> removeFile(Mime::Url const& url);
+
+Res<> renameFile(Mime::Url const& from, Mime::Url const& to);
+
+Res<> syncFile(Rc<Sys::Fd> fd);
+
+Res<> truncateFile(Rc<Sys::Fd> fd, usize len);
+
+Res<> syncDir(Mime::Url const& url);
+
 // MARK: User interactions -----------------------------------------------------
 
 Res<> launch(Intent intent);
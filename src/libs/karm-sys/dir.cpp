@@ -15,4 +15,22 @@ Res<Dir> Dir::open(Mime::Url url) {
     return Ok(Dir{entries, url});
 }
 
+Res<Dir> Dir::create(Mime::Url url) {
+    try$(ensureUnrestricted());
+    try$(_Embed::createDir(url));
+    return Ok(Dir{{}, url});
+}
+
+Res<Dir> Dir::openOrCreate(Mime::Url url) {
+    auto dir = open(url);
+    if (dir or dir.none().code() != Error::NOT_FOUND)
+        return dir;
+    return create(url);
+}
+
+Res<> Dir::sync(Mime::Url url) {
+    try$(ensureUnrestricted());
+    return _Embed::syncDir(url);
+}
+
 } // namespace Karm::Sys
@@ -27,6 +27,9 @@ struct Dir {
 
     static Res<Dir> openOrCreate(Mime::Url url);
 
+    // Wait for the entries created or removed so far to reach the storage device.
+    static Res<> sync(Mime::Url url);
+
     auto const& entries() const { return _entries; }
 
     auto const& path() const { return _url; }
@@ -5,6 +5,14 @@
 
 namespace Karm::Sys {
 
+Res<> _File::sync() {
+    return _Embed::syncFile(_fd);
+}
+
+Res<> _File::truncate(usize len) {
+    return _Embed::truncateFile(_fd, len);
+}
+
 Res<FileWriter> File::create(Mime::Url url) {
     try$(ensureUnrestricted());
     auto fd = try$(_Embed::createFile(url));
@@ -23,4 +31,14 @@ Res<File> File::openOrCreate(Mime::Url url) {
     return Ok(File{fd, url});
 }
 
+Res<> File::remove(Mime::Url url) {
+    try$(ensureUnrestricted());
+    return _Embed::removeFile(url);
+}
+
+Res<> File::rename(Mime::Url from, Mime::Url to) {
+    try$(ensureUnrestricted());
+    return _Embed::renameFile(from, to);
+}
+
 } // namespace Karm::Sys
@@ -37,6 +37,12 @@ struct _File :
         return _fd->stat();
     }
 
+    // Wait for the data written so far to reach the storage device.
+    Res<> sync();
+
+    // Cut the file at `len` bytes.
+    Res<> truncate(usize len);
+
     Rc<Fd> fd() {
         return _fd;
     }
@@ -84,6 +90,12 @@ struct File :
     static Res<FileReader> open(Mime::Url url);
 
     static Res<File> openOrCreate(Mime::Url url);
+
+    static Res<> remove(Mime::Url url);
+
+    // Move `from` to `to`, replacing it. Readers see either the old or
+    // the new file, never a partially written one.
+    static Res<> rename(Mime::Url from, Mime::Url to);
 };
 
 /// Read the entire file as a UTF-8 string.
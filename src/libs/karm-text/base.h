@@ -2,6 +2,7 @@
 
 #include <karm-base/checked.h>
 #include <karm-base/distinct.h>
+#include <karm-base/hash.h>
 #include <karm-base/string.h>
 #include <karm-io/emit.h>
 
@@ -299,3 +300,10 @@ struct FontAttrs {
 };
 
 } // namespace Karm::Text
+
+template <>
+struct Karm::Hasher<Karm::Text::Glyph> {
+    static constexpr Karm::Hash hash(Karm::Text::Glyph const& g) {
+        return Karm::hash<u32>((static_cast<u32>(g.font) << 16) | g.index);
+    }
+};
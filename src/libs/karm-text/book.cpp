@@ -1,5 +1,9 @@
+#include <karm-io/aton.h>
+#include <karm-json/parse.h>
 #include <karm-logger/logger.h>
 #include <karm-pkg/bundle.h>
+#include <karm-sys/dir.h>
+#include <karm-sys/file.h>
 #include <karm-sys/time.h>
 
 #include "book.h"
@@ -9,6 +13,19 @@ namespace Karm::Text {
 
 // MARK: Font loading ----------------------------------------------------------
 
+Rc<Fontface> FontInfo::face() const {
+    auto face = _face;
+    if (not *face) {
+        auto maybeFace = loadFontface(url);
+        if (not maybeFace)
+            logWarn("could not load {}: {}", url, maybeFace.none());
+        *face = maybeFace.unwrapOrElse([] {
+            return Fontface::fallback();
+        });
+    }
+    return **face;
+}
+
 Res<> FontBook::load(Mime::Url const& url, Opt<FontAttrs> attrs) {
     auto maybeFace = loadFontface(url);
     if (not maybeFace)
@@ -19,13 +36,126 @@ Res<> FontBook::load(Mime::Url const& url, Opt<FontAttrs> attrs) {
     add({
         .url = url,
         .attrs = attrs.unwrapOr(face->attrs()),
-        .face = face,
+        ._face = makeRc<Opt<Rc<Fontface>>>(face),
     });
 
     return Ok();
 }
 
-Res<> FontBook::loadAll() {
+// MARK: Font Catalog ----------------------------------------------------------
+
+static constexpr isize CATALOG_VERSION = 2;
+
+// NOTE: Read from the ranges of the cmap, looking glyphs up one by
+//       one would fill the glyph caches of the face for nothing.
+static u64 _coverage(Fontface const& face) {
+    u64 coverage = 0;
+    for (auto [start, end] : face.ranges()) {
+        for (Rune block = start / 1024; block <= end / 1024 and block < 64; block++)
+            coverage |= 1ull << block;
+    }
+    return coverage;
+}
+
+Json::Value FontCatalogEntry::toJson() const {
+    Json::Object json;
+    json.put("url"s, url.str());
+    json.put("size"s, (Json::Integer)size);
+    json.put("mtime"s, (Json::Integer)modifyTime.val());
+    json.put("family"s, attrs.family);
+    json.put("weight"s, (Json::Integer)attrs.weight.value());
+    json.put("stretch"s, (Json::Integer)attrs.stretch.value());
+    json.put("style"s, (Json::Integer)toUnderlyingType(attrs.style));
+    json.put("monospace"s, attrs.monospace == Monospace::YES);
+    // NOTE: Json integers are signed, the high blocks would overflow them.
+    json.put("coverage"s, Io::format("{x}", coverage));
+    json.put("failed"s, failed);
+    return json;
+}
+
+Res<FontCatalogEntry> FontCatalogEntry::fromJson(Json::Value const& json) {
+    if (not json.isObject() or
+        not json.get("url").isStr() or
+        not json.get("family").isStr())
+        return Error::invalidData("malformed font catalog entry");
+
+    auto style = json.get("style").asInt();
+    if (style < 0 or style >= toUnderlyingType(FontStyle::NO_MATCH))
+        return Error::invalidData("invalid font style");
+
+    auto coverage = json.get("coverage").asStr();
+
+    return Ok(FontCatalogEntry{
+        .url = Mime::Url::parse(json.get("url").asStr()),
+        .size = (usize)json.get("size").asInt(),
+        .modifyTime = SystemTime{(u64)json.get("mtime").asInt()},
+        .attrs = {
+            .family = json.get("family").asStr(),
+            .weight = FontWeight{(u16)json.get("weight").asInt()},
+            .stretch = FontStretch{(u16)json.get("stretch").asInt()},
+            .style = (FontStyle)style,
+            .monospace = json.get("monospace").asBool() ? Monospace::YES : Monospace::NO,
+        },
+        .coverage = Io::atou(coverage.str(), {.base = 16}).unwrapOr(0),
+        .failed = json.get("failed").asBool(),
+    });
+}
+
+static HashMap<String, FontCatalogEntry> _loadCatalog(Mime::Url const& url) {
+    HashMap<String, FontCatalogEntry> entries;
+
+    auto data = Sys::readAllUtf8(url);
+    if (not data)
+        return entries;
+
+    auto json = Json::parse(data.unwrap());
+    if (not json or json.unwrap().get("version").asInt() != CATALOG_VERSION)
+        return entries;
+
+    auto fonts = json.unwrap().get("fonts");
+    for (usize i = 0; i < fonts.len(); i++) {
+        auto entry = FontCatalogEntry::fromJson(fonts.get(i));
+        if (not entry)
+            continue;
+        entries.put(entry.unwrap().url.str(), entry.take());
+    }
+
+    return entries;
+}
+
+static Res<> _saveCatalog(Mime::Url const& url, Slice<FontCatalogEntry> entries) {
+    Json::Array fonts;
+    fonts.ensure(entries.len());
+    for (auto& entry : entries)
+        fonts.pushBack(entry.toJson());
+
+    Json::Object json;
+    json.put("version"s, CATALOG_VERSION);
+    json.put("fonts"s, fonts);
+
+    // NOTE: Written aside then moved in place, so a crash while saving
+    //       never leaves a partial catalog behind.
+    try$(Sys::Dir::openOrCreate(url.parent(1)));
+    auto tmp = url.parent(1) / Io::format("{}.tmp", url.basename());
+    {
+        auto file = try$(Sys::File::create(tmp));
+        Io::TextEncoder<> enc{file};
+        Io::Emit e{enc};
+        try$(Json::unparse(e, json));
+        try$(file.flush());
+        try$(file.sync());
+    }
+    return Sys::File::rename(tmp, url);
+}
+
+Mime::Url FontBook::defaultCatalog() {
+    return "location://cache/karm-text-fonts.json"_url;
+}
+
+Res<> FontBook::loadAll(Opt<Mime::Url> catalog) {
+    auto known = catalog ? _loadCatalog(*catalog) : HashMap<String, FontCatalogEntry>{};
+    Vec<FontCatalogEntry> entries;
+    bool dirty = false;
 
     auto bundles = try$(Pkg::installedBundles());
     for (auto& bundle : bundles) {
@@ -41,18 +171,72 @@ Res<> FontBook::loadAll() {
 
             auto fontUrl = dir.path() / diren.name;
 
-            auto res = load(fontUrl);
-            if (not res)
-                logWarn("could not load {}: {}", fontUrl, res);
+            auto stat = Sys::stat(fontUrl);
+            if (not stat) {
+                logWarn("could not stat {}: {}", fontUrl, stat.none());
+                continue;
+            }
+
+            auto entry = known.tryGet(fontUrl.str());
+            if (entry and entry->upToDate(stat.unwrap())) {
+                if (not entry->failed) {
+                    add({
+                        .url = fontUrl,
+                        .attrs = entry->attrs,
+                        .coverage = entry->coverage,
+                    });
+                }
+                entries.pushBack(entry.take());
+                continue;
+            }
+
+            auto maybeFace = loadFontface(fontUrl);
+            if (not maybeFace) {
+                logWarn("could not load {}: {}", fontUrl, maybeFace.none());
+                entries.pushBack({
+                    .url = fontUrl,
+                    .size = stat.unwrap().size,
+                    .modifyTime = stat.unwrap().modifyTime,
+                    .attrs = {},
+                    .coverage = 0,
+                    .failed = true,
+                });
+                dirty = true;
+                continue;
+            }
+
+            auto face = maybeFace.take();
+            FontInfo info = {
+                .url = fontUrl,
+                .attrs = face->attrs(),
+                .coverage = catalog ? _coverage(*face) : 0,
+                ._face = makeRc<Opt<Rc<Fontface>>>(face),
+            };
+
+            entries.pushBack({
+                .url = fontUrl,
+                .size = stat.unwrap().size,
+                .modifyTime = stat.unwrap().modifyTime,
+                .attrs = info.attrs,
+                .coverage = info.coverage,
+            });
+            add(info);
+            dirty = true;
         }
     }
 
+    // NOTE: Fonts might also have been removed since.
+    if (catalog and (dirty or entries.len() != known.len())) {
+        if (auto res = _saveCatalog(*catalog, entries); not res)
+            logWarn("could not save font catalog {}: {}", *catalog, res);
+    }
+
     auto ibmVga = Fontface::fallback();
 
     add({
         .url = ""_url,
         .attrs = ibmVga->attrs(),
-        .face = ibmVga,
+        ._face = makeRc<Opt<Rc<Fontface>>>(ibmVga),
     });
 
     return Ok();
@@ -226,7 +410,7 @@ Opt<Rc<Fontface>> FontBook::queryExact(FontQuery query) const {
             attrs.weight == query.weight and
             attrs.stretch == query.stretch and
             attrs.style == query.style)
-            return info.face;
+            return info.face();
     }
 
     return NONE;
@@ -235,7 +419,7 @@ Opt<Rc<Fontface>> FontBook::queryExact(FontQuery query) const {
 Opt<Rc<Fontface>> FontBook::queryClosest(FontQuery query) const {
     Str desiredfamily = _resolveFamily(query.family);
 
-    Opt<Rc<Fontface>> matchingFace;
+    FontInfo const* matchingInfo = nullptr;
     auto matchingFamily = ""s;
     auto matchingStretch = FontStretch::NO_MATCH;
     auto matchingStyle = FontStyle::NO_MATCH;
@@ -280,25 +464,33 @@ Opt<Rc<Fontface>> FontBook::queryClosest(FontQuery query) const {
         if (attrs.weight != currWeight)
             continue;
 
-        matchingFace = info.face;
+        matchingInfo = &info;
         matchingFamily = currFamily;
         matchingStretch = currStretch;
         matchingStyle = currStyle;
         matchingWeight = currWeight;
     }
 
-    return matchingFace;
+    // NOTE: Only the face picked in the end gets opened.
+    if (not matchingInfo)
+        return NONE;
+    return matchingInfo->face();
 }
 
 Vec<Rc<Fontface>> FontBook::queryFamily(String family) const {
-    Vec<Rc<Fontface>> res;
+    Vec<FontInfo const*> infos;
     for (auto& info : _faces)
         if (commonFamily(info.attrs.family, family) == family)
-            res.pushBack(info.face);
+            infos.pushBack(&info);
 
-    sort(res, [](auto& lhs, auto& rhs) {
-        return lhs->attrs() <=> rhs->attrs();
+    sort(infos, [](auto* lhs, auto* rhs) {
+        return lhs->attrs <=> rhs->attrs;
     });
+
+    Vec<Rc<Fontface>> res;
+    res.ensure(infos.len());
+    for (auto* info : infos)
+        res.pushBack(info->face());
     return res;
 }
 
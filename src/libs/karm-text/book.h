@@ -1,8 +1,10 @@
 #pragma once
 
 #include <karm-base/set.h>
+#include <karm-json/values.h>
 #include <karm-mime/url.h>
 #include <karm-sys/mmap.h>
+#include <karm-sys/stat.h>
 
 #include "base.h"
 #include "font.h"
@@ -26,7 +28,41 @@ struct FontQuery {
 struct FontInfo {
     Mime::Url url;
     FontAttrs attrs;
-    Rc<Fontface> face;
+
+    // Blocks of 1024 code points of the basic multilingual plane
+    // the face has glyphs in, bit n for the block n. Only computed when
+    // loading with a catalog, 0 otherwise.
+    //
+    // NOTE: Nothing queries it yet, it is meant for picking fallback
+    //       faces without opening them.
+    u64 coverage = 0;
+
+    // NOTE: Shared by the copies of the book, a face is opened
+    //       once, the first time a query picks it.
+    Rc<Opt<Rc<Fontface>>> _face = makeRc<Opt<Rc<Fontface>>>(NONE);
+
+    Rc<Fontface> face() const;
+};
+
+// What the catalog remembers of a font file, to fill a book without
+// opening and parsing the file again as long as it doesn't change.
+struct FontCatalogEntry {
+    Mime::Url url;
+    usize size;
+    SystemTime modifyTime;
+    FontAttrs attrs;
+    u64 coverage;
+
+    // The file couldn't be loaded as a face, it's skipped until it changes.
+    bool failed = false;
+
+    bool upToDate(Sys::Stat const& stat) const {
+        return size == stat.size and modifyTime == stat.modifyTime;
+    }
+
+    Json::Value toJson() const;
+
+    static Res<FontCatalogEntry> fromJson(Json::Value const& json);
 };
 
 Str commonFamily(Str lhs, Str rhs);
@@ -51,9 +87,15 @@ struct FontBook {
         _faces.pushBack(info);
     }
 
+    // Where loadAll() remembers the attributes of the installed fonts.
+    static Mime::Url defaultCatalog();
+
     Res<> load(Mime::Url const& url, Opt<FontAttrs> attrs = NONE);
 
-    Res<> loadAll();
+    // Adds the fonts of every installed bundle. Their attributes come from
+    // the catalog while the files don't change, only the others are opened
+    // and the catalog is written back if anything changed.
+    Res<> loadAll(Opt<Mime::Url> catalog = defaultCatalog());
 
     Vec<String> families() const;
 
@@ -2,6 +2,7 @@
 #include <karm-sys/file.h>
 #include <karm-sys/mmap.h>
 #include <karm-sys/proc.h>
+#include <karm-sys/time.h>
 #include <karm-text/book.h>
 #include <karm-text/loader.h>
 #include <karm-text/ttf.h>
@@ -77,8 +78,18 @@ Async::Task<> entryPointAsync(Sys::Context& ctx) {
 
         co_return Ok();
     } else if (verb == "dump-db") {
+        Opt<Mime::Url> catalog = Text::FontBook::defaultCatalog();
+        if (args.has("--no-catalog"))
+            catalog = NONE;
+
+        auto start = Sys::instant();
         Text::FontBook book;
-        co_try$(book.loadAll());
+        co_try$(book.loadAll(catalog));
+        auto elapsed = Sys::instant() - start;
+
+        for (auto& family : book.families())
+            Sys::println("{}", family);
+        Sys::println("loaded {} faces in {} ({})", book._faces.len(), elapsed, catalog ? "catalog" : "no catalog");
         co_return Ok();
     } else if (verb == "dump-attr") {
         if (args.len() != 2)
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <karm-base/tuple.h>
+#include <karm-base/vec.h>
 #include <karm-gfx/canvas.h>
 #include <karm-math/rect.h>
 
@@ -68,6 +70,12 @@ struct Fontface {
     virtual f64 kern(Glyph prev, Glyph curr) = 0;
 
     virtual void contour(Gfx::Canvas& g, Glyph glyph) const = 0;
+
+    // Ranges of code points the face maps to glyphs, first and last
+    // included, empty when the face can't tell without probing them.
+    virtual Vec<Pair<Rune>> ranges() const {
+        return {};
+    }
 };
 
 struct Font {
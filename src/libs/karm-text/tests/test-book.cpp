@@ -1,3 +1,4 @@
+#include <karm-json/parse.h>
 #include <karm-test/macros.h>
 #include <karm-text/book.h>
 
@@ -14,4 +15,44 @@ test$("karm-text-common-family") {
     return Ok();
 }
 
+test$("karm-text-catalog-entry") {
+    FontCatalogEntry entry = {
+        .url = "bundle://fonts-inter/fonts/Inter-Bold.ttf"_url,
+        .size = 412384,
+        .modifyTime = SystemTime{1700000000},
+        .attrs = {
+            .family = "Inter"s,
+            .weight = FontWeight::BOLD,
+            .style = FontStyle::ITALIC,
+            .monospace = Monospace::YES,
+        },
+        // NOTE: U+FFFD lives in the last block, so the high bit is usually set.
+        .coverage = 0x8000'0000'0000'0003,
+    };
+
+    auto json = try$(Json::parse(try$(Json::unparse(entry.toJson()))));
+    auto parsed = try$(FontCatalogEntry::fromJson(json));
+
+    expectEq$(parsed.url, entry.url);
+    expectEq$(parsed.size, entry.size);
+    expect$(parsed.modifyTime == entry.modifyTime);
+    expectEq$(parsed.attrs.family, entry.attrs.family);
+    expect$(parsed.attrs.weight == FontWeight::BOLD);
+    expect$(parsed.attrs.stretch == FontStretch::NORMAL);
+    expect$(parsed.attrs.style == FontStyle::ITALIC);
+    expect$(parsed.attrs.monospace == Monospace::YES);
+    expectEq$(parsed.coverage, entry.coverage);
+    expect$(entry.toJson().get("coverage").isStr());
+
+    expect$(parsed.upToDate({.type = Sys::Type::FILE, .size = 412384, .modifyTime = SystemTime{1700000000}}));
+    expect$(not parsed.upToDate({.type = Sys::Type::FILE, .size = 412385, .modifyTime = SystemTime{1700000000}}));
+
+    expect$(not parsed.failed);
+    entry.failed = true;
+    json = try$(Json::parse(try$(Json::unparse(entry.toJson()))));
+    expect$(try$(FontCatalogEntry::fromJson(json)).failed);
+
+    return Ok();
+}
+
 } // namespace Karm::Text::Tests
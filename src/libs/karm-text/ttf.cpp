@@ -57,6 +57,14 @@ Glyph TtfFontface::glyph(Rune rune) {
     return g;
 }
 
+Vec<Pair<Rune>> TtfFontface::ranges() const {
+    Vec<Pair<Rune>> ranges;
+    _parser._cmapTable.forEachRange([&](Rune start, Rune end) {
+        ranges.pushBack({start, end});
+    });
+    return ranges;
+}
+
 f64 TtfFontface::advance(Glyph glyph) {
     auto advance = _cachedAdvances.tryGet(glyph);
     if (advance.has())
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <karm-base/map.h>
+#include <karm-base/hashmap.h>
 #include <karm-sys/mmap.h>
 
 #include "font.h"
@@ -11,9 +11,9 @@ namespace Karm::Text {
 struct TtfFontface : public Fontface {
     Sys::Mmap _mmap;
     Ttf::Parser _parser;
-    Map<Rune, Glyph> _cachedEntries;
-    Map<Glyph, f64> _cachedAdvances;
-    Map<Pair<Glyph>, f64> _cachedKerns;
+    HashMap<Rune, Glyph> _cachedEntries;
+    HashMap<Glyph, f64> _cachedAdvances;
+    HashMap<Pair<Glyph>, f64> _cachedKerns;
     f64 _unitPerEm = 0;
 
     static Res<Rc<TtfFontface>> load(Sys::Mmap&& mmap);
@@ -31,6 +31,8 @@ struct TtfFontface : public Fontface {
     f64 kern(Glyph prev, Glyph curr) override;
 
     void contour(Gfx::Canvas& g, Glyph glyph) const override;
+
+    Vec<Pair<Rune>> ranges() const override;
 };
 
 } // namespace Karm::Text
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <karm-base/align.h>
+#include <karm-io/impls.h>
+
+#include "parser.h"
+
+// https://learn.microsoft.com/en-us/typography/opentype/spec/glyf#composite-glyph-description
+// https://learn.microsoft.com/en-us/typography/opentype/spec/otff#calculating-checksums
+
+namespace Ttf {
+
+// Tables needed to render the outlines of a TrueType font program,
+// as expected by PDF consumers (ISO 32000-2 9.9 Embedded font programs).
+static constexpr Array<Str, 9> SUBSET_TABLES = {
+    "cvt ", "fpgm", "glyf", "head", "hhea", "hmtx", "loca", "maxp", "prep"
+};
+
+static constexpr u16 ARG_1_AND_2_ARE_WORDS = 0x0001;
+static constexpr u16 WE_HAVE_A_SCALE = 0x0008;
+static constexpr u16 MORE_COMPONENTS = 0x0020;
+static constexpr u16 WE_HAVE_AN_X_AND_Y_SCALE = 0x0040;
+static constexpr u16 WE_HAVE_A_TWO_BY_TWO = 0x0080;
+
+static inline u32 _checksum(Bytes bytes) {
+    u32 sum = 0;
+    for (usize i = 0; i < bytes.len(); i += 4) {
+        u32 word = 0;
+        for (usize j = 0; j < 4; j++)
+            word = (word << 8) | (i + j < bytes.len() ? bytes[i + j] : 0);
+        sum += word;
+    }
+    return sum;
+}
+
+static inline Bytes _glyphData(Parser const& font, usize gid) {
+    auto start = font._loca.glyfOffset(gid, font._head);
+    auto end = font._loca.glyfOffset(gid + 1, font._head);
+    if (end <= start or end > font._glyf.bytes().len())
+        return {};
+    return sub(font._glyf.bytes(), start, end);
+}
+
+// Glyphs a composite glyph is made of.
+static inline void _glyphComponents(Bytes data, Vec<u16>& out) {
+    Io::BScan s{data};
+    if (s.rem() < 10 or s.nextI16be() >= 0)
+        return;
+    s.skip(8);
+
+    u16 flags = MORE_COMPONENTS;
+    while (flags & MORE_COMPONENTS and s.rem() >= 4) {
+        flags = s.nextU16be();
+        out.pushBack(s.nextU16be());
+
+        s.skip(flags & ARG_1_AND_2_ARE_WORDS ? 4 : 2);
+        if (flags & WE_HAVE_A_SCALE)
+            s.skip(2);
+        else if (flags & WE_HAVE_AN_X_AND_Y_SCALE)
+            s.skip(4);
+        else if (flags & WE_HAVE_A_TWO_BY_TWO)
+            s.skip(8);
+    }
+}
+
+// Builds a font program that only holds the outlines of `glyphs` and the
+// glyphs they are composed of. Glyph ids are left untouched, so the
+// character to glyph mapping of the original font still applies.
+static inline Res<Buf<Byte>> subset(Parser& font, Slice<u16> glyphs) {
+    auto maxp = font.lookupTable<Maxp>();
+    if (not maxp.present())
+        return Error::invalidData("missing maxp table");
+    usize numGlyphs = maxp.numGlyphs();
+
+    // Glyph 0 is the .notdef glyph and must always be present
+    Vec<bool> keep;
+    keep.resize(numGlyphs, false);
+    Vec<u16> pending = glyphs;
+    pending.pushBack(0);
+
+    while (pending.len()) {
+        auto gid = pending.popBack();
+        if (gid >= numGlyphs or keep[gid])
+            continue;
+        keep[gid] = true;
+        _glyphComponents(_glyphData(font, gid), pending);
+    }
+
+    // Unused glyphs become empty, the 'loca' table is always rebuilt
+    // with the long format.
+    Io::BufferWriter glyf;
+    Io::BufferWriter loca;
+    Io::BEmit glyfEmit{glyf};
+    Io::BEmit locaEmit{loca};
+
+    for (usize gid = 0; gid < numGlyphs; gid++) {
+        locaEmit.writeU32be(glyf.bytes().len());
+        if (not keep[gid])
+            continue;
+        glyfEmit.writeBytes(_glyphData(font, gid));
+        while (glyf.bytes().len() % 4)
+            glyfEmit.writeU8be(0);
+    }
+    locaEmit.writeU32be(glyf.bytes().len());
+
+    Buf<Byte> head = font._head.bytes();
+    if (head.len() < 54)
+        return Error::invalidData("truncated head table");
+    fill(mutSub(head, 8, 12), Byte{0}); // checkSumAdjustment
+    head[50] = 0;
+    head[51] = 1; // indexToLocFormat
+
+    struct Table {
+        Str tag;
+        Bytes data;
+    };
+
+    Vec<Table> tables;
+    for (auto table : font.iterTables()) {
+        if (not contains(SUBSET_TABLES, table.tag))
+            continue;
+
+        Bytes data = sub(font._slice, table.offset, table.offset + table.length);
+        if (table.tag == "glyf")
+            data = glyf.bytes();
+        else if (table.tag == "loca")
+            data = loca.bytes();
+        else if (table.tag == "head")
+            data = head;
+        tables.pushBack({table.tag, data});
+    }
+
+    sort(tables, [](auto const& a, auto const& b) {
+        return a.tag <=> b.tag;
+    });
+
+    // MARK: Table Directory ---------------------------------------------------
+
+    u16 numTables = tables.len();
+    u16 entrySelector = 0;
+    while ((2u << entrySelector) <= numTables)
+        entrySelector++;
+    u16 searchRange = (1u << entrySelector) * 16;
+
+    Io::BufferWriter out;
+    Io::BEmit e{out};
+    e.writeU32be(0x00010000);
+    e.writeU16be(numTables);
+    e.writeU16be(searchRange);
+    e.writeU16be(entrySelector);
+    e.writeU16be(numTables * 16 - searchRange);
+
+    usize offset = 12 + numTables * 16;
+    usize headOffset = 0;
+    for (auto const& table : tables) {
+        if (table.tag == "head")
+            headOffset = offset;
+        e.writeStr(table.tag);
+        e.writeU32be(_checksum(table.data));
+        e.writeU32be(offset);
+        e.writeU32be(table.data.len());
+        offset += alignUp(table.data.len(), 4);
+    }
+
+    for (auto const& table : tables) {
+        e.writeBytes(table.data);
+        while (out.bytes().len() % 4)
+            e.writeU8be(0);
+    }
+
+    auto result = out.take();
+    u32 adjustment = 0xB1B0AFBA - _checksum(result);
+    for (usize i = 0; i < 4; i++)
+        result[headOffset + 8 + i] = (adjustment >> (24 - i * 8)) & 0xff;
+
+    return Ok(std::move(result));
+}
+
+} // namespace Ttf
@@ -128,6 +128,40 @@ struct Cmap : public Io::BChunk {
             return Text::Glyph(0);
         }
 
+        // Call `f` with the first and last code point of each range the table maps.
+        void forEachRange(auto f) const {
+            if (type == 4) {
+                u16 segCountX2 = begin().skip(6).nextU16be();
+                u16 segCount = segCountX2 / 2;
+
+                for (usize i = 0; i < segCount; i++) {
+                    auto s = begin().skip(14);
+
+                    u16 endCode = s.skip(i * 2).peekU16be();
+
+                    // + 2 for reserved padding
+                    u16 startCode = s.skip(segCountX2 + 2).peekU16be();
+
+                    // NOTE: The last segment is only there to end the table.
+                    if (startCode == 0xFFFF)
+                        continue;
+
+                    f((Rune)startCode, (Rune)endCode);
+                }
+            } else if (type == 12) {
+                auto s = begin().skip(12);
+                u32 nGroups = s.nextU32be();
+
+                for (usize i = 0; i < nGroups; i++) {
+                    u32 startCode = s.nextU32be();
+                    u32 endCode = s.nextU32be();
+                    s.skip(4); // glyphOffset
+
+                    f((Rune)startCode, (Rune)endCode);
+                }
+            }
+        }
+
         Map<u16, u16> extractMapping() {
             if (type == 4) {
                 return _extractMappingForType4();
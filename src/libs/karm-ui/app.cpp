@@ -11,8 +11,9 @@
 
 namespace Karm::Ui {
 
-Async::Task<> runAsync(Sys::Context&, Child root) {
+Async::Task<> runAsync(Sys::Context& ctx, Child root) {
     auto host = co_try$(_Embed::makeHost(root));
+    host->_traceLayout = Sys::useArgs(ctx).has("--trace-layout");
     co_return co_await host->runAsync();
 }
 
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <karm-base/limits.h>
+#include <karm-base/opt.h>
+#include <karm-base/vec.h>
+#include <karm-math/rect.h>
+
+namespace Karm::Ui {
+
+// Regions of the window waiting to be repainted.
+//
+// Every region costs a traversal of the whole tree, so regions that
+// overlap or are close to each other are merged as long as the pixels
+// painted in excess are cheaper than that traversal.
+struct Damage {
+    // What a traversal of the tree costs, in painted pixels.
+    static constexpr isize REGION_COST = 64 * 64;
+
+    // Past this many regions, the cheapest ones are merged whatever the cost.
+    static constexpr usize MAX_REGIONS = 16;
+
+    Vec<Math::Recti> _regions;
+
+    static isize _area(Math::Recti r) {
+        return r.width * r.height;
+    }
+
+    // Pixels painted in excess by merging the two regions,
+    // minus the traversal saved.
+    static isize _cost(Math::Recti a, Math::Recti b) {
+        isize overlap = a.colide(b) ? _area(a.clipTo(b)) : 0;
+        return _area(a.mergeWith(b)) - (_area(a) + _area(b) - overlap) - REGION_COST;
+    }
+
+    void add(Math::Recti r) {
+        if (r.width <= 0 or r.height <= 0)
+            return;
+
+        while (true) {
+            Opt<usize> best;
+            isize bestCost = 0;
+            for (usize i = 0; i < _regions.len(); i++) {
+                isize cost = _cost(r, _regions[i]);
+                if ((cost <= 0 or r.colide(_regions[i])) and
+                    (not best or cost < bestCost)) {
+                    best = i;
+                    bestCost = cost;
+                }
+            }
+
+            if (not best)
+                break;
+
+            // NOTE: The merged region might now reach other ones.
+            r = r.mergeWith(_regions.removeAt(*best));
+        }
+
+        _regions.pushBack(r);
+
+        if (_regions.len() > MAX_REGIONS)
+            _mergeCheapest();
+    }
+
+    void _mergeCheapest() {
+        usize a = 0, b = 1;
+        isize bestCost = Limits<isize>::MAX;
+        for (usize i = 0; i < _regions.len(); i++) {
+            for (usize j = i + 1; j < _regions.len(); j++) {
+                isize cost = _cost(_regions[i], _regions[j]);
+                if (cost < bestCost) {
+                    a = i;
+                    b = j;
+                    bestCost = cost;
+                }
+            }
+        }
+
+        auto merged = _regions[a].mergeWith(_regions[b]);
+        _regions.removeAt(b);
+        _regions.removeAt(a);
+        add(merged);
+    }
+
+    Slice<Math::Recti> regions() const {
+        return _regions;
+    }
+
+    void clear() {
+        _regions.clear();
+    }
+
+    explicit operator bool() const {
+        return _regions.len() > 0;
+    }
+};
+
+} // namespace Karm::Ui
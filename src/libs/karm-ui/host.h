@@ -6,6 +6,7 @@
 #include <karm-sys/time.h>
 #include <karm-text/loader.h>
 
+#include "damage.h"
 #include "node.h"
 
 namespace Karm::Ui {
@@ -17,7 +18,10 @@ struct Host : public Node {
     Child _root;
     Opt<Res<>> _res;
     Gfx::CpuCanvas _g;
-    Vec<Math::Recti> _dirty;
+    Damage _damage;
+
+    // Log how many sizes each layout pass had to query.
+    bool _traceLayout = false;
 
     bool _shouldLayout{};
     bool _shouldAnimate{};
@@ -59,15 +63,12 @@ struct Host : public Node {
 
     void paint() {
         _g.begin(mutPixels());
-
-        for (auto& d : _dirty) {
-            paint(_g, d);
-        }
-
+        for (auto& r : _damage.regions())
+            paint(_g, r);
         _g.end();
 
-        flip(_dirty);
-        _dirty.clear();
+        flip(_damage.regions());
+        _damage.clear();
     }
 
     void layout(Math::Recti r) override {
@@ -80,7 +81,7 @@ struct Host : public Node {
 
     void bubble(App::Event& event) override {
         if (auto e = event.is<Node::PaintEvent>()) {
-            _dirty.pushBack(e->bound);
+            _damage.add(e->bound);
             event.accept();
         } else if (auto e = event.is<Node::LayoutEvent>()) {
             _shouldLayout = true;
@@ -128,16 +129,17 @@ struct Host : public Node {
             }
 
             if (_shouldLayout) {
+                SizeCache::resetStats();
                 layout(bound());
+                if (_traceLayout)
+                    logInfo("layout: {} size queries, {} computed", SizeCache::queries, SizeCache::computed);
                 _shouldLayout = false;
                 _shouldAnimate = true;
-                _dirty.pushBack(bound());
+                _damage.add(bound());
             }
 
-            if (_dirty.len() > 0) {
+            if (_damage)
                 Host::paint();
-                _dirty.clear();
-            }
 
             co_trya$(waitAsync(nextFrameScheduled ? nextFrame : Instant::endOfTime()));
             nextFrameScheduled = false;
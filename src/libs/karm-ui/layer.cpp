@@ -0,0 +1,149 @@
+#include <karm-base/lru.h>
+#include <karm-gfx/cpu/canvas.h>
+
+#include "layer.h"
+
+namespace Karm::Ui {
+
+// MARK: Tiles -----------------------------------------------------------------
+
+static constexpr isize TILE_SIZE = 256;
+
+// Tiles of every layer share the same budget, the least recently
+// used ones are dropped first.
+static constexpr usize TILE_BUDGET = (64 * 1024 * 1024) / (TILE_SIZE * TILE_SIZE * 4);
+
+// The id of the layer and the position of the tile in the layer.
+using TileKey = Tuple<usize, usize>;
+
+static Lru<TileKey, Rc<Gfx::Surface>>& _tiles() {
+    static Lru<TileKey, Rc<Gfx::Surface>> tiles{TILE_BUDGET};
+    return tiles;
+}
+
+static isize _tileOf(isize v) {
+    return v >= 0 ? v / TILE_SIZE : -((-v + TILE_SIZE - 1) / TILE_SIZE);
+}
+
+// Tiles are rendered one to one with the pixels of the subtree, they can
+// only be blitted as is through a whole pixel translation. Anything else
+// (a scale for hidpi, a rotation) would resample them.
+// NOTE: Scroll snaps its offset to whole pixels for this reason.
+static bool _canBlitTiles(Opt<Math::Trans2f> trans) {
+    if (not trans)
+        return false;
+    return trans->xx == 1 and trans->xy == 0 and
+           trans->yx == 0 and trans->yy == 1 and
+           trans->ox == Math::floor(trans->ox) and
+           trans->oy == Math::floor(trans->oy);
+}
+
+static void _forEachTile(Math::Recti r, auto f) {
+    if (r.width <= 0 or r.height <= 0)
+        return;
+
+    for (isize y = _tileOf(r.top()); y <= _tileOf(r.bottom() - 1); y++)
+        for (isize x = _tileOf(r.start()); x <= _tileOf(r.end() - 1); x++)
+            f(Math::Vec2i{x, y});
+}
+
+// MARK: Layer -----------------------------------------------------------------
+
+struct Layer : public ProxyNode<Layer> {
+    static inline usize _nextId = 0;
+
+    usize _id = _nextId++;
+    isize _overflow;
+
+    // Where tiles might have been rendered since the last layout.
+    Math::Recti _area{};
+
+    Layer(Child child, isize overflow)
+        : ProxyNode(std::move(child)), _overflow(overflow) {}
+
+    ~Layer() {
+        _invalidate(_area);
+    }
+
+    Math::Recti _extent() {
+        return bound().grow(_overflow);
+    }
+
+    TileKey _key(Math::Vec2i tile) {
+        return {_id, ((usize)(u32)tile.x << 32) | (u32)tile.y};
+    }
+
+    void _invalidate(Math::Recti r) {
+        _forEachTile(r, [&](Math::Vec2i tile) {
+            _tiles().del(_key(tile));
+        });
+    }
+
+    Rc<Gfx::Surface> _render(Math::Vec2i tile) {
+        Math::Recti rect = {tile * TILE_SIZE, {TILE_SIZE, TILE_SIZE}};
+
+        auto surface = Gfx::Surface::alloc({TILE_SIZE, TILE_SIZE});
+        surface->mutPixels().clear(Gfx::ALPHA);
+
+        // NOTE: Tiles are transparent, subpixel text would leave colored
+        //       fringes once they are composited.
+        Gfx::CpuCanvas g;
+        g.lcdLayout(NONE);
+        g.begin(surface->mutPixels());
+        g.origin(-rect.xy.cast<f64>());
+        g.clip(_extent());
+        child().paint(g, rect.clipTo(_extent()));
+        g.end();
+
+        return surface;
+    }
+
+    void reconcile(Layer& o) override {
+        _overflow = o._overflow;
+        ProxyNode<Layer>::reconcile(o);
+        _invalidate(_area);
+    }
+
+    void paint(Gfx::Canvas& g, Math::Recti r) override {
+        if (not _canBlitTiles(g.currentTransform())) {
+            child().paint(g, r);
+            return;
+        }
+
+        _forEachTile(r.clipTo(_extent()), [&](Math::Vec2i tile) {
+            Rc<Gfx::Surface> surface = _tiles().access(_key(tile), [&] {
+                return _render(tile);
+            });
+            g.blit(tile * TILE_SIZE, surface->pixels());
+        });
+    }
+
+    void bubble(App::Event& e) override {
+        if (auto pe = e.is<Node::PaintEvent>()) {
+            _invalidate(pe->bound.grow(_overflow));
+        } else if (e.is<Node::LayoutEvent>()) {
+            // NOTE: The subtree is about to be rebuilt.
+            _invalidate(_area);
+        }
+
+        ProxyNode<Layer>::bubble(e);
+    }
+
+    void layout(Math::Recti r) override {
+        ProxyNode<Layer>::layout(r);
+
+        // NOTE: Tiles are positioned in the space of the subtree,
+        //       they only survive a layout leaving it in place.
+        auto extent = _extent();
+        if (extent.xy != _area.xy or extent.wh != _area.wh) {
+            _invalidate(_area);
+            _area = extent;
+        }
+    }
+};
+
+Child layer(Child child, isize overflow) {
+    return makeRc<Layer>(std::move(child), overflow);
+}
+
+} // namespace Karm::Ui
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "node.h"
+
+namespace Karm::Ui {
+
+// MARK: Layer -----------------------------------------------------------------
+
+// Keeps the rendering of a subtree in cached tiles, so moving it around
+// (scrolling, sliding in, ...) only blits pixels and rasterizes the tiles
+// that were never rendered or were damaged since. When painted through
+// anything but a whole pixel translation, the subtree is painted directly.
+//
+// `overflow` is how far outside of its bound the subtree paints, for
+// example its shadow. Content reading back the pixels behind it, like a
+// background filter, only sees the layer itself.
+Child layer(Child child, isize overflow = 0);
+
+inline auto layer(isize overflow = 0) {
+    return [=](Child child) {
+        return layer(child, overflow);
+    };
+}
+
+} // namespace Karm::Ui
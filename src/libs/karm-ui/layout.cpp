@@ -360,6 +360,19 @@ Child aspectRatio(f64 ratio, Child child) {
 struct StackLayout : public GroupNode<StackLayout> {
     using GroupNode::GroupNode;
 
+    SizeCache _sizes;
+
+    void reconcile(StackLayout& o) override {
+        GroupNode::reconcile(o);
+        _sizes.clear();
+    }
+
+    void bubble(App::Event& e) override {
+        if (e.is<Node::LayoutEvent>())
+            _sizes.clear();
+        GroupNode::bubble(e);
+    }
+
     void event(App::Event& e) override {
         if (e.accepted())
             return;
@@ -372,16 +385,18 @@ struct StackLayout : public GroupNode<StackLayout> {
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
-        isize w{};
-        isize h{};
-
-        for (auto& child : children()) {
-            auto childSize = child->size(s, hint);
-            w = max(w, childSize.x);
-            h = max(h, childSize.y);
-        }
+        return _sizes.get(s, hint, [&] {
+            isize w{};
+            isize h{};
+
+            for (auto& child : children()) {
+                auto childSize = child->size(s, hint);
+                w = max(w, childSize.x);
+                h = max(h, childSize.y);
+            }
 
-        return {w, h};
+            return Math::Vec2i{w, h};
+        });
     }
 };
 
@@ -395,6 +410,7 @@ struct FlowLayout : public GroupNode<FlowLayout> {
     using GroupNode::GroupNode;
 
     FlowStyle _style;
+    SizeCache _sizes;
 
     FlowLayout(FlowStyle style, Children children)
         : GroupNode(children), _style(style) {}
@@ -402,17 +418,25 @@ struct FlowLayout : public GroupNode<FlowLayout> {
     void reconcile(FlowLayout& o) override {
         _style = o._style;
         GroupNode::reconcile(o);
+        _sizes.clear();
+    }
+
+    void bubble(App::Event& e) override {
+        if (e.is<Node::LayoutEvent>())
+            _sizes.clear();
+        GroupNode::bubble(e);
     }
 
-    f64 _computeGrowUnit(Math::Recti r) {
+    f64 _computeGrowUnit(Math::Recti r, Slice<Math::Vec2i> sizes) {
         f64 total = 0;
         f64 grows = 0;
 
-        for (auto& child : children()) {
+        for (usize i = 0; i < children().len(); i++) {
+            auto& child = children()[i];
             if (child.is<Grow>()) {
                 grows += child.unwrap<Grow>().grow();
             } else {
-                total += _style.flow.getX(child->size(r.size(), Hint::MIN));
+                total += _style.flow.getX(sizes[i]);
             }
         }
 
@@ -424,12 +448,19 @@ struct FlowLayout : public GroupNode<FlowLayout> {
     void layout(Math::Recti r) override {
         _bound = r;
 
-        f64 growUnit = _computeGrowUnit(r);
+        // NOTE: Each child is measured once, both passes need its size.
+        Vec<Math::Vec2i> sizes;
+        sizes.ensure(children().len());
+        for (auto& child : children())
+            sizes.pushBack(child->size(r.size(), Hint::MIN));
+
+        f64 growUnit = _computeGrowUnit(r, sizes);
         f64 start = _style.flow.getStart(r);
 
-        for (auto& child : children()) {
+        for (usize i = 0; i < children().len(); i++) {
+            auto& child = children()[i];
             Math::Recti inner = {};
-            auto childSize = child->size(r.size(), Hint::MIN);
+            auto childSize = sizes[i];
 
             inner = _style.flow.setStart(inner, (isize)start);
             if (child.is<Grow>()) {
@@ -447,27 +478,29 @@ struct FlowLayout : public GroupNode<FlowLayout> {
     }
 
     Math::Vec2i size(Math::Vec2i s, Hint hint) override {
-        isize w{};
-        isize h{hint == Hint::MAX ? _style.flow.getY(s) : 0};
-        bool grow = false;
-
-        for (auto& child : children()) {
-            if (child.is<Grow>())
-                grow = true;
-
-            auto childSize = child->size(s, Hint::MIN);
-            w += _style.flow.getX(childSize);
-            h = max(h, _style.flow.getY(childSize));
-        }
+        return _sizes.get(s, hint, [&] {
+            isize w{};
+            isize h{hint == Hint::MAX ? _style.flow.getY(s) : 0};
+            bool grow = false;
+
+            for (auto& child : children()) {
+                if (child.is<Grow>())
+                    grow = true;
+
+                auto childSize = child->size(s, Hint::MIN);
+                w += _style.flow.getX(childSize);
+                h = max(h, _style.flow.getY(childSize));
+            }
 
-        w += _style.gaps * (max(1uz, children().len()) - 1);
-        if (grow and hint == Hint::MAX) {
-            w = max(_style.flow.getX(s), w);
-        }
+            w += _style.gaps * (max(1uz, children().len()) - 1);
+            if (grow and hint == Hint::MAX) {
+                w = max(_style.flow.getX(s), w);
+            }
 
-        return _style.flow.orien() == Math::Orien::HORIZONTAL
-                   ? Math::Vec2i{w, h}
-                   : Math::Vec2i{h, w};
+            return _style.flow.orien() == Math::Orien::HORIZONTAL
+                       ? Math::Vec2i{w, h}
+                       : Math::Vec2i{h, w};
+        });
     }
 };
 
@@ -90,6 +90,58 @@ always_inline auto operator|(Decorator auto decorator, Decorator auto decorator2
     };
 }
 
+// MARK: SizeCache -------------------------------------------------------------
+
+// Layouts ask their children for their size several times per pass and
+// every query walks down the whole subtree. Nodes with costly sizes keep
+// the answers to the last few queries until their content changes, which
+// they learn from a LayoutEvent bubbling up through them or a reconcile.
+struct SizeCache {
+    static constexpr usize SLOTS = 4;
+
+    // Queries reaching a cache and queries it had to compute, since the
+    // last reset. The host reports them after each layout with --trace-layout.
+    static inline usize queries = 0;
+    static inline usize computed = 0;
+
+    struct _Slot {
+        Math::Vec2i s;
+        Hint hint;
+        Math::Vec2i size;
+    };
+
+    Vec<_Slot> _slots;
+    usize _next = 0;
+
+    Math::Vec2i get(Math::Vec2i s, Hint hint, auto compute) {
+        queries++;
+        for (auto& slot : _slots) {
+            if (slot.s == s and slot.hint == hint)
+                return slot.size;
+        }
+
+        computed++;
+        auto size = compute();
+        if (_slots.len() < SLOTS) {
+            _slots.pushBack({s, hint, size});
+        } else {
+            _slots[_next] = {s, hint, size};
+            _next = (_next + 1) % SLOTS;
+        }
+        return size;
+    }
+
+    void clear() {
+        _slots.clear();
+        _next = 0;
+    }
+
+    static void resetStats() {
+        queries = 0;
+        computed = 0;
+    }
+};
+
 // MARK: LeafNode --------------------------------------------------------------
 
 template <typename Crtp>
@@ -2,6 +2,7 @@
 
 #include "dialog.h"
 #include "funcs.h"
+#include "layer.h"
 
 namespace Karm::Ui {
 
@@ -20,6 +21,9 @@ void closePopover(Node& n) {
     bubble<ClosePopoverEvent>(n);
 }
 
+// Room left around popovers for their shadow.
+static constexpr isize POPOVER_OVERFLOW = 16;
+
 struct PopoverLayer : public ProxyNode<PopoverLayer> {
     Opt<Child> _popover;
     Opt<Child> _shouldPopover;
@@ -36,7 +40,7 @@ struct PopoverLayer : public ProxyNode<PopoverLayer> {
     void _showPopover(Child child, Math::Vec2i at) {
         // We need to defer showing the dialog until the next frame,
         // otherwise replacing the dialog might cause some use after free down the tree
-        _shouldPopover = child;
+        _shouldPopover = layer(child, POPOVER_OVERFLOW);
         _popoverAt = at;
         shouldLayout(*this);
     }
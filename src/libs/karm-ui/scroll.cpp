@@ -1,6 +1,7 @@
 #include "scroll.h"
 
 #include "anim.h"
+#include "layer.h"
 
 namespace Karm::Ui {
 
@@ -32,6 +33,13 @@ struct Scroll : public ProxyNode<Scroll> {
         }
     }
 
+    // The scroll offset snapped to a whole pixel, the content is painted
+    // there while the animation goes through fractional offsets so layers
+    // under it can keep blitting their tiles.
+    Math::Vec2i _offset() {
+        return _scroll.round().cast<isize>();
+    }
+
     bool canHScroll() {
         return (_orient == Math::Orien::HORIZONTAL or _orient == Math::Orien::BOTH) and child().bound().width > bound().width;
     }
@@ -51,8 +59,8 @@ struct Scroll : public ProxyNode<Scroll> {
     void paint(Gfx::Canvas& g, Math::Recti r) override {
         g.push();
         g.clip(_bound);
-        g.origin(_scroll);
-        r.xy = r.xy - _scroll.cast<isize>();
+        g.origin(_offset().cast<f64>());
+        r.xy = r.xy - _offset();
         child().paint(g, r);
 
         g.pop();
@@ -95,9 +103,9 @@ struct Scroll : public ProxyNode<Scroll> {
             if (bound().contains(me->pos)) {
                 _mouseIn = true;
 
-                me->pos = me->pos - _scroll.cast<isize>();
+                me->pos = me->pos - _offset();
                 ProxyNode<Scroll>::event(e);
-                me->pos = me->pos + _scroll.cast<isize>();
+                me->pos = me->pos + _offset();
 
                 if (not e.accepted()) {
                     if (me->type == App::MouseEvent::SCROLL) {
@@ -132,7 +140,7 @@ struct Scroll : public ProxyNode<Scroll> {
 
     void bubble(App::Event& e) override {
         if (auto pe = e.is<Node::PaintEvent>()) {
-            pe->bound.xy = pe->bound.xy + _scroll.cast<isize>();
+            pe->bound.xy = pe->bound.xy + _offset();
             pe->bound = pe->bound.clipTo(bound());
         }
 
@@ -178,16 +186,19 @@ struct Scroll : public ProxyNode<Scroll> {
     }
 };
 
+// NOTE: The content is kept in a layer, scrolling only rasterizes
+//       the parts of it that were never shown before.
+
 Child vhscroll(Child child) {
-    return makeRc<Scroll>(child, Math::Orien::BOTH);
+    return makeRc<Scroll>(layer(child), Math::Orien::BOTH);
 }
 
 Child hscroll(Child child) {
-    return makeRc<Scroll>(child, Math::Orien::HORIZONTAL);
+    return makeRc<Scroll>(layer(child), Math::Orien::HORIZONTAL);
 }
 
 Child vscroll(Child child) {
-    return makeRc<Scroll>(child, Math::Orien::VERTICAL);
+    return makeRc<Scroll>(layer(child), Math::Orien::VERTICAL);
 }
 
 // MARK: Clip ------------------------------------------------------------------
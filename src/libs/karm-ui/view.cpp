@@ -1,6 +1,7 @@
 #include <karm-text/loader.h>
 
 #include "box.h"
+#include "layer.h"
 #include "view.h"
 
 namespace Karm::Ui {
@@ -222,6 +223,7 @@ Text::ProseStyle TextStyles::codeSmall() {
 
 struct Text : public View<Text> {
     Rc<Karm::Text::Prose> _prose;
+    SizeCache _sizes;
 
     Text(Rc<Karm::Text::Prose> prose)
         : _prose(std::move(prose)) {}
@@ -231,6 +233,7 @@ struct Text : public View<Text> {
 
     void reconcile(Text& o) override {
         _prose = std::move(o._prose);
+        _sizes.clear();
     }
 
     void paint(Gfx::Canvas& g, Math::Recti) override {
@@ -245,9 +248,11 @@ struct Text : public View<Text> {
         View<Text>::layout(bound);
     }
 
-    Math::Vec2i size(Math::Vec2i s, Hint) override {
-        auto size = _prose->layout(Au{s.width});
-        return size.ceil().cast<isize>();
+    Math::Vec2i size(Math::Vec2i s, Hint hint) override {
+        return _sizes.get(s, hint, [&] {
+            auto size = _prose->layout(Au{s.width});
+            return size.ceil().cast<isize>();
+        });
     }
 };
 
@@ -384,13 +389,14 @@ struct SceneCanvas : public View<SceneCanvas> {
         g.origin(_bound.xy.cast<f64>());
         g.scale(_bound.size().cast<f64>() / _scene->bound().size().cast<f64>());
 
+        // Only the part of the scene under the damaged rect is painted.
         Math::Trans2f trans;
         trans = trans.translated(-_bound.xy.cast<f64>());
-        trans = trans.scaled(_bound.size().cast<f64>() / _scene->bound().size().cast<f64>());
+        trans = trans.scaled(_scene->bound().size().cast<f64>() / _bound.size().cast<f64>());
 
-        auto rectInScene = trans.inverse().apply(rect.cast<f64>()).bound();
+        auto rectInScene = trans.apply(rect.clipTo(_bound).cast<f64>()).bound();
 
-        _scene->paint(g, Math::Rectf::MAX, _options);
+        _scene->paint(g, rectInScene, _options);
 
         g.pop();
     }
@@ -405,7 +411,7 @@ struct SceneCanvas : public View<SceneCanvas> {
 };
 
 Child canvas(Rc<Scene::Node> child, Scene::PaintOptions options) {
-    return makeRc<SceneCanvas>(std::move(child), options);
+    return layer(makeRc<SceneCanvas>(std::move(child), options));
 }
 
 // MARK: Filter ----------------------------------------------------------------
@@ -0,0 +1,104 @@
+#include <karm-gc/heap.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/file.h>
+#include <karm-sys/time.h>
+#include <vaev-dom/html/parser.h>
+
+using namespace Vaev;
+
+static constexpr usize REPEAT = 2000;
+
+// MARK: Samples ---------------------------------------------------------------
+
+// Stand-in for a real page when no sample is given on the command line,
+// mixes the tags, attributes and character references of a typical article.
+static String syntheticSample() {
+    StringBuilder sb;
+    sb.append("<!DOCTYPE html><html lang=en><head><meta charset=utf-8><title>Sample</title>"
+              "<link rel=stylesheet href=style.css></head><body>"s);
+
+    for (usize i = 0; i < REPEAT; i++) {
+        sb.append("<div class=\"section\" id=\"s"s);
+        sb.append(Io::format("{}", i).str());
+        sb.append("\" data-index=\"1\">"
+                  "<h2 title=\"Heading\">Heading &amp; subtitle</h2>"
+                  "<p style=\"color: red\">Lorem ipsum &mdash; dolor sit amet, <a href=\"#top\" target=_blank>consectetur</a> "
+                  "adipiscing elit &copy; 2024 &nbsp;<span lang=fr>sed do</span> <em>eiusmod</em>.</p>"
+                  "<ul><li><input type=checkbox checked disabled> one</li><li><img src=a.png alt=\"\" width=10 height=10> two</li></ul>"
+                  "<table><tr><td colspan=2>cell &lt;1&gt;</td><td rowspan=1>cell</td></tr></table>"
+                  "</div>"s);
+    }
+
+    sb.append("</body></html>"s);
+    return sb.take();
+}
+
+// MARK: Lexer -----------------------------------------------------------------
+
+// Resolves tag and attribute names like the tree builder does,
+// without building a tree.
+struct CountingSink : public Dom::HtmlSink {
+    usize tokens = 0;
+    usize unknown = 0;
+
+    void accept(Dom::HtmlToken const& token) override {
+        tokens++;
+        if (token.type != Dom::HtmlToken::START_TAG and token.type != Dom::HtmlToken::END_TAG)
+            return;
+
+        if (not TagName::tryMake(token.name, HTML))
+            unknown++;
+
+        for (auto const& attr : token.attrs)
+            if (not AttrName::tryMake(attr.name, HTML))
+                unknown++;
+    }
+};
+
+static void benchLexer(Str name, Str html) {
+    CountingSink sink;
+    Dom::HtmlLexer lexer;
+    lexer.bind(sink);
+
+    auto start = Sys::now();
+    for (auto r : iterRunes(html))
+        lexer.consume(r);
+    lexer.consume('\3', true);
+    auto elapsed = Sys::now() - start;
+
+    auto tokensPerSecond = sink.tokens / max(elapsed.toUSecs() / 1e6, 1e-6);
+    Sys::println("{} lexer: {} tokens in {} ({.0} tokens/s, {} unknown names)", name, sink.tokens, elapsed, tokensPerSecond, sink.unknown);
+}
+
+// MARK: Parser ----------------------------------------------------------------
+
+static void benchParser(Str name, Str html) {
+    Gc::Heap gc;
+    auto dom = gc.alloc<Dom::Document>(Mime::Url());
+    Dom::HtmlParser parser{gc, dom};
+
+    auto start = Sys::now();
+    parser.write(html);
+    auto elapsed = Sys::now() - start;
+
+    auto bytesPerSecond = html.len() / max(elapsed.toUSecs() / 1e6, 1e-6);
+    Sys::println("{} parser: {} bytes in {} ({.0} bytes/s)", name, html.len(), elapsed, bytesPerSecond);
+}
+
+Async::Task<> entryPointAsync(Sys::Context& ctx) {
+    auto& args = Sys::useArgs(ctx);
+
+    if (args.len() == 0) {
+        auto html = syntheticSample();
+        benchLexer("synthetic", html);
+        benchParser("synthetic", html);
+    }
+
+    for (usize i = 0; i < args.len(); i++) {
+        auto html = co_try$(Sys::readAllUtf8(Mime::parseUrlOrPath(args[i])));
+        benchLexer(args[i], html);
+        benchParser(args[i], html);
+    }
+
+    co_return Ok();
+}
@@ -14,12 +14,16 @@ struct CharacterData : public Node {
         : _data(std::move(data)) {
     }
 
-    void appendData(String const& s) {
+    // NOTE: Text doesn't have a style of its own, only the box tree it's
+    //       part of has to be built again.
+    void appendData(Str s) {
         _data.append(s);
+        markDirty(Dirty::NONE);
     }
 
     void appendData(Rune rune) {
         _data.append(rune);
+        markDirty(Dirty::NONE);
     }
 
     Str data() const {
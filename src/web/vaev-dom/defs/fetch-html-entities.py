@@ -9,5 +9,6 @@ import requests
 url = "https://html.spec.whatwg.org/entities.json"
 r = requests.get(url)
 entities = json.loads(r.text)
-for k, v in entities.items():
+# NOTE: The lexer binary searches the entities, keep them sorted by name
+for k, v in sorted(entities.items()):
     print(f"ENTITY(\"{k}\", {', '.join(map(str, v['codepoints']))})")
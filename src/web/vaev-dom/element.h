@@ -55,6 +55,11 @@ struct Element : public Node {
     }
 
     void setAttribute(AttrName name, String value) {
+        // NOTE: Sibling selectors can depend on the attributes of the element.
+        if (auto parent = parentNode())
+            parent->_childrenChanged();
+        markDirty();
+
         if (name == Html::CLASS_ATTR) {
             for (auto class_ : iterSplit(value, ' ')) {
                 this->classList.add(class_);
@@ -1,3 +1,4 @@
+#include <karm-base/simd.h>
 #include <karm-logger/logger.h>
 
 #include "lexer.h"
@@ -15,13 +16,36 @@ struct Entity {
     }
 };
 
-[[maybe_unused]] static Array const ENTITIES = {
+// NOTE: Entities are sorted by name, so the ones sharing
+//       a prefix are next to each other.
+static Array const ENTITIES = {
 #define ENTITY(NAME, ...) \
     Entity{#NAME, (Rune[]){__VA_ARGS__ __VA_OPT__(, ) 0}},
 #include "../defs/ns-html-entities.inc"
 #undef ENTITY
 };
 
+// Index of the first entity whose name is not less than `name`.
+static usize _entityLowerBound(Str name) {
+    usize lo = 0;
+    usize hi = ENTITIES.len();
+    while (lo < hi) {
+        usize mid = lo + (hi - lo) / 2;
+        if (ENTITIES[mid].name < name)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static Entity _lookupEntity(Str name) {
+    auto i = _entityLowerBound(name);
+    if (i < ENTITIES.len() and ENTITIES[i].name == name)
+        return ENTITIES[i];
+    return {};
+}
+
 void HtmlLexer::_raise(Str msg) {
     logError("{}: {}", _state, msg);
 }
@@ -3234,22 +3258,22 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
         bool hasPartialMatch = false;
 
         auto computeMatchState = [&](StringBuilder prefix) {
-            // TODO: (performance) consider sorting entities lexicographically and binary search or using a trie
-
             prefix.append(rune);
 
             auto target = prefix.str();
 
+            // An exact match sorts first, followed by the longer
+            // entities it is a prefix of.
             auto bestMatch = Match::NO;
-            for (auto& entity : ENTITIES) {
-                auto match = startWith(entity.name, target);
+            auto i = _entityLowerBound(target);
+            if (i < ENTITIES.len() and ENTITIES[i].name == target) {
+                bestMatch = Match::YES;
+                i++;
+            }
 
-                if (match == Match::PARTIAL)
-                    hasPartialMatch = true;
+            if (i < ENTITIES.len() and startWith(ENTITIES[i].name, target) == Match::PARTIAL)
+                hasPartialMatch = true;
 
-                if (match == Match::YES)
-                    bestMatch = max(bestMatch, match);
-            };
             return bestMatch;
         };
 
@@ -3298,16 +3322,12 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
                 auto _tempWithUnexpandedEntity = _temp.str();
                 auto entityName = _Str<Utf8>(_tempWithUnexpandedEntity.begin(), matchedCharReferenceNoSemiColon.unwrap());
 
-                for (auto& entity : ENTITIES) {
-                    if (entityName == entity.name) {
-
-                        _temp.clear();
-                        _temp.append(Slice<Rune>::fromNullterminated(entity.runes));
+                if (auto entity = _lookupEntity(entityName)) {
+                    _temp.clear();
+                    _temp.append(Slice<Rune>::fromNullterminated(entity.runes));
 
-                        for (usize i = matchedCharReferenceNoSemiColon.unwrap(); i < _tempWithUnexpandedEntity.len(); ++i) {
-                            _temp.append(_tempWithUnexpandedEntity[i]);
-                        }
-                        break;
+                    for (usize i = matchedCharReferenceNoSemiColon.unwrap(); i < _tempWithUnexpandedEntity.len(); ++i) {
+                        _temp.append(_tempWithUnexpandedEntity[i]);
                     }
                 }
 
@@ -3347,12 +3367,9 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
             // Append one or two characters corresponding to the character reference name (as
             // given by the second column of the named character references
             // table) to the temporary buffer.
-            for (auto& entity : ENTITIES) {
-                if (_temp.str() == entity.name) {
-                    _temp.clear();
-                    _temp.append(Slice<Rune>::fromNullterminated(entity.runes));
-                    break;
-                }
+            if (auto entity = _lookupEntity(_temp.str())) {
+                _temp.clear();
+                _temp.append(Slice<Rune>::fromNullterminated(entity.runes));
             }
 
             // Flush code points consumed as a character reference. Switch to
@@ -3678,4 +3695,57 @@ void HtmlLexer::consume(Rune rune, bool isEof) {
     }
 }
 
+// MARK: Character Runs --------------------------------------------------------
+
+// Bytes that need the attention of the state machine in the text states,
+// they are all ASCII so they never show up inside a multibyte sequence.
+always_inline static bool _isRunDelimiter(char c) {
+    return c == '<' or c == '&' or c == '\r' or c == '\0';
+}
+
+// Length of the run of character data at the start of `str`.
+static usize _scanRun(Str str) {
+    usize i = 0;
+    for (; i + 16 <= str.len(); i += 16) {
+        u8x16 v;
+        memcpy(&v, str.buf() + i, sizeof(v));
+        auto hits = (u64x2)((v == '<') | (v == '&') | (v == '\r') | (v == '\0'));
+        if (hits[0] | hits[1])
+            break;
+    }
+
+    while (i < str.len() and not _isRunDelimiter(str[i]))
+        i++;
+
+    return i;
+}
+
+// States in which everything but the run delimiters is emitted as is.
+static bool _isTextState(HtmlLexer::State state) {
+    return state == HtmlLexer::DATA or
+           state == HtmlLexer::RCDATA or
+           state == HtmlLexer::RAWTEXT or
+           state == HtmlLexer::SCRIPT_DATA or
+           state == HtmlLexer::PLAINTEXT;
+}
+
+void HtmlLexer::write(Str str) {
+    Cursor<char> cursor = str;
+    while (not cursor.ended()) {
+        if (_isTextState(_state)) {
+            auto run = _scanRun({cursor.buf(), cursor.rem()});
+            if (run) {
+                auto chunk = cursor.next(run);
+                _emit(Str{chunk.buf(), chunk.len()});
+                continue;
+            }
+        }
+
+        Rune rune;
+        if (not Utf8::decodeUnit(rune, cursor))
+            return;
+        consume(rune);
+    }
+}
+
 } // namespace Vaev::Dom
@@ -11,6 +11,7 @@ namespace Vaev::Dom {
     TOKEN(END_TAG)           \
     TOKEN(COMMENT)           \
     TOKEN(CHARACTER)         \
+    TOKEN(CHARACTERS)        \
     TOKEN(END_OF_FILE)
 
 struct HtmlToken {
@@ -132,6 +133,12 @@ struct HtmlLexer {
         _emit();
     }
 
+    // Emits a run of character data as a single token.
+    void _emit(Str run) {
+        _begin(HtmlToken::CHARACTERS).data = run;
+        _emit();
+    }
+
     void _beginAttribute() {
         _ensure().attrs.emplaceBack();
     }
@@ -183,6 +190,10 @@ struct HtmlLexer {
     }
 
     void consume(Rune rune, bool isEof = false);
+
+    // Consumes a whole chunk of input, runs of plain character data
+    // are emitted at once instead of rune by rune.
+    void write(Str str);
 };
 
 #undef FOREACH_TOKEN
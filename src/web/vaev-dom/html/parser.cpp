@@ -88,6 +88,35 @@ void HtmlParser::_acknowledgeSelfClosingFlag(HtmlToken const&) {
 }
 
 // 13.2.6 MARK: Tree construction
+// The lexer never puts a U+0000 NULL in a run, so in the "in body" and
+// "text" insertion modes all the characters of a run go through the
+// same rules and are inserted at once. Anywhere else the run is split
+// back into character tokens.
+void HtmlParser::_acceptCharacters(Str run) {
+    bool inHtmlContent = isEmpty(_openElements) or _currentElement()->tagName.ns == HTML;
+
+    if (inHtmlContent and _insertionMode == Mode::IN_BODY) {
+        _reconstructActiveFormattingElements();
+        _insertCharacters(run);
+
+        for (auto r : iterRunes(run)) {
+            if (r != '\t' and r != '\n' and r != '\f' and r != '\r' and r != ' ') {
+                _framesetOk = false;
+                break;
+            }
+        }
+        return;
+    }
+
+    if (inHtmlContent and _insertionMode == Mode::TEXT) {
+        _insertCharacters(run);
+        return;
+    }
+
+    for (auto r : iterRunes(run))
+        accept(HtmlToken{.type = HtmlToken::CHARACTER, .rune = r});
+}
+
 // https://html.spec.whatwg.org/multipage/parsing.html#tree-construction
 
 // 13.2.6.1 MARK: Creating and inserting nodes
@@ -287,6 +316,23 @@ void HtmlParser::_insertACharacter(Rune c) {
     }
 }
 
+// Same as inserting every character of `run` one after the other.
+void HtmlParser::_insertCharacters(Str run) {
+    auto location = _apropriatePlaceForInsertingANode();
+
+    if (location.parent->nodeType() == NodeType::DOCUMENT)
+        return;
+
+    auto lastChild = location.lastChild();
+    if (lastChild and lastChild->nodeType() == NodeType::TEXT) {
+        lastChild->is<Text>()->appendData(run);
+    } else {
+        auto text = _heap.alloc<Text>(""s);
+        text->appendData(run);
+        location.insert(text);
+    }
+}
+
 // https://html.spec.whatwg.org/multipage/parsing.html#insert-a-comment
 void HtmlParser::_insertAComment(HtmlToken const& t) {
     // 1. Let data be the data given in the comment token being processed.
@@ -2307,6 +2353,11 @@ void HtmlParser::_acceptIn(Mode mode, HtmlToken const& t) {
 
 // https://html.spec.whatwg.org/multipage/parsing.html#tree-construction
 void HtmlParser::accept(HtmlToken const& t) {
+    if (t.type == HtmlToken::CHARACTERS) {
+        _acceptCharacters(t.data);
+        return;
+    }
+
     // If the stack of open elements is empty
     // If the adjusted current node is an element in the HTML namespace
     // If the adjusted current node is a MathML text integration point and the token is a start tag whose tag name is neither "mglyph" nor "malignmark"
@@ -130,6 +130,8 @@ struct HtmlParser : public HtmlSink {
 
     void _insertACharacter(Rune c);
 
+    void _insertCharacters(Str run);
+
     void _insertAComment(HtmlToken const& t);
 
     void _resetTheInsertionModeAppropriately();
@@ -234,11 +236,12 @@ struct HtmlParser : public HtmlSink {
 
     void _acceptIn(Mode mode, HtmlToken const& t);
 
+    void _acceptCharacters(Str run);
+
     void accept(HtmlToken const& t) override;
 
     void write(Str str) {
-        for (auto r : iterRunes(str))
-            _lexer.consume(r);
+        _lexer.write(str);
         // NOTE: '\3' (End of Text) is used here as a placeholder so we are directed to the EOF case
         _lexer.consume('\3', true);
     }
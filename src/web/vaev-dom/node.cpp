@@ -20,6 +20,24 @@ Gc::Ptr<Document> Node::ownerDocument() {
     return nullptr;
 }
 
+void Node::markDirty(Dirty dirty) {
+    _dirty.set(dirty);
+
+    for (auto curr = parentNode(); curr; curr = curr->parentNode()) {
+        // NOTE: The ancestors of a dirty node are already dirty themselves.
+        if (curr->_dirty.has(Dirty::SUBTREE))
+            break;
+        curr->_dirty.set(Dirty::SUBTREE);
+    }
+}
+
+void Node::clean() {
+    if (_dirty.has(Dirty::SUBTREE))
+        for (auto child = firstChild(); child; child = child->nextSibling())
+            child->clean();
+    _dirty.clear();
+}
+
 void Node::repr(Io::Emit& e) const {
     e("({}", nodeType());
     _repr(e);
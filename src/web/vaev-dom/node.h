@@ -1,5 +1,6 @@
 #pragma once
 
+#include <karm-base/enum.h>
 #include <karm-mime/url.h>
 
 #include "_forward.h"
@@ -25,8 +26,24 @@ enum struct NodeType {
         _LEN,
 };
 
+// What has to be recomputed for a node before it can be rendered again.
+//
+// NOTE: Boxes and fragments aren't reused, any dirty node rebuilds, lays
+//       out and paints the whole box tree again.
+enum struct Dirty : u8 {
+    NONE = 0,
+
+    STYLE = 1 << 0,   //< The node and its descendants have to be restyled.
+    SUBTREE = 1 << 1, //< Some of the descendants are dirty.
+};
+
+FlagsEnum$(Dirty);
+
 // https://dom.spec.whatwg.org/#interface-node
 struct Node : public Tree<Node> {
+    // NOTE: New nodes have never been rendered.
+    Flags<Dirty> _dirty = Dirty::STYLE;
+
     virtual ~Node() = default;
     virtual NodeType nodeType() const = 0;
 
@@ -48,6 +65,22 @@ struct Node : public Tree<Node> {
 
     Gc::Ptr<Document> ownerDocument();
 
+    // Mark the node as dirty, and its ancestors as having dirty descendants.
+    void markDirty(Dirty dirty = Dirty::STYLE);
+
+    bool dirty() const {
+        return _dirty.any();
+    }
+
+    // Clear the dirty bits of the node and all its dirty descendants.
+    void clean();
+
+    // NOTE: Inserting or removing a child can change which selectors
+    //       match its siblings, so they are all restyled.
+    void _childrenChanged() {
+        markDirty(Dirty::STYLE);
+    }
+
     virtual void _repr(Io::Emit&) const {}
 
     void repr(Io::Emit& e) const;
@@ -1,5 +1,59 @@
 #include "tags.h"
 
+namespace Vaev {
+
+// Names are resolved for every tag and attribute the parsers see, so they
+// go through open addressing tables built at compile time instead of
+// comparing the name against every known one.
+template <typename T, usize N>
+struct _NameTable {
+    // Kept at most half full so that probe sequences stay short.
+    static constexpr usize CAP = [] {
+        usize cap = 1;
+        while (cap < N * 2)
+            cap *= 2;
+        return cap;
+    }();
+
+    struct Slot {
+        Str name = {};
+        T value = {};
+        bool used = false;
+    };
+
+    Array<Slot, CAP> slots = {};
+
+    static constexpr usize _hash(Str name) {
+        // FNV-1a
+        u32 hash = 2166136261u;
+        for (usize i = 0; i < name.len(); i++)
+            hash = (hash ^ (u8)name[i]) * 16777619u;
+        return hash & (CAP - 1);
+    }
+
+    constexpr _NameTable(Array<Pair<Str, T>, N> const& names) {
+        for (usize i = 0; i < N; i++) {
+            auto const& [name, value] = names[i];
+            usize slot = _hash(name);
+            while (slots[slot].used)
+                slot = (slot + 1) & (CAP - 1);
+            slots[slot] = {name, value, true};
+        }
+    }
+
+    Opt<T> lookup(Str name) const {
+        for (usize i = _hash(name);; i = (i + 1) & (CAP - 1)) {
+            auto const& slot = slots[i];
+            if (not slot.used)
+                return NONE;
+            if (slot.name == name)
+                return slot.value;
+        }
+    }
+};
+
+} // namespace Vaev
+
 namespace Vaev::Html {
 
 Str _tagName(TagId id) {
@@ -26,25 +80,26 @@ Str _attrName(AttrId id) {
     }
 }
 
-Opt<TagId> _tagId(Str name) {
+static constexpr auto TAGS = _NameTable{Array{
 #define TAG(IDENT, NAME) \
-    if (name == #NAME)   \
-        return TagId::IDENT;
+    Pair<Str, TagId>{#NAME, TagId::IDENT},
 #include "defs/ns-html-tag-names.inc"
 #undef TAG
+}};
 
-    return NONE;
+Opt<TagId> _tagId(Str name) {
+    return TAGS.lookup(name);
 }
 
-Opt<AttrId> _attrId(Str name) {
+static constexpr auto ATTRS = _NameTable{Array{
 #define ATTR(IDENT, NAME) \
-    if (name == #NAME)    \
-        return AttrId::IDENT;
-
+    Pair<Str, AttrId>{#NAME, AttrId::IDENT},
 #include "defs/ns-html-attr-names.inc"
 #undef ATTR
+}};
 
-    return NONE;
+Opt<AttrId> _attrId(Str name) {
+    return ATTRS.lookup(name);
 }
 
 } // namespace Vaev::Html
@@ -75,25 +130,26 @@ Str _attrName(AttrId id) {
     }
 }
 
-Opt<TagId> _tagId(Str name) {
+static constexpr auto TAGS = _NameTable{Array{
 #define TAG(IDENT, NAME) \
-    if (name == #NAME)   \
-        return TagId::IDENT;
+    Pair<Str, TagId>{#NAME, TagId::IDENT},
 #include "defs/ns-mathml-tag-names.inc"
 #undef TAG
+}};
 
-    return NONE;
+Opt<TagId> _tagId(Str name) {
+    return TAGS.lookup(name);
 }
 
-Opt<AttrId> _attrId(Str name) {
+static constexpr auto ATTRS = _NameTable{Array{
 #define ATTR(IDENT, NAME) \
-    if (name == #NAME)    \
-        return AttrId::IDENT;
-
+    Pair<Str, AttrId>{#NAME, AttrId::IDENT},
 #include "defs/ns-mathml-attr-names.inc"
 #undef ATTR
+}};
 
-    return NONE;
+Opt<AttrId> _attrId(Str name) {
+    return ATTRS.lookup(name);
 }
 
 } // namespace Vaev::MathMl
@@ -124,25 +180,26 @@ Str _attrName(AttrId id) {
     }
 }
 
-Opt<TagId> _tagId(Str name) {
+static constexpr auto TAGS = _NameTable{Array{
 #define TAG(IDENT, NAME) \
-    if (name == #NAME)   \
-        return TagId::IDENT;
+    Pair<Str, TagId>{#NAME, TagId::IDENT},
 #include "defs/ns-svg-tag-names.inc"
 #undef TAG
+}};
 
-    return NONE;
+Opt<TagId> _tagId(Str name) {
+    return TAGS.lookup(name);
 }
 
-Opt<AttrId> _attrId(Str name) {
+static constexpr auto ATTRS = _NameTable{Array{
 #define ATTR(IDENT, NAME) \
-    if (name == #NAME)    \
-        return AttrId::IDENT;
-
+    Pair<Str, AttrId>{#NAME, AttrId::IDENT},
 #include "defs/ns-svg-attr-names.inc"
 #undef ATTR
+}};
 
-    return NONE;
+Opt<AttrId> _attrId(Str name) {
+    return ATTRS.lookup(name);
 }
 
 } // namespace Vaev::Svg
@@ -473,4 +473,48 @@ test$("parse-table-element-create-body-tr-scope") {
     return Ok();
 }
 
+test$("parse-long-text-runs") {
+    Gc::Heap gc;
+    auto dom = gc.alloc<Dom::Document>(Mime::Url());
+    Dom::HtmlParser parser{gc, dom};
+
+    parser.write("<html><body><p>Lorem ipsum dolor sit amet, consectetur adipiscing élit &amp; sed do eiusmod tempor</p>\n<table> <tr><td>cell text spanning more than sixteen bytes</td></tr></table></body></html>"s);
+
+    auto html = dom->firstChild()->is<Element>();
+    auto body = html->firstChild()->nextSibling()->is<Element>();
+    expectNe$(body, nullptr);
+
+    auto p = body->firstChild()->is<Element>();
+    expectNe$(p, nullptr);
+    expect$(p->tagName == Html::P);
+    expect$(p->countChildren() == 1);
+
+    auto text = p->firstChild()->is<Text>();
+    expectNe$(text, nullptr);
+    expect$(text->data() == "Lorem ipsum dolor sit amet, consectetur adipiscing élit & sed do eiusmod tempor");
+
+    auto newline = p->nextSibling()->is<Text>();
+    expectNe$(newline, nullptr);
+    expect$(newline->data() == "\n");
+
+    // Whitespace inside a table goes through the character token path
+    auto table = newline->nextSibling()->is<Element>();
+    expectNe$(table, nullptr);
+    expect$(table->tagName == Html::TABLE);
+
+    auto tbody = table->lastChild()->is<Element>();
+    expectNe$(tbody, nullptr);
+    expect$(tbody->tagName == Html::TBODY);
+
+    auto cell = tbody->firstChild()->firstChild()->is<Element>();
+    expectNe$(cell, nullptr);
+    expect$(cell->tagName == Html::TD);
+
+    auto cellText = cell->firstChild()->is<Text>();
+    expectNe$(cellText, nullptr);
+    expect$(cellText->data() == "cell text spanning more than sixteen bytes");
+
+    return Ok();
+}
+
 } // namespace Vaev::Dom::Tests
@@ -68,6 +68,9 @@ struct Tree : Meta::Pinned {
         _lastChild = node;
         if (!_firstChild)
             _firstChild = _lastChild;
+
+        node->markDirty();
+        static_cast<Node*>(this)->_childrenChanged();
     }
 
     void prependChild(Gc::Ptr<Node> node) {
@@ -81,6 +84,9 @@ struct Tree : Meta::Pinned {
         _firstChild = node;
         if (!_lastChild)
             _lastChild = _firstChild;
+
+        node->markDirty();
+        static_cast<Node*>(this)->_childrenChanged();
     }
 
     void insertBefore(Node* node, Node* child) {
@@ -105,6 +111,9 @@ struct Tree : Meta::Pinned {
         child->_prevSibling = node;
 
         node->_parent = static_cast<Node*>(this);
+
+        node->markDirty();
+        static_cast<Node*>(this)->_childrenChanged();
     }
 
     void insertAfter(Node* node, Node* child) {
@@ -126,6 +135,9 @@ struct Tree : Meta::Pinned {
         child->_nextSibling = node;
 
         node->_parent = static_cast<Node*>(this);
+
+        node->markDirty();
+        static_cast<Node*>(this)->_childrenChanged();
     }
 
     void removeChild(Node* node) {
@@ -150,6 +162,8 @@ struct Tree : Meta::Pinned {
         node->_nextSibling = nullptr;
         node->_prevSibling = nullptr;
         node->_parent = nullptr;
+
+        static_cast<Node*>(this)->_childrenChanged();
     }
 
     // Iteration ---------------------------------------------------------------
@@ -0,0 +1,67 @@
+#include <karm-gc/heap.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+#include <vaev-dom/document.h>
+#include <vaev-dom/html/parser.h>
+
+import Vaev.Driver;
+
+using namespace Vaev;
+
+static constexpr Array<usize, 3> SECTIONS = {10, 50, 250};
+
+// MARK: Documents -------------------------------------------------------------
+
+// Every section has a heading, a few paragraphs and a small table, which is
+// about a page and a half of A4 with the default print stylesheet.
+static String _buildHtml(usize sections) {
+    Io::StringWriter sw;
+    Io::Emit e{sw};
+
+    e("<!DOCTYPE html><html><head><title>Print benchmark</title>");
+    e("<style>table { border-collapse: collapse; } td { border: 1px solid black; padding: 4px; }</style>");
+    e("</head><body>");
+
+    for (usize i = 0; i < sections; i++) {
+        e("<h1>Section {}</h1>", i + 1);
+        for (usize j = 0; j < 6; j++) {
+            e("<p>Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor ");
+            e("incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud ");
+            e("exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat. Duis aute irure ");
+            e("dolor in reprehenderit in voluptate velit esse cillum dolore eu fugiat nulla pariatur.</p>");
+        }
+        e("<table>");
+        for (usize row = 0; row < 4; row++)
+            e("<tr><td>Row {}</td><td>{}</td><td>{}</td></tr>", row + 1, i * row, i + row);
+        e("</table>");
+    }
+
+    e("</body></html>");
+    return sw.take();
+}
+
+// MARK: Print -----------------------------------------------------------------
+
+static void benchPrint(usize sections) {
+    Gc::Heap gc;
+    auto dom = gc.alloc<Dom::Document>("about:blank"_url);
+    Dom::HtmlParser parser{gc, dom};
+    parser.write(_buildHtml(sections));
+
+    auto start = Sys::now();
+    usize pages = 0;
+    auto printed = Driver::print(dom, {});
+    while (printed.next())
+        pages++;
+    auto elapsed = Sys::now() - start;
+
+    auto pagesPerSecond = pages / max(elapsed.toUSecs() / 1e6, 1e-6);
+    Sys::println("{} sections: {} pages in {} ({.1} pages/s)", sections, pages, elapsed, pagesPerSecond);
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    for (auto sections : SECTIONS)
+        benchPrint(sections);
+
+    co_return Ok();
+}
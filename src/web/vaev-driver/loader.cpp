@@ -1,5 +1,7 @@
 module;
 
+#include <karm-base/lock.h>
+#include <karm-base/lru.h>
 #include <karm-gc/heap.h>
 #include <karm-mime/mime.h>
 #include <karm-mime/url.h>
@@ -94,20 +96,58 @@ export Async::Task<Gc::Ref<Dom::Document>> fetchDocumentAsync(Gc::Heap& heap, Ht
     co_return co_await _loadDocumentAsync(heap, url, resp);
 }
 
-export Res<Style::StyleSheet> fetchStylesheet(Mime::Url url, Style::Origin origin) {
+// MARK: Stylesheets -----------------------------------------------------------
+
+struct _CachedSheet {
+    Mime::Url href;
+    Style::Origin origin;
+    String source;
+    Arc<Style::StyleSheet> sheet;
+};
+
+static constexpr usize SHEET_CACHE_SIZE = 64;
+
+static Lock _sheetCacheLock;
+static Lru<Hash, _CachedSheet> _sheetCache{SHEET_CACHE_SIZE};
+
+// Parsed sheets are cached by url and content, so the user agent sheets
+// are only parsed once for every render and print job, while a file that
+// changed since is parsed again.
+export Arc<Style::StyleSheet> parseStylesheet(Str source, Mime::Url href, Style::Origin origin) {
+    Hash key = hashCombine(hash(bytes(source)), hash(bytes(href.str())));
+    key = hashCombine(key, hash(toUnderlyingType(origin)));
+
+    {
+        // NOTE: Compared in place, copying the entry would copy the source.
+        LockScope scope{_sheetCacheLock};
+        auto cached = _sheetCache.access(key);
+        if (cached and cached->href == href and cached->origin == origin and cached->source == source)
+            return cached->sheet;
+    }
+
+    // NOTE: Parse outside of the lock, two jobs racing for the same
+    //       sheet will both parse it but won't block each other.
+    Io::SScan s{source};
+    auto sheet = makeArc<Style::StyleSheet>(Style::StyleSheet::parse(s, href, origin));
+
+    LockScope scope{_sheetCacheLock};
+    _sheetCache.access(key, [&] {
+        return _CachedSheet{href, origin, source, sheet};
+    });
+    return sheet;
+}
+
+export Res<Arc<Style::StyleSheet>> fetchStylesheet(Mime::Url url, Style::Origin origin) {
     auto file = try$(Sys::File::open(url));
     auto buf = try$(Io::readAllUtf8(file));
-    Io::SScan s{buf};
-    return Ok(Style::StyleSheet::parse(s, url, origin));
+    return Ok(parseStylesheet(buf, url, origin));
 }
 
 export void fetchStylesheets(Gc::Ref<Dom::Node> node, Style::StyleBook& sb) {
     auto el = node->is<Dom::Element>();
     if (el and el->tagName == Html::STYLE) {
         auto text = el->textContent();
-        Io::SScan textScan{text};
-        auto sheet = Style::StyleSheet::parse(textScan, node->baseURI());
-        sb.add(std::move(sheet));
+        sb.add(parseStylesheet(text, node->baseURI(), Style::Origin::AUTHOR));
     } else if (el and el->tagName == Html::LINK) {
         auto rel = el->getAttribute(Html::REL_ATTR);
         if (rel == "stylesheet"s) {
@@ -1,5 +1,6 @@
 export module Vaev.Driver;
 
 export import :loader;
+export import :pipeline;
 export import :print;
 export import :render;
@@ -0,0 +1,163 @@
+module;
+
+#include <karm-base/box.h>
+#include <karm-scene/stack.h>
+#include <karm-sys/time.h>
+#include <karm-text/book.h>
+#include <vaev-dom/document.h>
+#include <vaev-style/computer.h>
+
+export module Vaev.Driver:pipeline;
+
+import :loader;
+import Vaev.Layout;
+
+namespace Vaev::Driver {
+
+static constexpr bool DEBUG_PIPELINE = false;
+
+static bool _sameSheets(Style::StyleBook const& a, Style::StyleBook const& b) {
+    if (a.styleSheets.len() != b.styleSheets.len())
+        return false;
+
+    for (usize i = 0; i < a.styleSheets.len(); i++)
+        if (&*a.styleSheets[i] != &*b.styleSheets[i])
+            return false;
+
+    return true;
+}
+
+// Keeps the styles, boxes, fragments and scene of a document between two
+// renders, and only runs again the stages invalidated since the last one.
+//
+//  - A mutation of the DOM rebuilds the box tree, but only the elements
+//    marked dirty and their descendants go through the cascade again.
+//  - A resize that doesn't change the outcome of any media query keeps
+//    the box tree and only lays it out and paints it again.
+export struct Pipeline : Meta::Pinned {
+    Gc::Ref<Dom::Document> _dom;
+    Text::FontBook _fontBook;
+    Style::StyleBook _stylebook;
+    Opt<Style::Computer> _computer;
+    Layout::Viewport _viewport;
+    Opt<Layout::Tree> _tree;
+    Opt<Layout::Frag> _frag;
+    Rc<Scene::Stack> _scene = makeRc<Scene::Stack>();
+    Gfx::Color _canvasColor = Gfx::WHITE;
+    bool _layoutDirty = true;
+    bool _paintDirty = true;
+
+    Pipeline(Gc::Ref<Dom::Document> dom)
+        : _dom(dom) {
+        if (not _fontBook.loadAll())
+            logWarn("not all fonts were properly loaded into fontbook");
+    }
+
+    Style::StyleBook _collectStylesheets() {
+        Style::StyleBook stylebook;
+        stylebook.add(
+            fetchStylesheet("bundle://vaev-driver/html.css"_url, Style::Origin::USER_AGENT)
+                .take("user agent stylesheet not available")
+        );
+        fetchStylesheets(_dom, stylebook);
+        return stylebook;
+    }
+
+    void _restyle(Style::Media const& media) {
+        auto start = Sys::now();
+
+        // NOTE: Parsed sheets are cached by the loader, an unchanged
+        //       document gives back the exact same sheets.
+        auto stylebook = _collectStylesheets();
+        if (not _computer or not _sameSheets(stylebook, _stylebook)) {
+            _computer = NONE;
+            _stylebook = std::move(stylebook);
+            _computer.emplace(media, _stylebook, _fontBook);
+            _computer->loadFontFaces();
+        }
+
+        // NOTE: The fragments point into the box tree.
+        _frag = NONE;
+        _tree = NONE;
+        _tree.emplace(Layout::build(*_computer, _dom), _viewport);
+        _canvasColor = fixupBackgrounds(*_computer, _dom, *_tree);
+        _computer->collect();
+        _layoutDirty = true;
+
+        logDebugIf(DEBUG_PIPELINE, "restyle time: {}", Sys::now() - start);
+        logDebugIf(DEBUG_PIPELINE, "style sharing: {}", _computer->_sharing.stats());
+    }
+
+    void _relayout() {
+        auto start = Sys::now();
+
+        _frag = NONE;
+        _tree->viewport = _viewport;
+        auto [_, root] = Layout::layoutCreateFragment(
+            *_tree,
+            {
+                .knownSize = {_viewport.small.width, NONE},
+                .availableSpace = {_viewport.small.width, 0_au},
+                .containingBlock = {_viewport.small.width, _viewport.small.height},
+            }
+        );
+        _frag.emplace(std::move(root));
+        _layoutDirty = false;
+        _paintDirty = true;
+
+        logDebugIf(DEBUG_PIPELINE, "relayout time: {}", Sys::now() - start);
+        logDebugIf(DEBUG_PIPELINE, "layout cache: {}", Layout::layoutStats(_tree->root));
+    }
+
+    void _repaint() {
+        auto start = Sys::now();
+
+        _scene = makeRc<Scene::Stack>();
+        Layout::paint(*_frag, *_scene);
+        _scene->prepare();
+        _paintDirty = false;
+
+        logDebugIf(DEBUG_PIPELINE, "repaint time: {}", Sys::now() - start);
+    }
+
+    void update(Style::Media const& media, Layout::Viewport const& viewport) {
+        if (_computer) {
+            // Media rules that agree on both media select the same rules,
+            // the index and the styles computed so far are still valid.
+            if (Style::RuleIndex::sameMedia(_stylebook, _computer->_media, media))
+                _computer->_media = media;
+            else
+                _computer = NONE;
+        }
+
+        if (_viewport != viewport) {
+            _viewport = viewport;
+            _layoutDirty = true;
+        }
+
+        if (not _computer or _dom->dirty())
+            _restyle(media);
+
+        if (_layoutDirty)
+            _relayout();
+
+        if (_paintDirty)
+            _repaint();
+
+        _dom->clean();
+    }
+
+    Layout::Frag& frag() {
+        return *_frag;
+    }
+
+    Rc<Scene::Stack> scene() {
+        return _scene;
+    }
+
+    Gfx::Color canvasColor() const {
+        return _canvasColor;
+    }
+};
+
+} // namespace Vaev::Driver
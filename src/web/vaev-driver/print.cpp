@@ -16,6 +16,8 @@ import :loader;
 
 namespace Vaev::Driver {
 
+static constexpr bool DEBUG_PRINT = false;
+
 static void _paintMargins(Text::FontBook& fontBook, Style::PageComputedStyle& pageStyle, RectAu pageRect, RectAu pageContent, Scene::Stack& stack) {
     // MARK: Top Left Corner ---------------------------------------------------
 
@@ -260,54 +262,44 @@ static Style::Media _constructMedia(Print::Settings const& settings) {
     };
 }
 
-export Generator<Print::Page> print(Gc::Ref<Dom::Document> dom, Print::Settings const& settings) {
-    auto media = _constructMedia(settings);
-
-    Style::StyleBook stylebook;
-    stylebook.add(
-        fetchStylesheet("bundle://vaev-driver/html.css"_url, Style::Origin::USER_AGENT)
-            .take("user agent stylesheet not available")
-    );
-    stylebook.add(
-        fetchStylesheet("bundle://vaev-driver/print.css"_url, Style::Origin::USER_AGENT)
-            .take("print stylesheet not available")
-    );
-
-    fetchStylesheets(dom, stylebook);
-
-    Text::FontBook fontBook;
-    if (not fontBook.loadAll())
-        logWarn("not all fonts were properly loaded into fontbook");
+// A page of the document, as found by the pagination pass.
+struct _PagePlan {
+    Rc<Style::PageComputedStyle> style;
+    RectAu rect;
+    RectAu content;
+    Layout::Breakpoint prevBreakpoint;
+    Layout::Breakpoint currBreakpoint;
+};
 
-    Style::Computer computer{
-        media, stylebook, fontBook
+static Layout::Input _pageLayoutInput(RectAu pageContent) {
+    return {
+        .knownSize = {pageContent.width, NONE},
+        .position = pageContent.topStart(),
+        .availableSpace = pageContent.size(),
+        .containingBlock = pageContent.size(),
     };
-    computer.loadFontFaces();
-
-    // MARK: Page and Margins --------------------------------------------------
-
-    Style::Computed initialStyle = Style::Computed::initial();
-    initialStyle.color = Gfx::BLACK;
-    initialStyle.setCustomProp("-vaev-url", {Css::Token::string(Io::format("\"{}\"", dom->url()))});
-    initialStyle.setCustomProp("-vaev-title", {Css::Token::string(Io::format("\"{}\"", dom->title()))});
-    initialStyle.setCustomProp("-vaev-datetime", {Css::Token::string(Io::format("\"{}\"", Sys::now()))});
+}
 
-    // MARK: Page Content ------------------------------------------------------
+// NOTE: Every page is laid out in the same content tree, this resets the
+//       viewport and the formatting context it left behind for the next.
+static void _enterPage(Layout::Tree& contentTree, RectAu pageContent) {
+    contentTree.viewport = {.small = pageContent.size()};
+    contentTree.fc = {pageContent.size()};
+}
 
-    Layout::Tree contentTree = {
-        Layout::build(computer, dom),
-    };
+// Find where every page breaks before laying any of them out for real,
+// each page can then be laid out and painted on its own.
+static Vec<_PagePlan> _paginate(Style::Computer& computer, Style::Computed const& initialStyle, Style::Media const& media, Print::Settings const& settings, Layout::Tree& contentTree) {
+    Vec<_PagePlan> plans;
 
     Layout::Breakpoint prevBreakpoint{
         .endIdx = 0,
         .advance = Layout::Breakpoint::Advance::WITHOUT_CHILDREN
     };
-    Layout::Breakpoint currBreakpoint;
 
-    usize count = 0;
     while (true) {
         Layout::Resolver resolver{};
-        Style::Page page{.name = ""s, .number = count++, .blank = false};
+        Style::Page page{.name = ""s, .number = plans.len(), .blank = false};
 
         auto pageStyle = computer.computeFor(initialStyle, page);
         RectAu pageRect{
@@ -315,10 +307,6 @@ export Generator<Print::Page> print(Gc::Ref<Dom::Document> dom, Print::Settings
             media.height / Au{media.resolution.toDppx()}
         };
 
-        auto pageSize = pageRect.size().cast<f64>();
-
-        auto pageStack = makeRc<Scene::Stack>();
-
         InsetsAu pageMargin = {};
 
         if (settings.margins == Print::Margins::DEFAULT) {
@@ -334,51 +322,106 @@ export Generator<Print::Page> print(Gc::Ref<Dom::Document> dom, Print::Settings
         }
 
         RectAu pageContent = pageRect.shrink(pageMargin);
-
-        Layout::Viewport vp{
-            .small = pageContent.size(),
-        };
-
-        contentTree.viewport = vp;
-        contentTree.fc = {pageContent.size()};
-
-        if (settings.headerFooter and settings.margins != Print::Margins::NONE)
-            _paintMargins(fontBook, *pageStyle, pageRect, pageContent, *pageStack);
-
-        Layout::Input pageLayoutInput{
-            .knownSize = {pageContent.width, NONE},
-            .position = pageContent.topStart(),
-            .availableSpace = pageContent.size(),
-            .containingBlock = pageContent.size(),
-        };
+        _enterPage(contentTree, pageContent);
 
         contentTree.fc.enterDiscovery();
         auto outDiscovery = Layout::layout(
             contentTree,
-            pageLayoutInput.withBreakpointTraverser(Layout::BreakpointTraverser(&prevBreakpoint))
+            _pageLayoutInput(pageContent)
+                .withBreakpointTraverser(Layout::BreakpointTraverser(&prevBreakpoint))
         );
-
-        currBreakpoint = outDiscovery.completelyLaidOut
-                             ? Layout::Breakpoint::classB(1, false)
-                             : outDiscovery.breakpoint.unwrap();
-
         contentTree.fc.leaveDiscovery();
-        auto [outReal, fragment] = Layout::layoutCreateFragment(
-            contentTree,
-            pageLayoutInput
-                .withBreakpointTraverser(Layout::BreakpointTraverser(&prevBreakpoint, &currBreakpoint))
-        );
 
-        Layout::paint(fragment, *pageStack);
-        pageStack->prepare();
+        auto currBreakpoint = outDiscovery.completelyLaidOut
+                                  ? Layout::Breakpoint::classB(1, false)
+                                  : outDiscovery.breakpoint.unwrap();
 
-        co_yield Print::Page(settings.paper, makeRc<Scene::Transform>(pageStack, Math::Trans2f::makeScale(media.resolution.toDppx())));
+        plans.pushBack({
+            pageStyle,
+            pageRect,
+            pageContent,
+            prevBreakpoint,
+            currBreakpoint,
+        });
 
-        if (outReal.completelyLaidOut)
+        if (outDiscovery.completelyLaidOut)
             break;
 
-        std::swap(prevBreakpoint, currBreakpoint);
+        prevBreakpoint = std::move(currBreakpoint);
     }
+
+    return plans;
+}
+
+static Print::Page _printPage(Text::FontBook& fontBook, Style::Media const& media, Print::Settings const& settings, Layout::Tree& contentTree, _PagePlan& plan) {
+    auto pageStack = makeRc<Scene::Stack>();
+
+    _enterPage(contentTree, plan.content);
+
+    if (settings.headerFooter and settings.margins != Print::Margins::NONE)
+        _paintMargins(fontBook, *plan.style, plan.rect, plan.content, *pageStack);
+
+    auto [_, fragment] = Layout::layoutCreateFragment(
+        contentTree,
+        _pageLayoutInput(plan.content)
+            .withBreakpointTraverser(Layout::BreakpointTraverser(&plan.prevBreakpoint, &plan.currBreakpoint))
+    );
+
+    Layout::paint(fragment, *pageStack);
+    pageStack->prepare();
+
+    return Print::Page(settings.paper, makeRc<Scene::Transform>(pageStack, Math::Trans2f::makeScale(media.resolution.toDppx())));
+}
+
+export Generator<Print::Page> print(Gc::Ref<Dom::Document> dom, Print::Settings const& settings) {
+    auto media = _constructMedia(settings);
+
+    Style::StyleBook stylebook;
+    stylebook.add(
+        fetchStylesheet("bundle://vaev-driver/html.css"_url, Style::Origin::USER_AGENT)
+            .take("user agent stylesheet not available")
+    );
+    stylebook.add(
+        fetchStylesheet("bundle://vaev-driver/print.css"_url, Style::Origin::USER_AGENT)
+            .take("print stylesheet not available")
+    );
+
+    fetchStylesheets(dom, stylebook);
+
+    Text::FontBook fontBook;
+    if (not fontBook.loadAll())
+        logWarn("not all fonts were properly loaded into fontbook");
+
+    Style::Computer computer{
+        media, stylebook, fontBook
+    };
+    computer.loadFontFaces();
+
+    // MARK: Page and Margins --------------------------------------------------
+
+    Style::Computed initialStyle = Style::Computed::initial();
+    initialStyle.color = Gfx::BLACK;
+    initialStyle.setCustomProp("-vaev-url", {Css::Token::string(Io::format("\"{}\"", dom->url()))});
+    initialStyle.setCustomProp("-vaev-title", {Css::Token::string(Io::format("\"{}\"", dom->title()))});
+    initialStyle.setCustomProp("-vaev-datetime", {Css::Token::string(Io::format("\"{}\"", Sys::now()))});
+
+    // MARK: Page Content ------------------------------------------------------
+
+    Layout::Tree contentTree = {
+        Layout::build(computer, dom),
+    };
+
+    auto start = Sys::now();
+    auto plans = _paginate(computer, initialStyle, media, settings, contentTree);
+    logDebugIf(DEBUG_PRINT, "pagination of {} pages: {}", plans.len(), Sys::now() - start);
+
+    // NOTE: Pages are printed one at a time and in order. They all lay out
+    //       the same content tree, whose viewport, formatting context and
+    //       layout caches are mutated by each of them, and share non atomic
+    //       Rc styles, fontfaces and prose runs. Printing them in parallel
+    //       needs a tree per page first.
+    for (auto& plan : plans)
+        co_yield _printPage(fontBook, media, settings, contentTree, plan);
 }
 
 } // namespace Vaev::Driver
@@ -54,6 +54,7 @@ export RenderResult render(Gc::Ref<Dom::Document> dom, Style::Media const& media
     elapsed = Sys::now() - start;
 
     logDebugIf(DEBUG_RENDER, "layout tree build time: {}", elapsed);
+    logDebugIf(DEBUG_RENDER, "style sharing: {}", computer._sharing.stats());
 
     start = Sys::now();
 
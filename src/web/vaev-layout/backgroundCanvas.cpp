@@ -25,6 +25,8 @@ Gfx::Color _colorToGfx(Color color) {
 void _patchBackgrounds(MutSlice<Layout::Box>& children) {
     for (auto& child : children) {
         if (child.origin->tagName == Html::BODY) {
+            // NOTE: Computed styles can be shared between elements, patch a copy.
+            child.style = makeRc<Style::Computed>(*child.style);
             child.style->backgrounds.cow().color = Gfx::ALPHA;
         }
     }
@@ -38,6 +40,7 @@ export Gfx::Color fixupBackgrounds(Style::Computer& c, Gc::Ref<Dom::Document> do
 
     auto style = c.computeFor(Style::Computed::initial(), *el);
     if (style->backgrounds->color != Gfx::ALPHA) {
+        tree.root.style = makeRc<Style::Computed>(*tree.root.style);
         tree.root.style->backgrounds.cow().color = Gfx::ALPHA;
         return _colorToGfx(style->backgrounds->color);
     }
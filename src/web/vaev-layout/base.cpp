@@ -308,6 +308,13 @@ export struct Viewport {
     RectAu large = small;
     // https://drafts.csswg.org/css-values/#dynamic-viewport-size
     RectAu dynamic = small;
+
+    bool operator==(Viewport const& other) const {
+        return dpi == other.dpi and
+               small.xy == other.small.xy and small.wh == other.small.wh and
+               large.xy == other.large.xy and large.wh == other.large.wh and
+               dynamic.xy == other.dynamic.xy and dynamic.wh == other.dynamic.wh;
+    }
 };
 
 export struct Tree {
@@ -492,9 +499,91 @@ export struct Output {
     }
 };
 
+// MARK: Layout Cache ----------------------------------------------------------
+
+// Outputs of the layouts of a box that neither produced a fragment nor
+// allowed a break. They only depend on the input, so measuring the box
+// again with the same constraints doesn't have to lay out its subtree.
+export struct LayoutCache {
+    static constexpr usize CAPACITY = 8;
+
+    struct Key {
+        IntrinsicSize intrinsic;
+        Math::Vec2<Opt<Au>> knownSize;
+        Vec2Au availableSpace;
+        Vec2Au containingBlock;
+        Opt<Au> capmin;
+
+        bool operator==(Key const&) const = default;
+    };
+
+    struct Entry {
+        Key key;
+        Output output;
+    };
+
+    // NOTE: Viewport relative lengths are resolved against it.
+    Viewport _viewport;
+    Vec<Entry> _entries;
+    usize _next = 0;
+
+    usize runs = 0; //< Number of times the box was actually laid out
+    usize hits = 0; //< Number of layouts answered by the cache
+
+    static Key keyOf(Input const& input) {
+        return {
+            input.intrinsic,
+            input.knownSize,
+            input.availableSpace,
+            input.containingBlock,
+            input.capmin,
+        };
+    }
+
+    Opt<Output> lookup(Viewport const& viewport, Key const& key) {
+        if (_viewport != viewport) {
+            _viewport = viewport;
+            _entries.clear();
+            _next = 0;
+        }
+
+        for (auto const& entry : _entries) {
+            if (entry.key == key) {
+                hits++;
+                return entry.output;
+            }
+        }
+
+        return NONE;
+    }
+
+    void insert(Key const& key, Output const& output) {
+        if (_entries.len() < CAPACITY) {
+            _entries.pushBack({key, output});
+            return;
+        }
+
+        _entries[_next] = {key, output};
+        _next = (_next + 1) % CAPACITY;
+    }
+};
+
+export struct LayoutStats {
+    usize boxes = 0;
+    usize runs = 0;
+    usize hits = 0;
+    usize maxRuns = 0; //< Most layouts done for a single box
+
+    void repr(Io::Emit& e) const {
+        e("(layout-cache boxes: {} runs: {} hits: {} max-runs: {})", boxes, runs, hits, maxRuns);
+    }
+};
+
 // MARK: Formating Context -----------------------------------------------------
 
 struct FormatingContext {
+    LayoutCache _cache;
+
     virtual ~FormatingContext() = default;
 
     virtual void build(Tree&, Box&) {};
@@ -0,0 +1,147 @@
+#include <karm-gc/heap.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+#include <vaev-dom/document.h>
+#include <vaev-dom/text.h>
+#include <vaev-style/computer.h>
+
+import Vaev.Layout;
+
+using namespace Vaev;
+
+static constexpr Array<usize, 4> DEPTHS = {4, 8, 16, 32};
+
+static Style::Media const MEDIA = {
+    .type = MediaType::SCREEN,
+    .width = 1920_au,
+    .height = 1080_au,
+    .aspectRatio = 16.0 / 9.0,
+    .orientation = Print::Orientation::LANDSCAPE,
+
+    .resolution = Resolution::fromDpi(96),
+    .scan = Scan::PROGRESSIVE,
+    .grid = false,
+    .update = Update::FAST,
+    .overflowBlock = OverflowBlock::SCROLL,
+    .overflowInline = OverflowInline::SCROLL,
+
+    .color = 8,
+    .colorIndex = 0,
+    .monochrome = 0,
+    .colorGamut = ColorGamut::SRGB,
+    .pointer = Pointer::FINE,
+    .hover = Hover::HOVER,
+    .anyPointer = Pointer::FINE,
+    .anyHover = Hover::HOVER,
+
+    .prefersReducedMotion = ReducedMotion::NO_PREFERENCE,
+    .prefersReducedTransparency = ReducedTransparency::NO_PREFERENCE,
+    .prefersContrast = Contrast::NO_PREFERENCE,
+    .forcedColors = Colors::NONE,
+    .prefersColorScheme = ColorScheme::LIGHT,
+    .prefersReducedData = ReducedData::NO_PREFERENCE,
+
+    .deviceWidth = 1920_au,
+    .deviceHeight = 1080_au,
+    .deviceAspectRatio = 16.0 / 9.0,
+};
+
+// MARK: Documents -------------------------------------------------------------
+
+static Gc::Ref<Dom::Element> _element(Gc::Heap& gc, Gc::Ref<Dom::Element> parent, Str class_) {
+    auto el = gc.alloc<Dom::Element>(Html::DIV);
+    el->setAttribute(Html::CLASS_ATTR, class_);
+    parent->appendChild(el);
+    return el;
+}
+
+static void _text(Gc::Heap& gc, Gc::Ref<Dom::Element> parent) {
+    parent->appendChild(gc.alloc<Dom::Text>("Lorem ipsum dolor sit amet"s));
+}
+
+// Every flex container holds a few words and the next flex container.
+static void buildFlex(Gc::Heap& gc, Gc::Ref<Dom::Element> parent, usize depth) {
+    if (depth == 0)
+        return _text(gc, parent);
+
+    auto flex = _element(gc, parent, "flex");
+    _text(gc, _element(gc, flex, "item"));
+    buildFlex(gc, _element(gc, flex, "item"), depth - 1);
+}
+
+// Every table has a row with a cell of text and a cell holding the next table.
+static void buildTable(Gc::Heap& gc, Gc::Ref<Dom::Element> parent, usize depth) {
+    if (depth == 0)
+        return _text(gc, parent);
+
+    auto table = _element(gc, parent, "table");
+    auto row = _element(gc, table, "row");
+    _text(gc, _element(gc, row, "cell"));
+    buildTable(gc, _element(gc, row, "cell"), depth - 1);
+}
+
+static Gc::Ref<Dom::Document> buildDocument(Gc::Heap& gc, usize depth, auto build) {
+    auto doc = gc.alloc<Dom::Document>(""_url);
+    auto html = gc.alloc<Dom::Element>(Html::HTML);
+    auto body = gc.alloc<Dom::Element>(Html::BODY);
+    doc->appendChild(html);
+    html->appendChild(body);
+    build(gc, body, depth);
+    return doc;
+}
+
+static Style::StyleSheet buildStyleSheet() {
+    Io::SScan s{
+        "html, body, div { display: block; } "
+        ".flex { display: flex; } "
+        ".item { flex: 1 1 auto; } "
+        ".table { display: table; } "
+        ".row { display: table-row; } "
+        ".cell { display: table-cell; } "
+    };
+    return Style::StyleSheet::parse(s, ""_url);
+}
+
+// MARK: Layout ----------------------------------------------------------------
+
+static void benchLayout(Str name, Style::StyleBook const& book, Text::FontBook& fontBook, Gc::Ref<Dom::Document> doc, usize depth) {
+    Style::Computer computer{MEDIA, book, fontBook};
+
+    Layout::Viewport viewport{.small = {1920_au, 1080_au}};
+    Layout::Tree tree = {
+        Layout::build(computer, doc),
+        viewport,
+    };
+
+    auto start = Sys::now();
+    auto [_, frag] = Layout::layoutCreateFragment(
+        tree,
+        {
+            .knownSize = {viewport.small.width, NONE},
+            .availableSpace = {viewport.small.width, 0_au},
+            .containingBlock = {viewport.small.width, viewport.small.height},
+        }
+    );
+    auto elapsed = Sys::now() - start;
+
+    Sys::println("{} depth {}: {} {}", name, depth, elapsed, Layout::layoutStats(tree.root));
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    Gc::Heap gc;
+
+    Text::FontBook fontBook;
+    if (not fontBook.loadAll())
+        Sys::println("not all fonts were properly loaded into fontbook");
+
+    Style::StyleBook book;
+    book.add(buildStyleSheet());
+
+    for (auto depth : DEPTHS)
+        benchLayout("nested flex", book, fontBook, buildDocument(gc, depth, buildFlex), depth);
+
+    for (auto depth : DEPTHS)
+        benchLayout("nested tables", book, fontBook, buildDocument(gc, depth, buildTable), depth);
+
+    co_return Ok();
+}
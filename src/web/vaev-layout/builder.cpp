@@ -207,9 +207,16 @@ static void _buildInput(Style::Computer& c, Gc::Ref<Dom::Element> el, Box& paren
 // MARK: Build Block -----------------------------------------------------------
 
 void _buildChildren(Style::Computer& c, Gc::Ref<Dom::Node> node, Box& parent) {
+    auto el = node->is<Dom::Element>();
+    if (el)
+        c.pushAncestor(*el);
+
     for (auto child = node->firstChild(); child; child = child->nextSibling()) {
         _buildNode(c, *child, parent);
     }
+
+    if (el)
+        c.popAncestor();
 }
 
 static void _buildBlock(Style::Computer& c, Rc<Style::Computed> style, Gc::Ref<Dom::Element> el, Box& parent) {
@@ -239,15 +246,19 @@ static void _buildImage(Style::Computer& c, Gc::Ref<Dom::Element> el, Box& paren
 // MARK: Build Table -----------------------------------------------------------
 
 static void _buildTableChildren(Style::Computer& c, Gc::Ref<Dom::Node> node, Box& tableWrapperBox, Rc<Style::Computed> tableBoxStyle) {
+    // NOTE: The children inherit from the style computed for the table
+    //       element, it's the one the style caches know about.
     Box tableBox{
         tableBoxStyle,
         tableWrapperBox.fontFace,
         node->is<Dom::Element>()
     };
 
-    tableBox.style->display = Display::Internal::TABLE_BOX;
+    bool captionsOnTop = tableBoxStyle->table->captionSide == CaptionSide::TOP;
 
-    bool captionsOnTop = tableBox.style->table->captionSide == CaptionSide::TOP;
+    auto tableEl = node->is<Dom::Element>();
+    if (tableEl)
+        c.pushAncestor(*tableEl);
 
     if (captionsOnTop) {
         for (auto child = node->firstChild(); child; child = child->nextSibling()) {
@@ -266,6 +277,10 @@ static void _buildTableChildren(Style::Computer& c, Gc::Ref<Dom::Node> node, Box
             }
         }
     }
+
+    // NOTE: Computed styles can be shared between elements, make our own copy before changing the display.
+    tableBox.style = makeRc<Style::Computed>(*tableBoxStyle);
+    tableBox.style->display = Display::Internal::TABLE_BOX;
     tableWrapperBox.add(std::move(tableBox));
 
     if (not captionsOnTop) {
@@ -277,6 +292,9 @@ static void _buildTableChildren(Style::Computer& c, Gc::Ref<Dom::Node> node, Box
             }
         }
     }
+
+    if (tableEl)
+        c.popAncestor();
 }
 
 static void _buildTable(Style::Computer& c, Rc<Style::Computed> style, Gc::Ref<Dom::Element> el, Box& parent) {
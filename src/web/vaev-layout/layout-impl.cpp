@@ -55,7 +55,23 @@ Output _contentLayout(Tree& tree, Box& box, Input input, usize startAt, Opt<usiz
     }
     if (not box.formatingContext)
         return Output{};
-    return box.formatingContext.unwrap()->run(tree, box, input, startAt, stopAt);
+
+    auto& fc = *box.formatingContext.unwrap();
+
+    // NOTE: Measuring layouts are asked for again and again by flex and table
+    //       formating contexts, without a cache nesting them is exponential.
+    bool cacheable = not input.fragment and not tree.fc.allowBreak();
+    auto key = LayoutCache::keyOf(input);
+    if (cacheable) {
+        if (auto cached = fc._cache.lookup(tree.viewport, key))
+            return cached.take();
+    }
+
+    fc._cache.runs++;
+    auto out = fc.run(tree, box, input, startAt, stopAt);
+    if (cacheable)
+        fc._cache.insert(key, out);
+    return out;
 }
 
 InsetsAu computeMargins(Tree& tree, Box& box, Input input) {
@@ -329,4 +345,23 @@ Tuple<Output, Frag> layoutCreateFragment(Tree& tree, Input input) {
     return {out, std::move(root.children[0])};
 }
 
+static void _collectStats(Box const& box, LayoutStats& stats) {
+    stats.boxes++;
+    if (box.formatingContext) {
+        auto const& cache = box.formatingContext.unwrap()->_cache;
+        stats.runs += cache.runs;
+        stats.hits += cache.hits;
+        stats.maxRuns = max(stats.maxRuns, cache.runs);
+    }
+
+    for (auto const& child : box.children())
+        _collectStats(child, stats);
+}
+
+LayoutStats layoutStats(Box const& box) {
+    LayoutStats stats;
+    _collectStats(box, stats);
+    return stats;
+}
+
 } // namespace Vaev::Layout
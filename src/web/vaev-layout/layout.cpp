@@ -20,4 +20,6 @@ export Output layout(Tree& tree, Input input);
 
 export Tuple<Output, Frag> layoutCreateFragment(Tree& tree, Input input);
 
+export LayoutStats layoutStats(Box const& box);
+
 } // namespace Vaev::Layout
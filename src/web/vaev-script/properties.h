@@ -1,5 +1,7 @@
 #pragma once
 
+#include <karm-base/hashmap.h>
+
 #include "value.h"
 
 namespace Vaev::Script {
@@ -25,8 +27,33 @@ struct PropertyKey {
     bool operator==(PropertyKey const& other) const {
         return store == other.store;
     }
+
+    Hash hash() const {
+        return store.visit(Visitor{
+            [](String const& str) {
+                return Karm::hash(str);
+            },
+            [](Symbol const& sym) {
+                return Karm::hash(sym._desc);
+            },
+            [](u64 num) {
+                return Karm::hash(num);
+            },
+        });
+    }
+};
+
+} // namespace Vaev::Script
+
+template <>
+struct Karm::Hasher<Vaev::Script::PropertyKey> {
+    static Karm::Hash hash(Vaev::Script::PropertyKey const& key) {
+        return key.hash();
+    }
 };
 
+namespace Vaev::Script {
+
 // https://tc39.es/ecma262/#sec-property-attributes
 struct PropertyDescriptor {
     Value value = undefined;
@@ -104,7 +131,7 @@ struct PropertyStorage {
         Attributes attributes;
     };
 
-    Map<PropertyKey, Property> _props;
+    HashMap<PropertyKey, Property> _props;
 
     void set(PropertyKey key, Property prop) {
         _props.put(key, prop);
@@ -0,0 +1,200 @@
+#include <karm-gc/heap.h>
+#include <karm-sys/entry.h>
+#include <karm-sys/time.h>
+#include <vaev-style/computer.h>
+
+using namespace Vaev;
+
+static constexpr usize SECTIONS = 100;
+static constexpr usize DEPTH = 8;
+static constexpr usize FANOUT = 2;
+static constexpr usize CLASSES = 64;
+static constexpr usize RULES = 2000;
+
+static Style::Media const MEDIA = {
+    .type = MediaType::SCREEN,
+    .width = 1920_au,
+    .height = 1080_au,
+    .aspectRatio = 16.0 / 9.0,
+    .orientation = Print::Orientation::LANDSCAPE,
+
+    .resolution = Resolution::fromDpi(96),
+    .scan = Scan::PROGRESSIVE,
+    .grid = false,
+    .update = Update::FAST,
+    .overflowBlock = OverflowBlock::SCROLL,
+    .overflowInline = OverflowInline::SCROLL,
+
+    .color = 8,
+    .colorIndex = 0,
+    .monochrome = 0,
+    .colorGamut = ColorGamut::SRGB,
+    .pointer = Pointer::FINE,
+    .hover = Hover::HOVER,
+    .anyPointer = Pointer::FINE,
+    .anyHover = Hover::HOVER,
+
+    .prefersReducedMotion = ReducedMotion::NO_PREFERENCE,
+    .prefersReducedTransparency = ReducedTransparency::NO_PREFERENCE,
+    .prefersContrast = Contrast::NO_PREFERENCE,
+    .forcedColors = Colors::NONE,
+    .prefersColorScheme = ColorScheme::LIGHT,
+    .prefersReducedData = ReducedData::NO_PREFERENCE,
+
+    .deviceWidth = 1920_au,
+    .deviceHeight = 1080_au,
+    .deviceAspectRatio = 16.0 / 9.0,
+};
+
+// MARK: Document --------------------------------------------------------------
+
+static usize _elements = 0;
+
+static void buildTree(Gc::Heap& gc, Gc::Ref<Dom::Element> parent, usize depth) {
+    if (depth == DEPTH)
+        return;
+
+    for (usize i = 0; i < FANOUT; i++) {
+        auto el = gc.alloc<Dom::Element>(depth % 2 ? Html::SPAN : Html::DIV);
+        el->setAttribute(Html::CLASS_ATTR, Io::format("c{} c{}", _elements % CLASSES, (_elements * 7) % CLASSES));
+        if (_elements % 16 == 0)
+            el->setAttribute(Html::ID_ATTR, Io::format("e{}", _elements));
+        _elements++;
+        parent->appendChild(el);
+        buildTree(gc, el, depth + 1);
+    }
+}
+
+static Gc::Ref<Dom::Document> buildDocument(Gc::Heap& gc) {
+    auto doc = gc.alloc<Dom::Document>(""_url);
+    auto html = gc.alloc<Dom::Element>(Html::HTML);
+    auto body = gc.alloc<Dom::Element>(Html::BODY);
+    doc->appendChild(html);
+    html->appendChild(body);
+
+    for (usize i = 0; i < SECTIONS; i++) {
+        auto section = gc.alloc<Dom::Element>(Html::SECTION);
+        body->appendChild(section);
+        buildTree(gc, section, 0);
+    }
+
+    return doc;
+}
+
+// A mix of the selectors found on real pages, most of them with a descendant combinator.
+static Style::StyleSheet buildStyleSheet() {
+    Io::StringWriter sw;
+    Io::Emit e{sw};
+    for (usize i = 0; i < RULES; i++) {
+        switch (i % 5) {
+        case 0:
+            e(".c{} {{ color: red; }}\n", i % CLASSES);
+            break;
+        case 1:
+            e(".x{} .c{} {{ margin: 1px; }}\n", i, i % CLASSES);
+            break;
+        case 2:
+            e("#e{} span {{ padding: 2px; }}\n", i * 16);
+            break;
+        case 3:
+            e("section .c{} > span.c{} {{ display: block; }}\n", i % CLASSES, (i * 3) % CLASSES);
+            break;
+        case 4:
+            e("article div, .y{} p {{ color: blue; }}\n", i);
+            break;
+        }
+    }
+
+    auto css = sw.take();
+    Io::SScan s{css};
+    return Style::StyleSheet::parse(s, ""_url);
+}
+
+// Design tokens declared on a few classes and used everywhere through var().
+static Style::StyleSheet buildCustomPropsSheet() {
+    Io::StringWriter sw;
+    Io::Emit e{sw};
+    e(":root {{ --gap: 4px; --fg: #111111; --bg: #ffffff; --line: 1.5; }}\n");
+    e("html {{ --gap: 4px; --fg: #111111; --bg: #ffffff; --line: 1.5; }}\n");
+    for (usize i = 0; i < CLASSES; i += 8)
+        e(".c{} {{ --gap: {}px; --fg: #{06x}; }}\n", i, i % 3, i * 0x010101);
+    e("div, span {{ margin-top: var(--gap); padding-left: var(--gap); color: var(--fg); }}\n");
+    e("div {{ background-color: var(--bg); line-height: var(--line); margin-bottom: calc(var(--gap) * 2); }}\n");
+    e("span {{ padding-right: var(--gap, 2px); display: inherit; }}\n");
+
+    auto css = sw.take();
+    Io::SScan s{css};
+    return Style::StyleSheet::parse(s, ""_url);
+}
+
+// MARK: Style Recalc ----------------------------------------------------------
+
+static void styleTree(Style::Computer& c, Style::Computed const& parent, Gc::Ref<Dom::Element> el, bool filter) {
+    auto style = c.computeFor(parent, el);
+
+    if (filter)
+        c.pushAncestor(el);
+
+    for (auto child = el->firstChild(); child; child = child->nextSibling())
+        if (auto childEl = child->is<Dom::Element>())
+            styleTree(c, *style, *childEl, filter);
+
+    if (filter)
+        c.popAncestor();
+}
+
+static Duration benchRecalc(Style::StyleBook const& book, Gc::Ref<Dom::Document> doc, bool filter) {
+    Text::FontBook fontBook;
+    Style::Computer computer{MEDIA, book, fontBook};
+
+    auto start = Sys::now();
+    styleTree(computer, Style::Computed::initial(), *doc->documentElement(), filter);
+    auto elapsed = Sys::now() - start;
+
+    Sys::println("{}", computer._sharing.stats());
+    return elapsed;
+}
+
+static void matchTree(Style::StyleBook const& book, Gc::Ref<Dom::Element> el, usize& matches) {
+    for (auto const& sheet : book.styleSheets)
+        for (auto const& rule : sheet->rules)
+            if (auto r = rule.is<Style::StyleRule>(); r and r->match(el))
+                matches++;
+
+    for (auto child = el->firstChild(); child; child = child->nextSibling())
+        if (auto childEl = child->is<Dom::Element>())
+            matchTree(book, *childEl, matches);
+}
+
+// The previous approach, every rule is matched against every element.
+static Duration benchMatchAll(Style::StyleBook const& book, Gc::Ref<Dom::Document> doc) {
+    usize matches = 0;
+    auto start = Sys::now();
+    matchTree(book, *doc->documentElement(), matches);
+    auto elapsed = Sys::now() - start;
+
+    // Keep the optimizer from throwing away the loop
+    if (matches == 42)
+        Sys::println("");
+
+    return elapsed;
+}
+
+Async::Task<> entryPointAsync(Sys::Context&) {
+    Gc::Heap gc;
+    auto doc = buildDocument(gc);
+
+    Style::StyleBook book;
+    book.add(buildStyleSheet());
+
+    Sys::println("style recalc over {} elements and {} rules", _elements + SECTIONS + 2, RULES);
+    Sys::println("match all rules: {}", benchMatchAll(book, doc));
+    Sys::println("rule index: {}", benchRecalc(book, doc, false));
+    Sys::println("rule index + ancestor filter: {}", benchRecalc(book, doc, true));
+
+    Style::StyleBook varBook;
+    varBook.add(buildCustomPropsSheet());
+    Sys::println("custom properties: {}", benchRecalc(varBook, doc, true));
+
+    co_return Ok();
+}
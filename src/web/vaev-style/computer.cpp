@@ -1,59 +1,46 @@
 #include <vaev-style/decls.h>
 
 #include "computer.h"
+#include "matcher.h"
 
 namespace Vaev::Style {
 
-void Computer::_evalRule(Rule const& rule, Gc::Ref<Dom::Element> el, MatchingRules& matches) {
-    rule.visit(Visitor{
-        [&](StyleRule const& r) {
-            if (auto specificity = r.match(el))
-                matches.pushBack({&r, specificity.unwrap()});
-        },
-        [&](MediaRule const& r) {
-            if (r.match(_media))
-                for (auto const& subRule : r.rules)
-                    _evalRule(subRule, el, matches);
-        },
-        [&](auto const&) {
-            // Ignore other rule types
-        },
-    });
+RuleIndex const& Computer::_ruleIndex() {
+    if (not _index)
+        _index = RuleIndex::build(_styleBook, _media);
+    return *_index;
 }
 
-void Computer::_evalRule(Rule const& rule, Page const& page, PageComputedStyle& c) {
-    rule.visit(Visitor{
-        [&](PageRule const& r) {
-            if (r.match(page))
-                r.apply(c);
-        },
-        [&](MediaRule const& r) {
-            if (r.match(_media))
-                for (auto const& subRule : r.rules)
-                    _evalRule(subRule, page, c);
-        },
-        [&](auto const&) {
-            // Ignore other rule types
-        },
-    });
+void Computer::pushAncestor(Gc::Ref<Dom::Element> el) {
+    if (el->_dirty.has(Dom::Dirty::STYLE))
+        _dirtyAncestors++;
+    _ancestors.push(el);
 }
 
-void Computer::_evalRule(Rule const& rule, Vec<FontFace>& fontFaces) {
-    rule.visit(Visitor{
-        [&](FontFaceRule const& r) {
-            auto& fontFace = fontFaces.emplaceBack();
-            for (auto const& decl : r.descs)
-                decl.apply(fontFace);
-        },
-        [&](MediaRule const& r) {
-            if (r.match(_media))
-                for (auto const& subRule : r.rules)
-                    _evalRule(subRule, fontFaces);
-        },
-        [&](auto const&) {
-            // Ignore other rule types
-        },
-    });
+void Computer::popAncestor() {
+    if (last(_ancestors._stack)->_dirty.has(Dom::Dirty::STYLE))
+        _dirtyAncestors--;
+    _ancestors.pop();
+}
+
+void Computer::_applyProp(StyleRule const& rule, StyleProp const& prop, Computed const& parent, Computed& c) {
+    auto deferred = prop.is<DeferredProp>();
+
+    // NOTE: Inline styles only live as long as computeFor(), their
+    //       declarations can't be used as a key.
+    if (not deferred or rule.origin == Origin::INLINE) {
+        prop.apply(parent, c);
+        return;
+    }
+
+    DeferredKey key{deferred, &*c.variables};
+    if (not _deferred.has(key)) {
+        auto resolved = deferred->resolve(c);
+        _deferred.put(key, {c.variables._inner, resolved ? Opt<StyleProp>{resolved.take()} : NONE});
+    }
+
+    if (auto const& resolved = _deferred.get(key).prop)
+        resolved->apply(parent, c);
 }
 
 Rc<Computed> Computer::_evalCascade(Computed const& parent, MatchingRules& matchingRules) {
@@ -70,7 +57,7 @@ Rc<Computed> Computer::_evalCascade(Computed const& parent, MatchingRules& match
     // Compute computed style
     auto computed = makeRc<Computed>(Computed::initial());
     computed->inherit(parent);
-    Vec<Cursor<StyleProp>> importantProps;
+    Vec<Tuple<Cursor<StyleRule>, Cursor<StyleProp>>> importantProps;
 
     // HACK: Apply custom properties first
     for (auto const& [styleRule, _] : matchingRules) {
@@ -80,86 +67,149 @@ Rc<Computed> Computer::_evalCascade(Computed const& parent, MatchingRules& match
         }
     }
 
+    _sharing.internVariables(*computed);
+
     for (auto const& [styleRule, _] : matchingRules) {
         for (auto& prop : styleRule->props) {
             if (not prop.is<CustomProp>()) {
                 if (prop.important == Important::NO)
-                    prop.apply(parent, *computed);
+                    _applyProp(*styleRule, prop, parent, *computed);
                 else
-                    importantProps.pushBack(&prop);
+                    importantProps.pushBack({styleRule, &prop});
             }
         }
     }
 
-    for (auto const& prop : iterRev(importantProps))
-        prop->apply(parent, *computed);
+    for (auto const& [styleRule, prop] : iterRev(importantProps))
+        _applyProp(*styleRule, *prop, parent, *computed);
 
     return computed;
 }
 
 // https://drafts.csswg.org/css-cascade/#cascade-origin
-Rc<Computed> Computer::computeFor(Computed const& parent, Gc::Ref<Dom::Element> el) {
-    MatchingRules matchingRules;
+Rc<Computed> Computer::_computeFor(Computed const& parent, Gc::Ref<Dom::Element> el) {
+    Vec<Cursor<RuleIndex::Entry>> candidates;
+    _ruleIndex().collect(el, candidates);
+
+    // Bring the candidates back in document order, the cascade relies on it to break ties
+    sort(candidates, [](auto const& a, auto const& b) {
+        return a->order <=> b->order;
+    });
+
+    bool filtered = _ancestors.covers(el);
 
     // Collect matching styles rules
-    for (auto const& sheet : _styleBook.styleSheets)
-        for (auto const& rule : sheet.rules)
-            _evalRule(rule, el, matchingRules);
+    MatchingRules matchingRules;
+    for (auto const& entry : candidates) {
+        if (filtered and not entry->mayMatch(_ancestors))
+            continue;
+
+        auto specificity = matchSelector(*entry->selector, el);
+        if (not specificity)
+            continue;
+
+        // Branches of a selector list share their rule, keep the most specific one
+        if (matchingRules and last(matchingRules).v0 == entry->rule) {
+            last(matchingRules).v1 = max(last(matchingRules).v1, specificity.unwrap());
+            continue;
+        }
+
+        matchingRules.pushBack({entry->rule, specificity.unwrap()});
+    }
 
     // Get the style attribute if any
     auto styleAttr = el->getAttribute(Html::STYLE_ATTR);
+    Str style = styleAttr ? *styleAttr : "";
+
+    if (auto shared = _sharing.lookup(parent, matchingRules, style))
+        return shared.take();
 
     StyleRule styleRule{
-        .props = parseDeclarations<StyleProp>(styleAttr ? *styleAttr : ""),
+        .props = parseDeclarations<StyleProp>(style),
         .origin = Origin::INLINE,
     };
-    matchingRules.pushBack({&styleRule, INLINE_SPEC});
 
-    return _evalCascade(parent, matchingRules);
+    // NOTE: The cascade sorts the rules in place, keep the matched ones for the cache key.
+    MatchingRules cascadedRules = matchingRules;
+    cascadedRules.pushBack({&styleRule, INLINE_SPEC});
+
+    auto computed = _evalCascade(parent, cascadedRules);
+    _sharing.intern(*computed);
+    _sharing.insert(parent, matchingRules, style, computed);
+    return computed;
+}
+
+Rc<Computed> Computer::computeFor(Computed const& parent, Gc::Ref<Dom::Element> el) {
+    bool dirty = _dirtyAncestors or el->_dirty.has(Dom::Dirty::STYLE);
+    if (auto cached = _elements.access(&*el); cached and not dirty and cached->parent == &parent) {
+        cached->pass = _pass;
+        return cached->computed;
+    }
+
+    auto computed = _computeFor(parent, el);
+
+    // NOTE: Same as for the sharing cache, the parent has to outlive the entry.
+    if (&parent == &Computed::initial() or _sharing._styles.has(&parent))
+        _elements.put(&*el, {&parent, computed, _pass});
+
+    return computed;
+}
+
+void Computer::collect() {
+    _elements.removeIf([&](auto const&, _ElementStyle const& style) {
+        return style.pass != _pass;
+    });
+    _pass++;
+
+    // NOTE: Resolved declarations are cheap to get back compared to
+    //       tracking which environments are still in use.
+    _deferred.clear();
+
+    HashMap<Computed const*, Rc<Computed>> live;
+    for (auto const& [_, style] : _elements.iter())
+        live.put(&*style.computed, style.computed);
+    _sharing.collect(live);
 }
 
 Rc<PageComputedStyle> Computer::computeFor(Computed const& parent, Page const& page) {
     auto computed = makeRc<PageComputedStyle>(parent);
 
-    for (auto const& sheet : _styleBook.styleSheets)
-        for (auto const& rule : sheet.rules)
-            _evalRule(rule, page, *computed);
+    for (auto const& rule : _ruleIndex().pages())
+        if (rule->match(page))
+            rule->apply(*computed);
 
     return computed;
 }
 
 void Computer::loadFontFaces() {
-    for (auto const& sheet : _styleBook.styleSheets) {
-
-        Vec<FontFace> fontFaces;
-        for (auto const& rule : sheet.rules)
-            _evalRule(rule, fontFaces);
+    for (auto const& [rule, sheet] : _ruleIndex().fontFaces()) {
+        FontFace ff;
+        for (auto const& decl : rule->descs)
+            decl.apply(ff);
 
-        for (auto const& ff : fontFaces) {
-            for (auto const& src : ff.sources) {
-                if (src.identifier.is<Mime::Url>()) {
-                    auto fontUrl = src.identifier.unwrap<Mime::Url>();
+        for (auto const& src : ff.sources) {
+            if (src.identifier.is<Mime::Url>()) {
+                auto fontUrl = src.identifier.unwrap<Mime::Url>();
 
-                    auto resolvedUrl = Mime::Url::resolveReference(sheet.href, fontUrl);
+                auto resolvedUrl = Mime::Url::resolveReference(sheet->href, fontUrl);
 
-                    if (not resolvedUrl) {
-                        logWarn("Cannot resolve urls when loading fonts: {} {}", fontUrl, sheet.href);
-                        continue;
-                    }
+                if (not resolvedUrl) {
+                    logWarn("Cannot resolve urls when loading fonts: {} {}", fontUrl, sheet->href);
+                    continue;
+                }
 
-                    // FIXME: use attrs from style::FontFace
-                    if (fontBook.load(resolvedUrl.unwrap()))
-                        break;
+                // FIXME: use attrs from style::FontFace
+                if (fontBook.load(resolvedUrl.unwrap()))
+                    break;
 
-                    logWarn("Failed to load font at {}", resolvedUrl);
-                } else {
-                    if (
-                        fontBook.queryExact(Text::FontQuery{.family = src.identifier.unwrap<Text::Family>()})
-                    )
-                        break;
+                logWarn("Failed to load font at {}", resolvedUrl);
+            } else {
+                if (
+                    fontBook.queryExact(Text::FontQuery{.family = src.identifier.unwrap<Text::Family>()})
+                )
+                    break;
 
-                    logWarn("Failed to assets font {}", src.identifier.unwrap<Text::Family>());
-                }
+                logWarn("Failed to assets font {}", src.identifier.unwrap<Text::Family>());
             }
         }
     }
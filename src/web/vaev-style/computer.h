@@ -4,6 +4,8 @@
 #include <vaev-dom/element.h>
 
 #include "computed.h"
+#include "index.h"
+#include "sharing.h"
 #include "stylesheet.h"
 
 namespace Vaev::Style {
@@ -12,22 +14,65 @@ struct Computer {
     Media _media;
     StyleBook const& _styleBook;
     Text::FontBook& fontBook;
+    Opt<RuleIndex> _index = NONE;
+    AncestorFilter _ancestors = {};
+    StyleSharing _sharing = {};
 
     using MatchingRules = Vec<Tuple<Cursor<StyleRule>, Spec>>;
 
-    void _evalRule(Rule const& rule, Gc::Ref<Dom::Element> el, MatchingRules& matches);
+    // Deferred declarations already resolved against an environment.
+    using DeferredKey = Tuple<DeferredProp const*, Map<String, Css::Content> const*>;
 
-    void _evalRule(Rule const& rule, Page const& page, PageComputedStyle& c);
+    struct _Deferred {
+        // NOTE: Keeps the environment alive, so its address can't be reused by another one.
+        Rc<Map<String, Css::Content>> env;
+        Opt<StyleProp> prop;
+    };
 
-    void _evalRule(Rule const& rule, Vec<FontFace>& fontFaces);
+    HashMap<DeferredKey, _Deferred> _deferred = {};
+
+    struct _ElementStyle {
+        Computed const* parent;
+        Rc<Computed> computed;
+        usize pass;
+    };
+
+    // Styles computed by the previous passes, they are reused as long as
+    // neither the element nor one of its ancestors was marked for restyle.
+    //
+    // NOTE: New elements are always dirty, so an element allocated at the
+    //       address of a removed one never picks up its style.
+    HashMap<Dom::Element const*, _ElementStyle> _elements = {};
+    usize _dirtyAncestors = 0;
+    usize _pass = 0;
+
+    RuleIndex const& _ruleIndex();
+
+    // Tell the computer that the elements styled next are descendants
+    // of `el` so it can reject selectors with missing ancestors early.
+    void pushAncestor(Gc::Ref<Dom::Element> el);
+
+    void popAncestor();
+
+    void _applyProp(StyleRule const& rule, StyleProp const& prop, Computed const& parent, Computed& c);
 
     Rc<Computed> _evalCascade(Computed const& parent, MatchingRules& matches);
 
+    Rc<Computed> _computeFor(Computed const& parent, Gc::Ref<Dom::Element> el);
+
     Rc<Computed> computeFor(Computed const& parent, Gc::Ref<Dom::Element> el);
 
     Rc<PageComputedStyle> computeFor(Computed const& parent, Page const& page);
 
     void loadFontFaces();
+
+    // Forget the elements that weren't styled since the last call, they
+    // were removed from the document, along with the styles and cached
+    // declarations only they were using.
+    //
+    // NOTE: Must be called after styling the whole document, anything not
+    //       visited is dropped.
+    void collect();
 };
 
 } // namespace Vaev::Style
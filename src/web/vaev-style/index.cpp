@@ -0,0 +1,286 @@
+#include "index.h"
+
+namespace Vaev::Style {
+
+// Ids, classes and tags share the same filter, so they are salted
+// differently to keep `#foo` and `.foo` apart.
+Hash hashId(Str id) {
+    return hashCombine(1, hash(bytes(id)));
+}
+
+Hash hashClass(Str class_) {
+    return hashCombine(2, hash(bytes(class_)));
+}
+
+Hash hashTag(TagName tag) {
+    return hashCombine(3, hash(tag.id));
+}
+
+// MARK: AncestorFilter --------------------------------------------------------
+
+static Pair<usize> _probes(Hash h) {
+    // Mix the bits before splitting them, the string hashes are weak in the low bits.
+    u64 x = h;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccd;
+    x ^= x >> 33;
+    return {
+        x & (AncestorFilter::SIZE - 1),
+        (x >> AncestorFilter::BITS) & (AncestorFilter::SIZE - 1),
+    };
+}
+
+void AncestorFilter::_add(Hash h) {
+    auto [a, b] = _probes(h);
+    // NOTE: Saturated counters are never decremented, they only cost
+    //       some false positives until the filter is rebuilt.
+    if (_counts[a] != 0xFF)
+        _counts[a]++;
+    if (_counts[b] != 0xFF)
+        _counts[b]++;
+}
+
+void AncestorFilter::_remove(Hash h) {
+    auto [a, b] = _probes(h);
+    if (_counts[a] != 0xFF)
+        _counts[a]--;
+    if (_counts[b] != 0xFF)
+        _counts[b]--;
+}
+
+bool AncestorFilter::mayContain(Hash h) const {
+    auto [a, b] = _probes(h);
+    return _counts[a] and _counts[b];
+}
+
+void AncestorFilter::push(Gc::Ref<Dom::Element> el) {
+    _add(hashTag(el->tagName));
+    if (auto id = el->id())
+        _add(hashId(*id));
+    for (auto const& class_ : el->classList._tokens)
+        _add(hashClass(class_));
+    _stack.pushBack(el);
+}
+
+void AncestorFilter::pop() {
+    auto el = _stack.popBack();
+    _remove(hashTag(el->tagName));
+    if (auto id = el->id())
+        _remove(hashId(*id));
+    for (auto const& class_ : el->classList._tokens)
+        _remove(hashClass(class_));
+}
+
+bool AncestorFilter::covers(Gc::Ref<Dom::Element> el) const {
+    if (not _stack.len())
+        return false;
+    return el->parentNode() == Gc::Ptr<Dom::Node>{last(_stack)};
+}
+
+// MARK: RuleIndex -------------------------------------------------------------
+
+bool RuleIndex::Entry::mayMatch(AncestorFilter const& filter) const {
+    for (usize i = 0; i < ancestorsLen; i++)
+        if (not filter.mayContain(ancestors[i]))
+            return false;
+    return true;
+}
+
+enum struct _Bucket {
+    UNIVERSAL,
+    TAG,
+    CLASS,
+    ID,
+};
+
+struct _Key {
+    _Bucket bucket = _Bucket::UNIVERSAL;
+    Hash hash = 0;
+};
+
+// Pick the rarest simple selector the element itself has to match.
+static _Key _keyOf(Selector const& sel) {
+    if (auto s = sel.is<IdSelector>())
+        return {_Bucket::ID, hashId(s->id)};
+
+    if (auto s = sel.is<ClassSelector>())
+        return {_Bucket::CLASS, hashClass(s->class_)};
+
+    if (auto s = sel.is<TypeSelector>())
+        return {_Bucket::TAG, hashTag(s->type)};
+
+    if (auto s = sel.is<Infix>())
+        return _keyOf(*s->rhs);
+
+    if (auto s = sel.is<Nfix>(); s and s->type == Nfix::AND) {
+        _Key best;
+        for (auto const& inner : s->inners) {
+            auto key = _keyOf(inner);
+            if (key.bucket > best.bucket)
+                best = key;
+        }
+        return best;
+    }
+
+    return {};
+}
+
+// Collect the ids, classes and tags that have to be present on an ancestor for the selector to match.
+static void _collectAncestors(Selector const& sel, bool ancestor, RuleIndex::Entry& entry) {
+    if (entry.ancestorsLen == RuleIndex::MAX_ANCESTORS)
+        return;
+
+    auto add = [&](Hash h) {
+        if (ancestor and entry.ancestorsLen < RuleIndex::MAX_ANCESTORS)
+            entry.ancestors[entry.ancestorsLen++] = h;
+    };
+
+    sel.visit(Visitor{
+        [&](Infix const& s) {
+            _collectAncestors(*s.rhs, ancestor, entry);
+            // NOTE: The siblings of an ancestor are not ancestors themselves.
+            bool lhsAncestor = s.type == Infix::DESCENDANT or
+                               s.type == Infix::CHILD;
+            _collectAncestors(*s.lhs, lhsAncestor, entry);
+        },
+        [&](Nfix const& s) {
+            // NOTE: Only a compound has all its parts required, :is(), :not() and :where() are skipped.
+            if (s.type == Nfix::AND)
+                for (auto const& inner : s.inners)
+                    _collectAncestors(inner, ancestor, entry);
+        },
+        [&](IdSelector const& s) {
+            add(hashId(s.id));
+        },
+        [&](ClassSelector const& s) {
+            add(hashClass(s.class_));
+        },
+        [&](TypeSelector const& s) {
+            add(hashTag(s.type));
+        },
+        [&](auto const&) {
+            // Nothing to require from the ancestors
+        },
+    });
+}
+
+RuleIndex RuleIndex::build(StyleBook const& book, Media const& media) {
+    RuleIndex index;
+    for (auto const& sheet : book.styleSheets)
+        for (auto const& rule : sheet->rules)
+            index._add(rule, *sheet, media);
+    return index;
+}
+
+static bool _sameMedia(Rule const& rule, Media const& a, Media const& b) {
+    auto media = rule.is<MediaRule>();
+    if (not media)
+        return true;
+
+    if (media->match(a) != media->match(b))
+        return false;
+
+    for (auto const& subRule : media->rules)
+        if (not _sameMedia(subRule, a, b))
+            return false;
+
+    return true;
+}
+
+bool RuleIndex::sameMedia(StyleBook const& book, Media const& a, Media const& b) {
+    for (auto const& sheet : book.styleSheets)
+        for (auto const& rule : sheet->rules)
+            if (not _sameMedia(rule, a, b))
+                return false;
+    return true;
+}
+
+void RuleIndex::_add(Rule const& rule, StyleSheet const& sheet, Media const& media) {
+    rule.visit(Visitor{
+        [&](StyleRule const& r) {
+            _add(r);
+        },
+        [&](PageRule const& r) {
+            _pages.pushBack(&r);
+        },
+        [&](FontFaceRule const& r) {
+            _fontFaces.pushBack({&r, &sheet});
+        },
+        [&](MediaRule const& r) {
+            if (r.match(media))
+                for (auto const& subRule : r.rules)
+                    _add(subRule, sheet, media);
+        },
+        [&](auto const&) {
+            // Ignore other rule types
+        },
+    });
+}
+
+void RuleIndex::_add(StyleRule const& rule) {
+    usize order = _len++;
+
+    if (auto n = rule.selector.is<Nfix>(); n and n->type == Nfix::OR) {
+        for (auto const& inner : n->inners)
+            _add(rule, inner, order);
+        return;
+    }
+
+    _add(rule, rule.selector, order);
+}
+
+void RuleIndex::_add(StyleRule const& rule, Selector const& selector, usize order) {
+    // Selectors that failed to parse never match anything
+    if (selector.is<EmptySelector>())
+        return;
+
+    Entry entry{&rule, &selector, order};
+    _collectAncestors(selector, false, entry);
+
+    auto key = _keyOf(selector);
+    switch (key.bucket) {
+    case _Bucket::UNIVERSAL:
+        _universal.pushBack(entry);
+        break;
+
+    case _Bucket::TAG:
+        if (not _tags.has(key.hash))
+            _tags.put(key.hash, {});
+        _tags.get(key.hash).pushBack(entry);
+        break;
+
+    case _Bucket::CLASS:
+        if (not _classes.has(key.hash))
+            _classes.put(key.hash, {});
+        _classes.get(key.hash).pushBack(entry);
+        break;
+
+    case _Bucket::ID:
+        if (not _ids.has(key.hash))
+            _ids.put(key.hash, {});
+        _ids.get(key.hash).pushBack(entry);
+        break;
+    }
+}
+
+void RuleIndex::collect(Gc::Ref<Dom::Element> el, Vec<Cursor<Entry>>& out) const {
+    auto collectBucket = [&](Vec<Entry> const& entries) {
+        for (auto const& entry : entries)
+            out.pushBack(&entry);
+    };
+
+    collectBucket(_universal);
+
+    if (auto id = el->id())
+        if (auto entries = _ids.access(hashId(*id)))
+            collectBucket(*entries);
+
+    for (auto const& class_ : el->classList._tokens)
+        if (auto entries = _classes.access(hashClass(class_)))
+            collectBucket(*entries);
+
+    if (auto entries = _tags.access(hashTag(el->tagName)))
+        collectBucket(*entries);
+}
+
+} // namespace Vaev::Style
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <karm-base/hashmap.h>
+#include <vaev-dom/element.h>
+
+#include "stylesheet.h"
+
+namespace Vaev::Style {
+
+Hash hashId(Str id);
+
+Hash hashClass(Str class_);
+
+Hash hashTag(TagName tag);
+
+// MARK: AncestorFilter --------------------------------------------------------
+
+// Counting bloom filter over the ids, classes and tags of the ancestors
+// of the element being styled. It is maintained by the tree walk and lets
+// most descendant selectors be rejected without walking up the tree.
+struct AncestorFilter {
+    static constexpr usize BITS = 12;
+    static constexpr usize SIZE = 1 << BITS;
+
+    Array<u8, SIZE> _counts{};
+    Vec<Gc::Ref<Dom::Element>> _stack;
+
+    void _add(Hash h);
+
+    void _remove(Hash h);
+
+    bool mayContain(Hash h) const;
+
+    void push(Gc::Ref<Dom::Element> el);
+
+    void pop();
+
+    // The filter can only be used for the children of the last pushed element,
+    // otherwise it doesn't describe the ancestors of `el`.
+    bool covers(Gc::Ref<Dom::Element> el) const;
+};
+
+// MARK: RuleIndex -------------------------------------------------------------
+
+// Style rules bucketed by the rightmost id, class or tag of their selector,
+// so an element is only matched against the rules that could apply to it.
+// Media rules are resolved once when the index is built, the page and font
+// face rules they enable are flattened next to the top-level ones.
+struct RuleIndex {
+    static constexpr usize MAX_ANCESTORS = 4;
+
+    struct Entry {
+        Cursor<StyleRule> rule;
+        // NOTE: Selector lists are split, each branch gets its own entry.
+        Cursor<Selector> selector;
+        usize order;
+        Array<Hash, MAX_ANCESTORS> ancestors = {};
+        usize ancestorsLen = 0;
+
+        bool mayMatch(AncestorFilter const& filter) const;
+    };
+
+    Vec<Entry> _universal;
+    HashMap<Hash, Vec<Entry>> _ids;
+    HashMap<Hash, Vec<Entry>> _classes;
+    HashMap<Hash, Vec<Entry>> _tags;
+    usize _len = 0;
+
+    Vec<Cursor<PageRule>> _pages;
+    Vec<Tuple<Cursor<FontFaceRule>, Cursor<StyleSheet>>> _fontFaces;
+
+    static RuleIndex build(StyleBook const& book, Media const& media);
+
+    // Whether every media rule of the book evaluates the same against both
+    // media, in which case an index built for one can be used for the other.
+    static bool sameMedia(StyleBook const& book, Media const& a, Media const& b);
+
+    void _add(Rule const& rule, StyleSheet const& sheet, Media const& media);
+
+    void _add(StyleRule const& rule);
+
+    void _add(StyleRule const& rule, Selector const& selector, usize order);
+
+    // Collect the entries that may match `el`, grouped by bucket.
+    void collect(Gc::Ref<Dom::Element> el, Vec<Cursor<Entry>>& out) const;
+
+    // The active page rules, in document order.
+    Slice<Cursor<PageRule>> pages() const {
+        return _pages;
+    }
+
+    // The active font face rules, with the sheet their urls are relative to.
+    Slice<Tuple<Cursor<FontFaceRule>, Cursor<StyleSheet>>> fontFaces() const {
+        return _fontFaces;
+    }
+};
+
+} // namespace Vaev::Style
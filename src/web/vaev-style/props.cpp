@@ -6,6 +6,99 @@ namespace Vaev::Style {
 
 static bool DEBUG_PROPS = false;
 
+// MARK: Property Ids ----------------------------------------------------------
+
+static constexpr u64 _hashName(Str name) {
+    // FNV-1a, the generic hash can't be evaluated at compile time
+    u64 h = 0xcbf29ce484222325;
+    for (usize i = 0; i < name.len(); i++) {
+        h ^= static_cast<u8>(name[i]);
+        h *= 0x100000001b3;
+    }
+    return h;
+}
+
+static constexpr bool _sameName(Str a, Str b) {
+    if (a.len() != b.len())
+        return false;
+    for (usize i = 0; i < a.len(); i++)
+        if (a[i] != b[i])
+            return false;
+    return true;
+}
+
+template <typename T>
+static Res<StyleProp> _parseProp(Css::Sst const& decl) {
+    auto res = _parseDeclaration<StyleProp, T>(decl);
+    if (not res)
+        res = _parseDefaulted<StyleProp>(decl);
+    return res;
+}
+
+template <typename T>
+static void _applyDefault(Default value, Computed const& parent, Computed& c) {
+    if (value == Default::INITIAL) {
+        if constexpr (requires { T::initial(); })
+            StyleProp{T{T::initial()}}.apply(parent, c);
+    } else if (value == Default::INHERIT) {
+        if constexpr (requires { T::load(parent); })
+            StyleProp{T{T::load(parent)}}.apply(parent, c);
+    } else if (value == Default::UNSET) {
+        if constexpr (requires { T::inherit;  T::load(parent); })
+            StyleProp{T{T::load(parent)}}.apply(parent, c);
+        else if constexpr (requires { T::initial(); })
+            StyleProp{T{T::initial()}}.apply(parent, c);
+    }
+}
+
+// Everything the cascade needs to know about a property, indexed by its
+// position in the StyleProp union. The names are hashed into an open
+// addressing table at compile time, so looking one up never has to walk
+// the whole union.
+template <typename>
+struct _PropTable;
+
+template <typename... Ts>
+struct _PropTable<Union<Ts...>> {
+    static constexpr usize LEN = sizeof...(Ts);
+    static constexpr usize SLOTS = 512;
+    static_assert(LEN * 2 <= SLOTS, "property table is too crowded");
+
+    static constexpr Array<Str, LEN> NAMES = {Ts::name()...};
+
+    using ParseFn = Res<StyleProp> (*)(Css::Sst const&);
+    static constexpr Array<ParseFn, LEN> PARSERS = {_parseProp<Ts>...};
+
+    using DefaultFn = void (*)(Default, Computed const&, Computed&);
+    static constexpr Array<DefaultFn, LEN> DEFAULTS = {_applyDefault<Ts>...};
+
+    // Slots hold the index of the property plus one, zero is empty.
+    static constexpr Array<u16, SLOTS> TABLE = [] {
+        Array<u16, SLOTS> table{};
+        for (usize id = 0; id < LEN; id++) {
+            usize i = _hashName(NAMES[id]) & (SLOTS - 1);
+            // NOTE: On duplicated names the first property wins, like StyleProp::any()
+            bool duplicated = false;
+            for (; table[i]; i = (i + 1) & (SLOTS - 1))
+                duplicated = duplicated or _sameName(NAMES[table[i] - 1], NAMES[id]);
+            if (not duplicated)
+                table[i] = static_cast<u16>(id + 1);
+        }
+        return table;
+    }();
+
+    static Opt<usize> lookup(Str name) {
+        for (usize i = _hashName(name) & (SLOTS - 1); TABLE[i]; i = (i + 1) & (SLOTS - 1))
+            if (NAMES[TABLE[i] - 1] == name)
+                return static_cast<usize>(TABLE[i] - 1);
+        return NONE;
+    }
+};
+
+Opt<usize> propId(Str name) {
+    return _PropTable<_StyleProp>::lookup(name);
+}
+
 // MARK: DeferredProp ----------------------------------------------------------
 
 bool DeferredProp::_expandVariable(Cursor<Css::Sst>& c, Map<String, Css::Content> const& env, Css::Content& out) {
@@ -65,16 +158,22 @@ void DeferredProp::_expandContent(Cursor<Css::Sst>& c, Map<String, Css::Content>
     }
 }
 
-void DeferredProp::apply(Computed const& parent, Computed& c) const {
+Res<StyleProp> DeferredProp::resolve(Computed const& c) const {
     Css::Sst decl{Css::Sst::DECL};
     decl.token = Css::Token::ident(propName);
     Cursor<Css::Sst> cursor = value;
     _expandContent(cursor, *c.variables, decl.content);
 
     // Parse the expanded content
-    Res<StyleProp> computed = parseDeclaration<StyleProp>(decl, false);
+    if (_id)
+        return _PropTable<_StyleProp>::PARSERS[*_id](decl);
+    return parseDeclaration<StyleProp>(decl, false);
+}
+
+void DeferredProp::apply(Computed const& parent, Computed& c) const {
+    Res<StyleProp> computed = resolve(c);
     if (not computed) {
-        logWarnIf(DEBUG_PROPS, "failed to parse declaration: {}: {}", decl, computed);
+        logWarnIf(DEBUG_PROPS, "failed to parse declaration: {}: {}", propName, computed);
     } else {
         computed.unwrap().apply(parent, c);
     }
@@ -83,35 +182,13 @@ void DeferredProp::apply(Computed const& parent, Computed& c) const {
 // MARK: DefaultedProp ---------------------------------------------------------
 
 void DefaultedProp::apply(Computed const& parent, Computed& c) const {
-    if (value == Default::INITIAL) {
-        StyleProp::any([&]<typename T>() {
-            if (T::name() != propName)
-                return false;
-            if constexpr (requires { T::initial(); })
-                StyleProp{T{T::initial()}}.apply(parent, c);
-            return true;
-        });
-    } else if (value == Default::INHERIT) {
-        StyleProp::any([&]<typename T>() {
-            if (T::name() != propName)
-                return false;
-            if constexpr (requires { T::load(parent); })
-                StyleProp{T{T::load(parent)}}.apply(parent, c);
-            return true;
-        });
-    } else if (value == Default::UNSET) {
-        StyleProp::any([&]<typename T>() {
-            if (T::name() != propName)
-                return false;
-            if constexpr (requires { T::inherit;  T::load(parent); })
-                StyleProp{T{T::load(parent)}}.apply(parent, c);
-            else if constexpr (requires { T::initial(); })
-                StyleProp{T{T::initial()}}.apply(parent, c);
-            return true;
-        });
-    } else {
+    if (value == Default::REVERT) {
         logDebug("defaulted: unsupported value '{}'", value);
+        return;
     }
+
+    if (_id)
+        _PropTable<_StyleProp>::DEFAULTS[*_id](value, parent, c);
 }
 
 void DefaultedProp::repr(Io::Emit& e) const {
@@ -2980,11 +2980,21 @@ struct CustomProp {
     }
 };
 
+// Index of the property named `name` in the StyleProp union, if any.
+Opt<usize> propId(Str name);
+
+struct StyleProp;
+
 // NOTE: A property that could not be parsed, it's used to store the value
 //       as-is and apply it with the cascade and custom properties
 struct DeferredProp {
     String propName;
     Css::Content value;
+    Opt<usize> _id;
+
+    DeferredProp(String propName, Css::Content value)
+        : propName(propName), value(value), _id(propId(propName)) {
+    }
 
     static constexpr Str name() { return "deferred prop"; }
 
@@ -2998,6 +3008,9 @@ struct DeferredProp {
     //     child.variables = parent.variables;
     // }
 
+    // Substitute the variables of `c` and parse the result.
+    Res<StyleProp> resolve(Computed const& c) const;
+
     void apply(Computed const& parent, Computed& c) const;
 
     void repr(Io::Emit& e) const {
@@ -3017,6 +3030,11 @@ enum struct Default {
 struct DefaultedProp {
     String propName;
     Default value;
+    Opt<usize> _id;
+
+    DefaultedProp(String propName, Default value)
+        : propName(propName), value(value), _id(propId(propName)) {
+    }
 
     static constexpr Str name() { return "defaulted prop"; }
 
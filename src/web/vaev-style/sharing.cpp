@@ -0,0 +1,155 @@
+#include "sharing.h"
+
+namespace Vaev::Style {
+
+// MARK: Stats -----------------------------------------------------------------
+
+void StyleSharing::Stats::repr(Io::Emit& e) const {
+    f64 hitRate = lookups ? hits * 100.0 / lookups : 0;
+    e("(style-sharing hits: {}/{} ({.1}%) groups: {}/{} shared, {} bytes saved)", hits, lookups, hitRate, sharedGroups, groups, savedBytes);
+}
+
+// MARK: Style Cache -----------------------------------------------------------
+
+static Hash _hashKey(Computed const& parent, StyleSharing::MatchingRules const& rules, Str style) {
+    Hash h = hash(&parent);
+    for (auto const& [rule, spec] : rules) {
+        h = hashCombine(h, hash(static_cast<StyleRule const*>(rule)));
+        h = hashCombine(h, hash(spec.a));
+        h = hashCombine(h, hash(spec.b));
+        h = hashCombine(h, hash(spec.c));
+    }
+    return hashCombine(h, hash(bytes(style)));
+}
+
+static bool _sameKey(StyleSharing::_Entry const& entry, Computed const& parent, StyleSharing::MatchingRules const& rules, Str style) {
+    if (entry.parent != &parent or entry.rules.len() != rules.len() or entry.style != style)
+        return false;
+
+    for (usize i = 0; i < rules.len(); i++) {
+        if (entry.rules[i].v0 != rules[i].v0 or entry.rules[i].v1 != rules[i].v1)
+            return false;
+    }
+
+    return true;
+}
+
+Opt<Rc<Computed>> StyleSharing::lookup(Computed const& parent, MatchingRules const& rules, Str style) {
+    _stats.lookups++;
+
+    auto entry = _entries.access(_hashKey(parent, rules, style));
+    if (not entry or not _sameKey(*entry, parent, rules, style))
+        return NONE;
+
+    _stats.hits++;
+    return entry->computed;
+}
+
+void StyleSharing::insert(Computed const& parent, MatchingRules const& rules, Str style, Rc<Computed> computed) {
+    _styles.put(&*computed, computed);
+
+    // NOTE: The parent has to outlive the entry, otherwise another
+    //       style could later be allocated at the same address.
+    if (&parent != &Computed::initial() and not _styles.has(&parent))
+        return;
+
+    _Entry entry{&parent, {}, style, computed};
+    for (auto const& [rule, spec] : rules)
+        entry.rules.pushBack({rule, spec});
+    _entries.put(_hashKey(parent, rules, style), std::move(entry));
+}
+
+void StyleSharing::collect(HashMap<Computed const*, Rc<Computed>> const& live) {
+    _styles.removeIf([&](Computed const* style, auto const&) {
+        return not live.has(style);
+    });
+
+    // NOTE: Entries whose parent is gone would be keyed on a dangling
+    //       address, entries whose style is gone would hand out styles
+    //       that can't be used as a parent.
+    _entries.removeIf([&](auto const&, _Entry const& entry) {
+        bool parentLive = entry.parent == &Computed::initial() or _styles.has(entry.parent);
+        return not parentLive or not _styles.has(&*entry.computed);
+    });
+
+    _collect(_gaps);
+    _collect(_backgrounds);
+    _collect(_borders);
+    _collect(_insets);
+    _collect(_outline);
+    _collect(_padding);
+    _collect(_sizing);
+    _collect(_baseline);
+    _collect(_table);
+    _collect(_font);
+    _collect(_text);
+    _collect(_flex);
+    _collect(_break);
+    _collect(_variables);
+}
+
+// MARK: Hash-consing ----------------------------------------------------------
+
+template <typename T>
+void StyleSharing::_intern(Cow<T>& group, _Groups<T>& groups) {
+    // Groups that were not written by the cascade are already shared
+    // with the initial or the parent style.
+    if (group._inner.refs() > 1)
+        return;
+
+    _stats.groups++;
+
+    // NOTE: None of the groups can be compared directly, but they all have
+    //       a repr that prints every one of their fields.
+    auto key = Io::format("{}", *group);
+    auto h = hash(key.bytes());
+
+    if (not groups.has(h))
+        groups.put(h, {});
+
+    auto& bucket = groups.get(h);
+    for (auto const& instance : bucket) {
+        if (Io::format("{}", *instance) == key) {
+            group._inner = instance;
+            _stats.sharedGroups++;
+            _stats.savedBytes += sizeof(T);
+            return;
+        }
+    }
+
+    bucket.pushBack(group._inner);
+}
+
+template <typename T>
+void StyleSharing::_collect(_Groups<T>& groups) {
+    groups.removeIf([](auto const&, Vec<Rc<T>>& bucket) {
+        bucket.removeIf([](Rc<T> const& instance) {
+            return instance.refs() == 1;
+        });
+        return bucket.len() == 0;
+    });
+}
+
+void StyleSharing::intern(Computed& computed) {
+    _intern(computed.gaps, _gaps);
+    _intern(computed.backgrounds, _backgrounds);
+    _intern(computed.borders, _borders);
+    _intern(computed.margin, _insets);
+    _intern(computed.outline, _outline);
+    _intern(computed.padding, _padding);
+    _intern(computed.sizing, _sizing);
+    _intern(computed.baseline, _baseline);
+    _intern(computed.offsets, _insets);
+    _intern(computed.table, _table);
+    _intern(computed.font, _font);
+    _intern(computed.text, _text);
+    _intern(computed.flex, _flex);
+    _intern(computed.break_, _break);
+    _intern(computed.variables, _variables);
+}
+
+void StyleSharing::internVariables(Computed& computed) {
+    _intern(computed.variables, _variables);
+}
+
+} // namespace Vaev::Style
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <karm-base/hashmap.h>
+
+#include "computed.h"
+#include "rules.h"
+
+namespace Vaev::Style {
+
+// Elements with the same parent style, matching the same rules with the
+// same inline style always end up with the same computed style, this
+// cache lets them share a single Rc<Computed>.
+//
+// Freshly computed styles also get their Cow groups hash-consed, so
+// identical borders, margins, backgrounds... are only kept once.
+//
+// NOTE: Styles handed out by the cache are shared, callers must copy
+//       them before making any change.
+struct StyleSharing {
+    using MatchingRules = Vec<Tuple<Cursor<StyleRule>, Spec>>;
+
+    struct Stats {
+        usize lookups = 0;
+        usize hits = 0;
+        usize groups = 0;
+        usize sharedGroups = 0;
+        usize savedBytes = 0;
+
+        void repr(Io::Emit& e) const;
+    };
+
+    struct _Entry {
+        Computed const* parent;
+        Vec<Tuple<StyleRule const*, Spec>> rules;
+        String style;
+        Rc<Computed> computed;
+    };
+
+    // Interned instances of one group, bucketed by the hash of their repr.
+    template <typename T>
+    using _Groups = HashMap<Hash, Vec<Rc<T>>>;
+
+    HashMap<Hash, _Entry> _entries;
+
+    // Every style handed out, they are kept alive so their address
+    // can safely be used as the parent in the cache keys.
+    HashMap<Computed const*, Rc<Computed>> _styles;
+
+    _Groups<Gaps> _gaps;
+    _Groups<BackgroundProps> _backgrounds;
+    _Groups<BorderProps> _borders;
+    _Groups<Margin> _insets;
+    _Groups<Outline> _outline;
+    _Groups<Padding> _padding;
+    _Groups<SizingProps> _sizing;
+    _Groups<Baseline> _baseline;
+    _Groups<TableProps> _table;
+    _Groups<FontProps> _font;
+    _Groups<TextProps> _text;
+    _Groups<FlexProps> _flex;
+    _Groups<BreakProps> _break;
+    _Groups<Map<String, Css::Content>> _variables;
+
+    Stats _stats;
+
+    Opt<Rc<Computed>> lookup(Computed const& parent, MatchingRules const& rules, Str style);
+
+    void insert(Computed const& parent, MatchingRules const& rules, Str style, Rc<Computed> computed);
+
+    template <typename T>
+    void _intern(Cow<T>& group, _Groups<T>& groups);
+
+    void intern(Computed& computed);
+
+    // Custom properties are interned as soon as the cascade has applied them,
+    // so elements declaring the same variables end up with the same environment.
+    void internVariables(Computed& computed);
+
+    // Only keep the styles in `live` and the entries between them,
+    // then drop the groups no style is using anymore.
+    void collect(HashMap<Computed const*, Rc<Computed>> const& live);
+
+    template <typename T>
+    void _collect(_Groups<T>& groups);
+
+    Stats const& stats() const {
+        return _stats;
+    }
+};
+
+} // namespace Vaev::Style
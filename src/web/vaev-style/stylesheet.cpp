@@ -48,6 +48,10 @@ void StyleBook::repr(Io::Emit& e) const {
 }
 
 void StyleBook::add(StyleSheet&& sheet) {
+    styleSheets.pushBack(makeArc<StyleSheet>(std::move(sheet)));
+}
+
+void StyleBook::add(Arc<StyleSheet> sheet) {
     styleSheets.pushBack(std::move(sheet));
 }
 
@@ -30,11 +30,15 @@ struct StyleSheet {
 };
 
 struct StyleBook {
-    Vec<StyleSheet> styleSheets;
+    // NOTE: Parsed sheets are immutable, so they can be shared
+    //       between books, even across threads.
+    Vec<Arc<StyleSheet>> styleSheets;
 
     void repr(Io::Emit& e) const;
 
     void add(StyleSheet&& sheet);
+
+    void add(Arc<StyleSheet> sheet);
 };
 
 } // namespace Vaev::Style
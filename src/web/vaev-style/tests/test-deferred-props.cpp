@@ -0,0 +1,62 @@
+#include <karm-gc/heap.h>
+#include <karm-test/macros.h>
+#include <vaev-style/computer.h>
+#include <vaev-style/decls.h>
+
+namespace Vaev::Style::Tests {
+
+test$("style-prop-ids") {
+    auto props = parseDeclarations<StyleProp>("color: red; margin-top: 1px; display: block");
+    expectEq$(props.len(), 3uz);
+
+    for (auto const& prop : props)
+        expect$(propId(prop.name()) == prop.index());
+
+    expect$(propId("not-a-property") == NONE);
+
+    return Ok();
+}
+
+test$("style-deferred-props") {
+    Gc::Heap gc;
+
+    StyleBook book;
+    Io::SScan s{
+        ".a { --c: #ff0000; } "
+        ".b { --c: #ff0000; } "
+        ".c { --c: #0000ff; } "
+        "div { color: var(--c); } "
+        "span { color: inherit; } "
+    };
+    book.add(StyleSheet::parse(s, ""_url));
+
+    Text::FontBook fontBook;
+    Media media;
+    Computer computer{media, book, fontBook};
+
+    auto styleFor = [&](Str class_) {
+        auto el = gc.alloc<Dom::Element>(Html::DIV);
+        el->classList.add(class_);
+        return computer.computeFor(Computed::initial(), el);
+    };
+
+    auto a = styleFor("a");
+    auto b = styleFor("b");
+    auto c = styleFor("c");
+
+    expect$(a->color == Gfx::Color::fromHex(0xff0000));
+    expect$(b->color == Gfx::Color::fromHex(0xff0000));
+    expect$(c->color == Gfx::Color::fromHex(0x0000ff));
+
+    // .a and .b declare the same variables, they share the parsed declaration
+    expect$(&*a->variables == &*b->variables);
+    expectEq$(computer._deferred.len(), 2uz);
+
+    auto span = gc.alloc<Dom::Element>(Html::SPAN);
+    auto inherited = computer.computeFor(*c, span);
+    expect$(inherited->color == Gfx::Color::fromHex(0x0000ff));
+
+    return Ok();
+}
+
+} // namespace Vaev::Style::Tests
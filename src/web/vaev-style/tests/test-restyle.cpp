@@ -0,0 +1,96 @@
+#include <karm-gc/heap.h>
+#include <karm-test/macros.h>
+#include <vaev-dom/document.h>
+#include <vaev-style/computer.h>
+
+namespace Vaev::Style::Tests {
+
+test$("style-restyle-dirty-elements") {
+    Gc::Heap gc;
+
+    auto dom = gc.alloc<Dom::Document>(Mime::Url());
+    auto html = gc.alloc<Dom::Element>(Html::HTML);
+    dom->appendChild(html);
+    auto div = gc.alloc<Dom::Element>(Html::DIV);
+    html->appendChild(div);
+
+    StyleBook book;
+    Io::SScan s{
+        ".a { color: #ff0000; } "
+        ".b div { color: #0000ff; } "
+    };
+    book.add(StyleSheet::parse(s, ""_url));
+
+    Text::FontBook fontBook;
+    Media media;
+    Computer computer{media, book, fontBook};
+
+    auto styleDiv = [&] {
+        auto root = computer.computeFor(Computed::initial(), html);
+        computer.pushAncestor(html);
+        auto style = computer.computeFor(*root, div);
+        computer.popAncestor();
+        return style;
+    };
+
+    expect$(dom->dirty());
+    auto first = styleDiv();
+    dom->clean();
+    expect$(not dom->dirty());
+    expect$(not div->dirty());
+
+    // Clean elements are not matched again
+    auto lookups = computer._sharing.stats().lookups;
+    expect$(&*styleDiv() == &*first);
+    expectEq$(computer._sharing.stats().lookups, lookups);
+
+    div->setAttribute(Html::CLASS_ATTR, "a"s);
+    expect$(dom->dirty());
+    expect$(styleDiv()->color == Gfx::Color::fromHex(0xff0000));
+    dom->clean();
+
+    // Restyling an ancestor restyles its descendants
+    html->setAttribute(Html::CLASS_ATTR, "b"s);
+    expect$(not div->dirty());
+    expect$(styleDiv()->color == Gfx::Color::fromHex(0x0000ff));
+
+    return Ok();
+}
+
+test$("style-collect-detached-elements") {
+    Gc::Heap gc;
+
+    auto dom = gc.alloc<Dom::Document>(Mime::Url());
+    auto html = gc.alloc<Dom::Element>(Html::HTML);
+    dom->appendChild(html);
+    auto div = gc.alloc<Dom::Element>(Html::DIV);
+    div->setAttribute(Html::STYLE_ATTR, "color: #ff0000"s);
+    html->appendChild(div);
+
+    StyleBook book;
+    Text::FontBook fontBook;
+    Media media;
+    Computer computer{media, book, fontBook};
+
+    auto root = computer.computeFor(Computed::initial(), html);
+    computer.pushAncestor(html);
+    auto style = computer.computeFor(*root, div);
+    computer.popAncestor();
+    computer.collect();
+    dom->clean();
+
+    expectEq$(computer._elements.len(), 2uz);
+    expect$(computer._sharing._styles.has(&*style));
+
+    // The div is not reached anymore, as if it was removed
+    computer.computeFor(Computed::initial(), html);
+    computer.collect();
+
+    expectEq$(computer._elements.len(), 1uz);
+    expect$(not computer._elements.has(&*div));
+    expect$(not computer._sharing._styles.has(&*style));
+
+    return Ok();
+}
+
+} // namespace Vaev::Style::Tests
@@ -0,0 +1,170 @@
+#include <karm-gc/heap.h>
+#include <karm-test/macros.h>
+#include <vaev-style/index.h>
+#include <vaev-style/matcher.h>
+
+namespace Vaev::Style::Tests {
+
+static Media const TEST_MEDIA = {
+    .type = MediaType::SCREEN,
+    .width = 1920_au,
+    .height = 1080_au,
+    .aspectRatio = 16.0 / 9.0,
+    .orientation = Print::Orientation::LANDSCAPE,
+
+    .resolution = Resolution::fromDpi(96),
+    .scan = Scan::PROGRESSIVE,
+    .grid = false,
+    .update = Update::NONE,
+    .overflowBlock = OverflowBlock::NONE,
+    .overflowInline = OverflowInline::NONE,
+
+    .color = 8,
+    .colorIndex = 256,
+    .monochrome = 0,
+    .colorGamut = ColorGamut::SRGB,
+    .pointer = Pointer::NONE,
+    .hover = Hover::NONE,
+    .anyPointer = Pointer::FINE,
+    .anyHover = Hover::HOVER,
+
+    .prefersReducedMotion = ReducedMotion::REDUCE,
+    .prefersReducedTransparency = ReducedTransparency::NO_PREFERENCE,
+    .prefersContrast = Contrast::LESS,
+    .forcedColors = Colors::NONE,
+    .prefersColorScheme = ColorScheme::LIGHT,
+    .prefersReducedData = ReducedData::REDUCE,
+
+    .deviceWidth = 1920_au,
+    .deviceHeight = 1080_au,
+    .deviceAspectRatio = 16.0 / 9.0,
+};
+
+static StyleBook _styleBook(Str css) {
+    StyleBook book;
+    Io::SScan s{css};
+    book.add(StyleSheet::parse(s, ""_url));
+    return book;
+}
+
+// Count the rules matching `el` through the index, skipping the ones rejected by `filter`.
+static usize _countMatches(RuleIndex const& index, Gc::Ref<Dom::Element> el, AncestorFilter const* filter = nullptr) {
+    Vec<Cursor<RuleIndex::Entry>> candidates;
+    index.collect(el, candidates);
+
+    usize count = 0;
+    for (auto const& entry : candidates) {
+        if (filter and not entry->mayMatch(*filter))
+            continue;
+        if (matchSelector(*entry->selector, el))
+            count++;
+    }
+    return count;
+}
+
+static usize _countMatches(StyleBook const& book, Gc::Ref<Dom::Element> el) {
+    usize count = 0;
+    for (auto const& rule : book.styleSheets[0]->rules)
+        if (auto r = rule.is<StyleRule>(); r and r->match(el))
+            count++;
+    return count;
+}
+
+test$("style-rule-index-buckets") {
+    Gc::Heap gc;
+    auto div = gc.alloc<Dom::Element>(Html::DIV);
+    div->setAttribute(Html::ID_ATTR, "b"s);
+    div->classList.add("a");
+
+    auto span = gc.alloc<Dom::Element>(Html::SPAN);
+    span->classList.add("a");
+    span->classList.add("c");
+    div->appendChild(span);
+
+    auto book = _styleBook(
+        ".a { color: red; } "
+        "#b { color: red; } "
+        "div { color: red; } "
+        "* { color: red; } "
+        "span.c { color: red; } "
+        "#b > .c { color: red; } "
+        ".z { color: red; } "
+        "@media print { div { color: red; } } "
+    );
+    auto index = RuleIndex::build(book, TEST_MEDIA);
+
+    expectEq$(_countMatches(index, div), 4uz);
+    expectEq$(_countMatches(index, span), 4uz);
+    expectEq$(_countMatches(index, span), _countMatches(book, span));
+
+    return Ok();
+}
+
+test$("style-rule-index-selector-list") {
+    Gc::Heap gc;
+    auto span = gc.alloc<Dom::Element>(Html::SPAN);
+    span->classList.add("a");
+
+    auto book = _styleBook("p, span, .a { color: red; }");
+    auto index = RuleIndex::build(book, TEST_MEDIA);
+
+    // Each branch is indexed on its own, but they all point to the same rule
+    Vec<Cursor<RuleIndex::Entry>> candidates;
+    index.collect(span, candidates);
+    expectEq$(candidates.len(), 2uz);
+    expectEq$(candidates[0]->order, candidates[1]->order);
+
+    return Ok();
+}
+
+test$("style-rule-index-ancestor-filter") {
+    Gc::Heap gc;
+    auto section = gc.alloc<Dom::Element>(Html::SECTION);
+    section->classList.add("x");
+
+    auto span = gc.alloc<Dom::Element>(Html::SPAN);
+    span->classList.add("a");
+    section->appendChild(span);
+
+    auto book = _styleBook(
+        ".x .a { color: red; } "
+        ".y .a { color: red; } "
+        "section > span { color: red; } "
+        "div + .x .a { color: red; } "
+    );
+    auto index = RuleIndex::build(book, TEST_MEDIA);
+
+    AncestorFilter filter;
+    expect$(not filter.covers(span));
+
+    filter.push(section);
+    expect$(filter.covers(span));
+    expect$(filter.mayContain(hashClass("x")));
+    expect$(filter.mayContain(hashTag(Html::SECTION)));
+
+    // ".y .a" is rejected by the filter and "div + .x .a" by the matcher
+    expectEq$(_countMatches(index, span, &filter), 2uz);
+
+    filter.pop();
+    expect$(not filter.covers(span));
+    expect$(not filter.mayContain(hashClass("x")));
+
+    return Ok();
+}
+
+test$("style-rule-index-flattens-media") {
+    auto book = _styleBook(
+        "@page { margin: 1in; } "
+        "@media screen { @page { margin: 2in; } @font-face { font-family: a; } } "
+        "@media print { @page { margin: 3in; } @font-face { font-family: b; } } "
+    );
+    auto index = RuleIndex::build(book, TEST_MEDIA);
+
+    expectEq$(index.pages().len(), 2uz);
+    expectEq$(index.fontFaces().len(), 1uz);
+    expect$(index.fontFaces()[0].v1 == &*book.styleSheets[0]);
+
+    return Ok();
+}
+
+} // namespace Vaev::Style::Tests
@@ -1,45 +1,22 @@
 #include <karm-test/macros.h>
-#include <vaev-style/computer.h>
+#include <vaev-style/matcher.h>
 #include <vaev-style/selector.h>
 
-#include "vaev-style/rules.h"
-
 namespace Vaev::Style::Tests {
 
 test$("test-specificity-selector-list") {
     Selector selector{try$(Selector::parse(".a, .b#x, .c.d.e.f"))};
 
-    auto makeRule = [&]() -> Rule {
-        StyleRule rule{
-            .selector = selector,
-            .props = {}
-        };
-        return rule;
-    };
-
-    Rule rule = makeRule();
-
-    Text::FontBook fontBook;
-    StyleBook stylebook;
-    Media media;
-    Computer computer{media, stylebook, fontBook};
-
     {
         Dom::Element elZeroMatches{Dom::Element(Html::DIV)};
 
-        Vec<Tuple<Cursor<StyleRule>, Spec>> matchingRules;
-        computer._evalRule(rule, elZeroMatches, matchingRules);
-
-        expect$(matchingRules.len() == 0);
+        expectEq$(matchSelector(selector, elZeroMatches), NONE);
     }
     {
         Dom::Element elOneMatch{Dom::Element(Html::DIV)};
         elOneMatch.classList.add("a");
 
-        Vec<Tuple<Cursor<StyleRule>, Spec>> matchingRules;
-        computer._evalRule(rule, elOneMatch, matchingRules);
-
-        expect$(matchingRules[0].v1 == Spec(0, 1, 0));
+        expect$(matchSelector(selector, elOneMatch).unwrap() == Spec(0, 1, 0));
     }
     {
         Dom::Element elOneMatch{Dom::Element(Html::DIV)};
@@ -48,20 +25,14 @@ test$("test-specificity-selector-list") {
         elOneMatch.classList.add("e");
         elOneMatch.classList.add("f");
 
-        Vec<Tuple<Cursor<StyleRule>, Spec>> matchingRules;
-        computer._evalRule(rule, elOneMatch, matchingRules);
-
-        expect$(matchingRules[0].v1 == Spec(0, 4, 0));
+        expect$(matchSelector(selector, elOneMatch).unwrap() == Spec(0, 4, 0));
     }
     {
         Dom::Element elAnotherMatch{Dom::Element(Html::DIV)};
         elAnotherMatch.classList.add("b");
         elAnotherMatch.setAttribute(AttrName::make("id"s, Vaev::HTML), "x"s);
 
-        Vec<Tuple<Cursor<StyleRule>, Spec>> matchingRules;
-        computer._evalRule(rule, elAnotherMatch, matchingRules);
-
-        expect$(matchingRules[0].v1 == Spec(1, 1, 0));
+        expect$(matchSelector(selector, elAnotherMatch).unwrap() == Spec(1, 1, 0));
     }
     {
         Dom::Element twoMatches{Dom::Element(Html::DIV)};
@@ -70,10 +41,7 @@ test$("test-specificity-selector-list") {
         twoMatches.setAttribute(AttrName::make("id"s, Vaev::HTML), "x"s);
         twoMatches.classList.add("a");
 
-        Vec<Tuple<Cursor<StyleRule>, Spec>> matchingRules;
-        computer._evalRule(rule, twoMatches, matchingRules);
-
-        expect$(matchingRules[0].v1 == Spec(1, 1, 0));
+        expect$(matchSelector(selector, twoMatches).unwrap() == Spec(1, 1, 0));
     }
 
     return Ok();
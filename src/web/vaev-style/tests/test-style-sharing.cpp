@@ -0,0 +1,62 @@
+#include <karm-test/macros.h>
+#include <vaev-style/sharing.h>
+
+namespace Vaev::Style::Tests {
+
+test$("style-sharing-cache") {
+    StyleSharing sharing;
+    StyleSharing::MatchingRules rules;
+
+    expect$(sharing.lookup(Computed::initial(), rules, "") == NONE);
+
+    auto computed = makeRc<Computed>(Computed::initial());
+    sharing.insert(Computed::initial(), rules, "", computed);
+
+    auto shared = sharing.lookup(Computed::initial(), rules, "");
+    expect$(shared != NONE);
+    expect$(&**shared == &*computed);
+
+    // A different inline style is a different key
+    expect$(sharing.lookup(Computed::initial(), rules, "color: red") == NONE);
+
+    // Styles that didn't come out of the cache can't be used as a parent
+    Computed parent = Computed::initial();
+    sharing.insert(parent, rules, "", makeRc<Computed>(Computed::initial()));
+    expect$(sharing.lookup(parent, rules, "") == NONE);
+
+    // But the ones it handed out can
+    sharing.insert(*computed, rules, "", makeRc<Computed>(Computed::initial()));
+    expect$(sharing.lookup(*computed, rules, "") != NONE);
+
+    return Ok();
+}
+
+test$("style-sharing-intern") {
+    StyleSharing sharing;
+
+    Computed a = Computed::initial();
+    a.borders.cow().all({.width = Keywords::THICK});
+
+    Computed b = Computed::initial();
+    b.borders.cow().all({.width = Keywords::THICK});
+
+    Computed c = Computed::initial();
+    c.borders.cow().all({.width = Keywords::THIN});
+
+    sharing.intern(a);
+    sharing.intern(b);
+    sharing.intern(c);
+
+    expect$(&*a.borders == &*b.borders);
+    expect$(&*a.borders != &*c.borders);
+
+    // Groups left untouched by the cascade are already shared
+    expect$(&*a.margin == &*Computed::initial().margin);
+
+    expectEq$(sharing.stats().groups, 3uz);
+    expectEq$(sharing.stats().sharedGroups, 1uz);
+
+    return Ok();
+}
+
+} // namespace Vaev::Style::Tests
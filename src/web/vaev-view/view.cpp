@@ -1,5 +1,6 @@
 module;
 
+#include <karm-base/box.h>
 #include <karm-gc/root.h>
 #include <karm-ui/node.h>
 #include <karm-ui/view.h>
@@ -20,7 +21,7 @@ export struct ViewProps {
 struct View : public Ui::View<View> {
     Gc::Root<Dom::Document> _dom;
     ViewProps _props;
-    Opt<Driver::RenderResult> _renderResult;
+    Opt<Box<Driver::Pipeline>> _pipeline;
 
     View(Gc::Root<Dom::Document> dom, ViewProps props)
         : _dom(dom), _props(props) {}
@@ -65,25 +66,33 @@ struct View : public Ui::View<View> {
     }
 
     void reconcile(View& o) override {
+        // NOTE: The pipeline follows the mutations of the document by itself.
+        if (_dom != o._dom)
+            _pipeline = NONE;
         _dom = o._dom;
         _props = o._props;
-        _renderResult = NONE;
+    }
+
+    Driver::Pipeline& _update(Math::Vec2i viewport) {
+        if (not _pipeline)
+            _pipeline = makeBox<Driver::Pipeline>(*_dom);
+
+        auto& pipeline = **_pipeline;
+        pipeline.update(_constructMedia(viewport), {.small = viewport.cast<Au>()});
+        return pipeline;
     }
 
     void paint(Gfx::Canvas& g, Math::Recti rect) override {
         // Painting browser's viewport.
         auto viewport = bound().size();
-        if (not _renderResult) {
-            auto media = _constructMedia(viewport);
-            _renderResult = Driver::render(*_dom, media, {.small = viewport.cast<Au>()});
-        }
+        auto& pipeline = _update(viewport);
 
         g.push();
 
         g.origin(bound().xy.cast<f64>());
         g.clip(viewport);
 
-        auto [_, layout, paint, frag, canvasColor] = *_renderResult;
+        auto canvasColor = pipeline.canvasColor();
         auto paintRect = rect.offset(-bound().xy);
 
         if (canvasColor.alpha < 255) {
@@ -93,26 +102,21 @@ struct View : public Ui::View<View> {
         } else
             g.clear(paintRect, canvasColor);
 
-        paint->paint(g, paintRect.cast<f64>());
+        pipeline.scene()->paint(g, paintRect.cast<f64>());
         if (_props.wireframe)
-            Layout::wireframe(*frag, g);
+            Layout::wireframe(pipeline.frag(), g);
 
         g.pop();
     }
 
-    void layout(Math::Recti bound) override {
-        _renderResult = NONE;
-        Ui::View<View>::layout(bound);
-    }
-
     Math::Vec2i size(Math::Vec2i size, Ui::Hint) override {
-        // FIXME: This is wasteful, we should cache the result
-        auto media = _constructMedia(size);
-        auto [_, layout, _, frag, _] = Driver::render(*_dom, media, {.small = size.cast<Au>()});
+        // NOTE: Measuring only lays the document out again, the styles
+        //       and boxes are kept as long as the media queries agree.
+        auto& frag = _update(size).frag();
 
         return {
-            frag->metrics.borderBox().width.cast<isize>(),
-            frag->metrics.borderBox().height.cast<isize>(),
+            frag.metrics.borderBox().width.cast<isize>(),
+            frag.metrics.borderBox().height.cast<isize>(),
         };
     }
 };